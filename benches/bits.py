@@ -0,0 +1,59 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Compare decoding bit-packed symbols with `BitCursor` and pure Python.
+"""
+
+import argparse
+import random
+import timeit
+
+from iocursor import BitCursor, Cursor
+
+WIDTHS = (1, 3, 5, 7, 12, 2, 9, 4)
+
+
+def make_data(symbols):
+    rng = random.Random(42)
+    return bytes(rng.randrange(256) for _ in range(symbols * sum(WIDTHS) // len(WIDTHS) // 8 + 8))
+
+
+def decode_python(data, symbols):
+    cursor = Cursor(data)
+    acc = 0
+    count = 0
+    values = []
+    for i in range(symbols):
+        n = WIDTHS[i % len(WIDTHS)]
+        while count < n:
+            acc = (acc << 8) | cursor.read(1)[0]
+            count += 8
+        count -= n
+        values.append(acc >> count)
+        acc &= (1 << count) - 1
+    return values
+
+
+def decode_bits(data, symbols):
+    read_bits = BitCursor(data).read_bits
+    return [read_bits(WIDTHS[i % len(WIDTHS)]) for i in range(symbols)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-s", "--symbols", type=int, default=100000, help="number of symbols")
+    parser.add_argument("-r", "--repeat", type=int, default=5, help="number of measures")
+    args = parser.parse_args()
+
+    data = make_data(args.symbols)
+    expected = decode_python(data, args.symbols)
+    for label, func in [
+        ("read(1) and shifts", decode_python),
+        ("BitCursor.read_bits", decode_bits),
+    ]:
+        assert func(data, args.symbols) == expected
+        times = timeit.repeat(lambda: func(data, args.symbols), number=1, repeat=args.repeat)
+        print("{:<22} {:>8.1f} ns/symbol".format(label, min(times) / args.symbols * 1e9))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,46 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Compare undoing speculative writes with checkpoints and buffer snapshots.
+"""
+
+import argparse
+import timeit
+
+from iocursor import Cursor
+
+
+def speculate_snapshot(cursor, buffer, record):
+    position = cursor.tell()
+    snapshot = bytes(buffer)
+    cursor.write(record)
+    buffer[:] = snapshot
+    cursor.seek(position)
+
+
+def speculate_checkpoint(cursor, buffer, record):
+    with cursor.checkpoint() as checkpoint:
+        cursor.write(record)
+        checkpoint.rollback()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-s", "--size", type=int, default=1 << 20, help="size of the output buffer")
+    parser.add_argument("-n", "--number", type=int, default=1000, help="attempts per measure")
+    parser.add_argument("-r", "--repeat", type=int, default=5, help="number of measures")
+    args = parser.parse_args()
+
+    record = bytes(64)
+    for label, func in [
+        ("snapshot and restore", speculate_snapshot),
+        ("checkpoint", speculate_checkpoint),
+    ]:
+        buffer = bytearray(args.size)
+        cursor = Cursor(buffer)
+        cursor.seek(args.size // 2)
+        times = timeit.repeat(lambda: func(cursor, buffer, record), number=args.number, repeat=args.repeat)
+        print("{:<22} {:>10.1f} ns/attempt".format(label, min(times) / args.number * 1e9))
+
+
+if __name__ == "__main__":
+    main()
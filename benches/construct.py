@@ -0,0 +1,39 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Compare the cost of wrapping many small buffers in a file-like object.
+"""
+
+import argparse
+import io
+import timeit
+
+from iocursor import Cursor
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-s", "--size", type=int, default=64, help="size of each buffer")
+    parser.add_argument("-n", "--number", type=int, default=1000000, help="buffers per measure")
+    parser.add_argument("-r", "--repeat", type=int, default=5, help="number of measures")
+    args = parser.parse_args()
+
+    data = bytes(args.size)
+    array = bytearray(args.size)
+    cursor = Cursor(data)
+
+    benches = {
+        "BytesIO(bytes)": lambda: io.BytesIO(data),
+        "Cursor(bytes)": lambda: Cursor(data),
+        "Cursor(bytearray)": lambda: Cursor(array),
+        "Cursor.rebind(bytes)": lambda: cursor.rebind(data),
+        "Cursor(bytes).read(1)": lambda: Cursor(data).read(1),
+        "Cursor.rebind + read(1)": lambda: (cursor.rebind(data), cursor.read(1)),
+    }
+
+    for label, func in benches.items():
+        times = timeit.repeat(func, number=args.number, repeat=args.repeat)
+        print("{:<26} {:>8.1f} ns/buffer".format(label, min(times) / args.number * 1e9))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,63 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Compare parsing a fixed-layout header with `read` and batched primitives.
+"""
+
+import argparse
+import timeit
+
+from iocursor import Cursor
+
+MAGIC = b"\x89IOC\r\n\x1a\n"
+FIELDS = (2, 2, 4, 4, 8, 8, 16)
+HEADER = MAGIC + bytes(6) + bytes(sum(FIELDS))
+
+
+def parse_read(cursor):
+    cursor.seek(0)
+    if cursor.read(8) != MAGIC:
+        raise ValueError("invalid magic")
+    cursor.read(6)
+    return [cursor.read(n) for n in FIELDS]
+
+
+def parse_unrolled(cursor):
+    cursor.seek(0)
+    if cursor.read(8) != MAGIC:
+        raise ValueError("invalid magic")
+    cursor.read(6)
+    version = cursor.read(2)
+    flags = cursor.read(2)
+    width = cursor.read(4)
+    height = cursor.read(4)
+    offset = cursor.read(8)
+    length = cursor.read(8)
+    name = cursor.read(16)
+    return version, flags, width, height, offset, length, name
+
+
+def parse_batched(cursor):
+    cursor.seek(0)
+    cursor.expect(MAGIC)
+    cursor.skip(6)
+    return cursor.read_many(FIELDS)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-n", "--number", type=int, default=500000, help="headers per measure")
+    parser.add_argument("-r", "--repeat", type=int, default=5, help="number of measures")
+    args = parser.parse_args()
+
+    cursor = Cursor(HEADER)
+    for label, func in [
+        ("read (loop)", parse_read),
+        ("read (unrolled)", parse_unrolled),
+        ("expect/skip/read_many", parse_batched),
+    ]:
+        times = timeit.repeat(lambda: func(cursor), number=args.number, repeat=args.repeat)
+        print("{:<22} {:>8.1f} ns/header".format(label, min(times) / args.number * 1e9))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,59 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Compare loading many files into cursors sequentially and with `load_many`.
+"""
+
+import argparse
+import os
+import tempfile
+import timeit
+
+import iocursor.loader
+from iocursor import Cursor, load_many
+
+
+def load_threads(paths, cursors, queue_depth):
+    available = iocursor.loader._uring_available
+    iocursor.loader._uring_available = False
+    try:
+        load_many(zip(paths, cursors), queue_depth)
+    finally:
+        iocursor.loader._uring_available = available
+
+
+def load_sequential(paths, cursors):
+    for path, cursor in zip(paths, cursors):
+        with open(path, "rb", buffering=0) as f:
+            f.readinto(cursor.getbuffer())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-f", "--files", type=int, default=2000, help="number of files")
+    parser.add_argument("-s", "--size", type=int, default=16384, help="size of each file")
+    parser.add_argument("-q", "--queue-depth", type=int, default=32, help="queue depth of load_many")
+    parser.add_argument("-r", "--repeat", type=int, default=5, help="number of measures")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as folder:
+        paths = [os.path.join(folder, "{}.bin".format(i)) for i in range(args.files)]
+        for path in paths:
+            with open(path, "wb") as f:
+                f.write(os.urandom(args.size))
+        cursors = [Cursor(bytearray(args.size)) for _ in paths]
+
+        def rewind():
+            for cursor in cursors:
+                cursor.seek(0)
+
+        for label, func in [
+            ("open and readinto", lambda: load_sequential(paths, cursors)),
+            ("load_many (threads)", lambda: load_threads(paths, cursors, args.queue_depth)),
+            ("load_many", lambda: load_many(zip(paths, cursors), args.queue_depth)),
+        ]:
+            times = timeit.repeat(func, setup=rewind, number=1, repeat=args.repeat)
+            print("{:<20} {:>8.1f} us/file".format(label, min(times) / args.files * 1e6))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,64 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Compare lookups in sorted fixed-size records with Python and C searches.
+"""
+
+import argparse
+import random
+import struct
+import timeit
+
+from iocursor import Cursor
+
+
+def python_bisect(cursor, keys, record_size):
+    results = []
+    count = len(cursor.getbuffer()) // record_size
+    for key in keys:
+        lo, hi = 0, count
+        while lo < hi:
+            mid = (lo + hi) // 2
+            cursor.seek(mid * record_size)
+            if struct.unpack("<Q", cursor.read(8))[0] < key:
+                lo = mid + 1
+            else:
+                hi = mid
+        results.append(lo)
+    return results
+
+
+def cursor_bisect(cursor, keys, record_size):
+    return [cursor.bisect(key, record_size, key_type="u64le") for key in keys]
+
+
+def cursor_bisect_many(cursor, keys, record_size):
+    return cursor.bisect_many(keys, record_size, key_type="u64le")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-c", "--count", type=int, default=1 << 22, help="number of records")
+    parser.add_argument("-s", "--record-size", type=int, default=32, help="size of each record")
+    parser.add_argument("-k", "--keys", type=int, default=100000, help="number of keys to look up")
+    parser.add_argument("-r", "--repeat", type=int, default=3, help="number of measures")
+    args = parser.parse_args()
+
+    rng = random.Random(42)
+    padding = bytes(args.record_size - 8)
+    data = b"".join(struct.pack("<Q", 2 * i) + padding for i in range(args.count))
+    keys = [rng.randrange(2 * args.count) for _ in range(args.keys)]
+    cursor = Cursor(data)
+
+    expected = cursor_bisect_many(cursor, keys, args.record_size)
+    for label, func in [
+        ("seek + read", python_bisect),
+        ("bisect", cursor_bisect),
+        ("bisect_many", cursor_bisect_many),
+    ]:
+        assert func(cursor, keys, args.record_size) == expected
+        times = timeit.repeat(lambda: func(cursor, keys, args.record_size), number=1, repeat=args.repeat)
+        print("{:<12} {:>10.1f} ns/lookup".format(label, min(times) / args.keys * 1e9))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,54 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Compare loading pickles from a `Cursor` with `pickle.loads`.
+"""
+
+import argparse
+import io
+import pickle
+import timeit
+
+from iocursor import Cursor
+
+
+def make_payloads(size):
+    small = [{"id": i, "name": "item{}".format(i), "tags": ["a", "b"]} for i in range(1000)]
+    large = [pickle.PickleBuffer(bytearray(size)) for _ in range(8)]
+    return {"small objects": small, "large buffers": large}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-s", "--size", type=int, default=1 << 20, help="size of large buffers")
+    parser.add_argument("-n", "--number", type=int, default=100, help="loads per measure")
+    parser.add_argument("-r", "--repeat", type=int, default=5, help="number of measures")
+    args = parser.parse_args()
+
+    for name, obj in make_payloads(args.size).items():
+        data = pickle.dumps(obj, protocol=5)
+
+        buffers = []
+        oob = pickle.dumps(obj, protocol=5, buffer_callback=buffers.append)
+        raw = [b.raw() for b in buffers]
+        blob = b"".join(raw)
+        sizes = [r.nbytes for r in raw]
+
+        def load_oob():
+            views = Cursor(blob)
+            return pickle.loads(oob, buffers=[pickle.PickleBuffer(views.read_view(n)) for n in sizes])
+
+        benches = {
+            "pickle.loads(bytes)": lambda: pickle.loads(data),
+            "pickle.load(BytesIO)": lambda: pickle.load(io.BytesIO(data)),
+            "pickle.load(Cursor)": lambda: pickle.load(Cursor(data)),
+            "out-of-band Cursor views": load_oob,
+        }
+
+        print("{} ({} bytes)".format(name, len(data)))
+        for label, func in benches.items():
+            times = timeit.repeat(func, number=args.number, repeat=args.repeat)
+            print("  {:<26} {:>10.1f} µs/load".format(label, min(times) / args.number * 1e6))
+
+
+if __name__ == "__main__":
+    main()
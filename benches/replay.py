@@ -0,0 +1,133 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Replay an access trace recorded by `Cursor.trace` against several backends.
+
+Record a trace by wrapping the data given to a consumer library in a
+`Cursor` created with ``trace=True``, then save the trace and the data::
+
+    cursor = Cursor(imgdata, trace=True)
+    Image.open(cursor).load()
+    with open("image.trace", "wb") as f:
+        f.write(cursor.trace())
+
+The trace can then be replayed offline with::
+
+    $ python benches/replay.py image.trace image.png
+
+"""
+
+import argparse
+import io
+import mmap
+import struct
+import timeit
+
+from iocursor import Cursor
+
+MAGIC = b"IOCT"
+VERSION = 1
+HEADER = struct.Struct("<4sBQ")
+RECORD = struct.Struct("<BQQ")
+OPS = ("read", "readinto", "readline", "readlines", "seek", "write", "writelines")
+
+
+class MappedFile(mmap.mmap):
+    """A `mmap.mmap` with the `readinto` and `readlines` methods it lacks.
+    """
+
+    def readinto(self, b):
+        data = self.read(len(b))
+        b[:len(data)] = data
+        return len(data)
+
+    def readlines(self, hint=-1):
+        lines, total = [], 0
+        for line in iter(self.readline, b""):
+            lines.append(line)
+            total += len(line)
+            if 0 < hint <= total:
+                break
+        return lines
+
+
+def load_trace(data):
+    """Parse a serialized access trace into a list of ``(op, offset, size)``.
+    """
+    magic, version, dropped = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError("not an access trace")
+    if version != VERSION:
+        raise ValueError("unsupported trace version: {}".format(version))
+    if dropped:
+        raise ValueError("{} records were dropped from the trace".format(dropped))
+    return [
+        (OPS[op], offset, size)
+        for op, offset, size in RECORD.iter_unpack(memoryview(data)[HEADER.size:])
+    ]
+
+
+def replay(trace, f):
+    """Replay the operations of ``trace`` on the file-like object ``f``.
+    """
+    scratch = bytearray(max((size for _, _, size in trace), default=0))
+    view = memoryview(scratch)
+    for op, offset, size in trace:
+        if op == "read":
+            f.read(size)
+        elif op == "readinto":
+            f.readinto(view[:size])
+        elif op == "readline":
+            f.readline()
+        elif op == "readlines":
+            f.readlines(size)
+        elif op == "seek":
+            f.seek(offset)
+        else:
+            f.seek(offset)
+            f.write(view[:size])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("trace", help="the path to the recorded trace")
+    parser.add_argument("data", help="the path to the data the trace was recorded on")
+    parser.add_argument("-n", "--number", type=int, default=1000, help="replays per measure")
+    parser.add_argument("-r", "--repeat", type=int, default=5, help="number of measures")
+    args = parser.parse_args()
+
+    with open(args.trace, "rb") as f:
+        trace = load_trace(f.read())
+    with open(args.data, "rb") as f:
+        data = f.read()
+        mm = MappedFile(f.fileno(), 0, access=mmap.ACCESS_COPY)
+
+    # `BytesIO` shares `data` until it is written to, so writable copies
+    # for `Cursor` are made before each measure rather than while timing
+    writes = any(op in ("write", "writelines") for op, _, _ in trace)
+    buffers = iter(())
+
+    def copy_buffers():
+        nonlocal buffers
+        buffers = iter([bytearray(data) for _ in range(args.number)] if writes else ())
+
+    backends = {
+        "Cursor": lambda: Cursor(next(buffers) if writes else data),
+        "BytesIO": lambda: io.BytesIO(data),
+        "mmap": lambda: (mm.seek(0), mm)[1],
+    }
+
+    print("replaying {} operations ({} bytes of data)".format(len(trace), len(data)))
+    for name, factory in backends.items():
+        times = timeit.repeat(
+            lambda: replay(trace, factory()),
+            setup=copy_buffers,
+            number=args.number,
+            repeat=args.repeat,
+        )
+        print("{:<8} {:>10.3f} µs/replay".format(name, min(times) / args.number * 1e6))
+
+    mm.close()
+
+
+if __name__ == "__main__":
+    main()
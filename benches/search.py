@@ -0,0 +1,46 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Compare searching markers in a buffer with `Cursor` and `bytes` methods.
+"""
+
+import argparse
+import random
+import timeit
+
+from iocursor import Cursor
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-s", "--size", type=int, default=64 << 20, help="size of the buffer")
+    parser.add_argument("-n", "--number", type=int, default=5, help="searches per measure")
+    parser.add_argument("-r", "--repeat", type=int, default=3, help="number of measures")
+    args = parser.parse_args()
+
+    # a MIME-like body where the first byte of the boundary is frequent,
+    # and the boundary itself is only found at the very end, with a
+    # header at the very start for reverse searches
+    rng = random.Random(42)
+    line = bytes(rng.randrange(32, 127) for _ in range(78)) + b"\r\n"
+    boundary = b"\r\n--8a6f3c9e2b"
+    data = bytearray(b"%PDF-" + line * (args.size // len(line)) + boundary + b"--\r\n")
+    cursor = Cursor(data)
+
+    benches = [
+        ("bytes(buffer).find", lambda: bytes(data).find(boundary)),
+        ("bytearray.find", lambda: data.find(boundary)),
+        ("Cursor.find", lambda: cursor.find(boundary)),
+        ("bytearray.rfind", lambda: data.rfind(b"%PDF-")),
+        ("Cursor.rfind", lambda: cursor.rfind(b"%PDF-")),
+        ("bytearray.count", lambda: data.count(b"\r\n")),
+        ("Cursor.count", lambda: cursor.count(b"\r\n")),
+        ("min of finds", lambda: min(i for i in (data.find(boundary + b"--"), data.find(boundary)) if i >= 0)),
+        ("Cursor.find_any", lambda: cursor.find_any([boundary + b"--", boundary])),
+    ]
+    for label, func in benches:
+        times = timeit.repeat(func, number=args.number, repeat=args.repeat)
+        print("{:<20} {:>8.1f} GB/s".format(label, len(data) * args.number / min(times) / 1e9))
+
+
+if __name__ == "__main__":
+    main()
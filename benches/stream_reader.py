@@ -0,0 +1,69 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Compare parsing in-memory messages with `AsyncCursor` and `StreamReader`.
+"""
+
+import argparse
+import asyncio
+import time
+
+from iocursor.aio import AsyncCursor
+
+
+def make_messages(count, size):
+    body = b"x" * size
+    header = "Content-Length: {}\r\n\r\n".format(size).encode()
+    return (header + body) * count
+
+
+async def parse(reader):
+    count = 0
+    while not reader.at_eof():
+        header = await reader.readuntil(b"\r\n\r\n")
+        size = int(header[16:-4])
+        await reader.readexactly(size)
+        count += 1
+    return count
+
+
+async def parse_stream_reader(data, chunk):
+    reader = asyncio.StreamReader(limit=max(chunk, 2 ** 16))
+    for i in range(0, len(data), chunk):
+        reader.feed_data(data[i:i+chunk])
+    reader.feed_eof()
+    return await parse(reader)
+
+
+async def parse_async_cursor(data, chunk):
+    return await parse(AsyncCursor(data))
+
+
+async def measure(func, data, chunk, repeat):
+    times = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        await func(data, chunk)
+        times.append(time.perf_counter() - start)
+    return min(times)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-c", "--count", type=int, default=10000, help="number of messages")
+    parser.add_argument("-s", "--size", type=int, default=256, help="size of message bodies")
+    parser.add_argument("-k", "--chunk", type=int, default=2 ** 16, help="size of chunks fed to StreamReader")
+    parser.add_argument("-r", "--repeat", type=int, default=5, help="number of measures")
+    args = parser.parse_args()
+
+    data = make_messages(args.count, args.size)
+    loop = asyncio.new_event_loop()
+    try:
+        for label, func in [("StreamReader", parse_stream_reader), ("AsyncCursor", parse_async_cursor)]:
+            best = loop.run_until_complete(measure(func, data, args.chunk, args.repeat))
+            print("{:<14} {:>8.1f} ms ({:.0f} ns/message)".format(label, best * 1e3, best / args.count * 1e9))
+    finally:
+        loop.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,39 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Compare reading lines of text with `TextCursor` and `io.TextIOWrapper`.
+"""
+
+import argparse
+import io
+import timeit
+
+from iocursor import Cursor, TextCursor
+
+
+def make_text(lines, ascii):
+    word = "line" if ascii else "lígne"
+    return "".join("{} {} of some text\n".format(word, i) for i in range(lines)).encode()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-l", "--lines", type=int, default=100000, help="number of lines")
+    parser.add_argument("-r", "--repeat", type=int, default=5, help="number of measures")
+    args = parser.parse_args()
+
+    for kind, ascii in [("ASCII", True), ("non-ASCII", False)]:
+        data = make_text(args.lines, ascii)
+        benches = {
+            "TextIOWrapper(BytesIO)": lambda: list(io.TextIOWrapper(io.BytesIO(data), "utf-8", newline="\n")),
+            "TextIOWrapper(Cursor)": lambda: list(io.TextIOWrapper(Cursor(data), "utf-8", newline="\n")),
+            "TextCursor": lambda: list(TextCursor(data)),
+            "bytes.decode().splitlines": lambda: data.decode().splitlines(True),
+        }
+        print("{} ({} bytes)".format(kind, len(data)))
+        for label, func in benches.items():
+            times = timeit.repeat(func, number=1, repeat=args.repeat)
+            print("  {:<26} {:>8.1f} ns/line".format(label, min(times) / args.lines * 1e9))
+
+
+if __name__ == "__main__":
+    main()
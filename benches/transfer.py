@@ -0,0 +1,100 @@
+#!/usr/bin/env python
+# coding: utf-8
+"""Compare socket transfers through a `Cursor` over a loopback connection.
+"""
+
+import argparse
+import socket
+import threading
+import time
+
+from iocursor import Cursor
+
+
+def drain(sock, total):
+    buffer = bytearray(1 << 20)
+    view = memoryview(buffer)
+    while total > 0:
+        total -= sock.recv_into(view)
+
+
+def flood(sock, total):
+    view = memoryview(bytes(1 << 20))
+    while total > 0:
+        n = sock.send(view[:total])
+        total -= n
+
+
+def send_read(cursor, sock, chunk):
+    while True:
+        data = cursor.read(chunk)
+        if not data:
+            break
+        sock.sendall(data)
+
+
+def send_to(cursor, sock, chunk):
+    while cursor.send_to(sock, chunk):
+        pass
+
+
+def recv_write(cursor, sock, chunk):
+    buffer = bytearray(chunk)
+    remaining = len(cursor.getbuffer())
+    while remaining > 0:
+        n = sock.recv_into(buffer, min(chunk, remaining))
+        cursor.write(memoryview(buffer)[:n])
+        remaining -= n
+
+
+def reserve_recv_into(cursor, sock, chunk):
+    remaining = len(cursor.getbuffer())
+    while remaining > 0:
+        with cursor.reserve(min(chunk, remaining)) as view:
+            n = sock.recv_into(view)
+        cursor.commit_reserved(n)
+        remaining -= n
+
+
+def recv_from(cursor, sock, chunk):
+    remaining = len(cursor.getbuffer())
+    while remaining > 0:
+        remaining -= cursor.recv_from(sock, min(chunk, remaining))
+
+
+def measure(func, peer, data, chunk, repeat):
+    times = []
+    for _ in range(repeat):
+        a, b = socket.socketpair()
+        with a, b:
+            cursor = Cursor(data)
+            thread = threading.Thread(target=peer, args=(b, len(data)))
+            thread.start()
+            start = time.perf_counter()
+            func(cursor, a, chunk)
+            times.append(time.perf_counter() - start)
+            thread.join()
+    return min(times)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-s", "--size", type=int, default=256 << 20, help="number of bytes to transfer")
+    parser.add_argument("-c", "--chunk", type=int, default=1 << 20, help="size of each transfer")
+    parser.add_argument("-r", "--repeat", type=int, default=5, help="number of measures")
+    args = parser.parse_args()
+
+    benches = [
+        ("read + sendall", send_read, drain, bytes(args.size)),
+        ("send_to", send_to, drain, bytes(args.size)),
+        ("recv_into + write", recv_write, flood, bytearray(args.size)),
+        ("reserve + recv_into", reserve_recv_into, flood, bytearray(args.size)),
+        ("recv_from", recv_from, flood, bytearray(args.size)),
+    ]
+    for label, func, peer, data in benches:
+        best = measure(func, peer, data, args.chunk, args.repeat)
+        print("{:<20} {:>8.1f} MiB/s".format(label, args.size / best / (1 << 20)))
+
+
+if __name__ == "__main__":
+    main()
@@ -5,12 +5,20 @@
 import io
 import os
 
-from .cursor import Cursor
+from .cursor import BitCursor, Cursor, TextCursor, live_cursors, track_exports
+from .loader import load_many
 
 __author__ = "Martin Larralde <martin.larralde@embl.de>"
 __version__ = "0.1.4"
 __license__ = "MIT"
-__all__ = ["Cursor"]
+__all__ = [
+    "BitCursor",
+    "Cursor",
+    "TextCursor",
+    "live_cursors",
+    "load_many",
+    "track_exports",
+]
 
 io.IOBase.register(Cursor)  # type: ignore
 io.BufferedIOBase.register(Cursor)  # type: ignore
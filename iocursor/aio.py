@@ -0,0 +1,150 @@
+# coding: utf-8
+"""An `asyncio.StreamReader` facade over in-memory buffers.
+"""
+
+import asyncio
+import io
+import typing
+
+from .cursor import Cursor
+
+__all__ = ["AsyncCursor"]
+
+
+class AsyncCursor(object):
+    """An `asyncio.StreamReader` compatible reader over a `Cursor`.
+
+    The coroutine methods of this class complete on their first step,
+    without ever suspending, so awaiting them does not go through the
+    event loop. Data is copied once, directly from the cursor buffer,
+    instead of being fed to the internal buffer of a `StreamReader`.
+
+    Example:
+        >>> async def parse(reader):
+        ...     header = await reader.readuntil(b"\\r\\n")
+        ...     return await reader.readexactly(int(header))
+        >>> asyncio.run(parse(AsyncCursor(b"5\\r\\nhello")))
+        b'hello'
+
+    """
+
+    def __init__(
+        self,
+        buffer: typing.Any,
+        limit: typing.Optional[int] = None,
+    ) -> None:
+        """Create a new reader over a buffer.
+
+        Arguments:
+            buffer (object): An object implementing the buffer protocol,
+                or an existing `Cursor` to read from.
+            limit (int, *optional*): The maximum length of the chunks
+                returned by `readline` and `readuntil`, as with the
+                ``limit`` argument of `StreamReader`. If `None`, the
+                chunks are not limited.
+
+        """
+        if isinstance(buffer, Cursor):
+            self.cursor = buffer
+        else:
+            self.cursor = Cursor(buffer, readonly=True)
+        self.limit = limit
+
+    def __aiter__(self) -> "AsyncCursor":
+        return self
+
+    async def __anext__(self) -> bytes:
+        line = await self.readline()
+        if not line:
+            raise StopAsyncIteration
+        return line
+
+    def _remaining(self) -> int:
+        # measure the buffer instead of seeking to its end, so that no seek
+        # shows up in the cursor statistics or trace
+        with self.cursor.getbuffer() as view:
+            return max(len(view) - self.cursor.tell(), 0)
+
+    def exception(self) -> typing.Optional[BaseException]:
+        """Get the exception set on the stream, which is always `None`."""
+        return None
+
+    def at_eof(self) -> bool:
+        """Return `True` if the whole buffer was read."""
+        return not self.cursor.peek(1)
+
+    async def read(self, n: int = -1) -> bytes:
+        """Read up to ``n`` bytes, or until EOF if ``n`` is negative."""
+        if n == 0:
+            return b""
+        return self.cursor.read(n)
+
+    async def readexactly(self, n: int) -> bytes:
+        """Read exactly ``n`` bytes.
+
+        Raises:
+            `asyncio.IncompleteReadError`: When EOF is reached before
+                ``n`` bytes could be read.
+
+        """
+        if n < 0:
+            raise ValueError("readexactly size can not be less than zero")
+        data = self.cursor.read(n)
+        if len(data) < n:
+            raise asyncio.IncompleteReadError(data, n)
+        return data
+
+    async def readuntil(self, separator: bytes = b"\n") -> bytes:
+        """Read data until ``separator`` is found, and return it included.
+
+        Raises:
+            `asyncio.IncompleteReadError`: When EOF is reached before the
+                separator is found.
+            `asyncio.LimitOverrunError`: When the data before the
+                separator is longer than the reader limit. The data is
+                not consumed in this case.
+
+        """
+        if not separator:
+            raise ValueError("Separator should be at least one-byte string")
+        cursor = self.cursor
+        index = cursor.find(separator)
+        if index == -1:
+            remaining = self._remaining()
+            consumed = remaining + 1 - len(separator)
+            if self.limit is not None and consumed > self.limit:
+                raise asyncio.LimitOverrunError(
+                    "Separator is not found, and chunk exceed the limit", consumed
+                )
+            raise asyncio.IncompleteReadError(cursor.read(), None)
+        position = cursor.tell()
+        if self.limit is not None and index - position > self.limit:
+            raise asyncio.LimitOverrunError(
+                "Separator is found, but chunk is longer than limit", index - position
+            )
+        return cursor.read(index + len(separator) - position)
+
+    async def readline(self) -> bytes:
+        """Read one line, ending with ``\\n``, or until EOF.
+
+        Raises:
+            `ValueError`: When the line is longer than the reader limit.
+                The line is consumed in this case, or the whole buffer
+                if no newline was found.
+
+        """
+        cursor = self.cursor
+        if self.limit is None:
+            return cursor.readline()
+        position = cursor.tell()
+        try:
+            return await self.readuntil(b"\n")
+        except asyncio.IncompleteReadError as err:
+            return err.partial
+        except asyncio.LimitOverrunError as err:
+            index = position + err.consumed
+            if cursor.find(b"\n", index, index + 1) == index:
+                cursor.seek(index + 1)
+            else:
+                cursor.seek(0, io.SEEK_END)
+            raise ValueError(err.args[0])
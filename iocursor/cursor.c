@@ -1,5 +1,8 @@
+#include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -7,8 +10,39 @@
 #include <Python.h>
 #include <structmember.h>
 
+#ifdef MS_WINDOWS
+#include <io.h>
+#include <malloc.h>
+#else
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CURSOR_SSE2
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_RW_CUR_POS)
+#define CURSOR_URING
+#endif
+#endif
+#endif
+
 #include "cursor.h"
 
+/* The size above which bulk memory operations release the GIL */
+#define CURSOR_NOGIL_SIZE (1 << 16)
+
+/* The size of huge pages requested by `Cursor.allocate` */
+#define CURSOR_HUGEPAGE_SIZE (2 << 20)
+
 // --------------------------------------------------------------------------
 
 static inline bool
@@ -21,10 +55,13 @@ check_closed(cursor *self)
     return false;
 }
 
+/* Check the cursor can be written to. Copy-on-write buffers are only
+   copied by `cursor_save`, once the arguments of the write are known to
+   be valid, so that a failed write does not copy the buffer. */
 static int
 check_writable(cursor *self)
 {
-    if (self->readonly) {
+    if (self->readonly && !self->copy_on_write) {
         PyObject* err = PyCursor_getunsupportedoperation();
         if (err != NULL)
             PyErr_SetString(err, "not writable");
@@ -33,1074 +70,8041 @@ check_writable(cursor *self)
     return false;
 }
 
-// --------------------------------------------------------------------------
-
 static bool
-_convert_iter(PyObject* obj, PyObject** it)
+check_space_at(cursor *self, Py_ssize_t position, Py_ssize_t nbytes)
 {
-    PyObject* tmp = PyObject_GetIter(obj);
-    if (tmp == NULL)
-        return false;
+    if ((position >= self->buffer.len) || (nbytes > self->buffer.len - position)) {
+        PyErr_Format(
+            PyExc_BufferError,
+            "cannot write %zd bytes to buffer of size %zd at position %zd",
+            nbytes,
+            self->buffer.len,
+            position
+        );
+        return true;
+    }
+    return false;
+}
 
-    *it = tmp;
-    return true;
+static inline bool
+check_space(cursor *self, Py_ssize_t nbytes)
+{
+    return check_space_at(self, self->offset, nbytes);
 }
 
 static bool
-_convert_optional_size(PyObject* obj, Py_ssize_t* s)
+check_available(cursor *self, Py_ssize_t nbytes)
 {
-    if (obj == Py_None)
+    if ((self->offset > self->buffer.len) || (nbytes > self->buffer.len - self->offset)) {
+        PyErr_Format(
+            PyExc_EOFError,
+            "cannot read %zd bytes from buffer of size %zd at position %zd",
+            nbytes,
+            self->buffer.len,
+            self->offset
+        );
         return true;
-
-    PyObject* n = PyNumber_Index(obj);
-    if (n == NULL)
-        return false;
-
-    Py_ssize_t tmp = PyLong_AsSsize_t(n);
-    Py_DECREF(n);
-
-    if (PyErr_Occurred())
-        return false;
-
-    *s = tmp;
-    return true;
+    }
+    return false;
 }
 
-// --------------------------------------------------------------------------
-
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor_close___doc__,
-  "close(self)\n"
-  "--\n"
-  "\n"
-  "Disable all I/O operations.\n"
-  "\n"
-  "This method will effectively release the view on the buffer memory\n"
-  "wrapped by the cursor.\n"
-);
-
-static PyObject*
-iocursor_cursor_Cursor_close_impl(cursor* self)
+static bool
+check_position(Py_ssize_t position, const char* name)
 {
-    if (!self->closed) {
-        PyBuffer_Release(&self->buffer);
-        self->closed = true;
+    if (position < 0) {
+        PyErr_Format(PyExc_ValueError, "negative %s value %zd", name, position);
+        return true;
     }
-    Py_RETURN_NONE;
+    return false;
 }
 
 // --------------------------------------------------------------------------
 
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor_detach___doc__,
-  "detach(self)\n"
-  "--\n"
-  "\n"
-  "Disconnect the wrapper from its underlying raw stream.\n"
-  "\n"
-  "This is not supported by `Cursor` instances, since they do not wrap\n"
-  "a raw stream, and calling this method will effectively raise the\n"
-  "`io.UnsupportedOperation` exception.\n"
-);
-
-static PyObject*
-iocursor_cursor_Cursor_detach_impl(cursor* self)
+/* Allocate `size` bytes of zeroed memory aligned on `alignment` bytes,
+   optionally backed by huge pages. `mapped` is set to the size of the
+   mapping if the memory had to be obtained with `mmap`. This does not
+   use the Python API, and can be called with the GIL released. */
+static void*
+_aligned_memory_alloc(size_t size, size_t alignment, bool hugepages, size_t* mapped)
 {
-    PyObject* err = PyCursor_getunsupportedoperation();
-    if (err != NULL)
-        PyErr_SetString(err, "detach");
-    return NULL;
-}
+    void* memory = NULL;
 
-// --------------------------------------------------------------------------
+    *mapped = 0;
 
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor_fileno___doc__,
-  "fileno(self)\n"
-  "--\n"
-  "\n"
-  "Return the underlying file descriptor if one exists.\n"
-  "\n"
-  "This is not supported by `Cursor` instances, since they do not wrap\n"
-  "a file descriptor, and calling this method will effectively raise\n"
-  "the `io.UnsupportedOperation` exception.\n"
-);
+#ifdef MS_WINDOWS
+    memory = _aligned_malloc(size > 0 ? size : 1, alignment);
+#else
+    if (hugepages) {
+        if (alignment < CURSOR_HUGEPAGE_SIZE)
+            alignment = CURSOR_HUGEPAGE_SIZE;
+#ifdef MAP_HUGETLB
+        /* Try to get explicit huge pages first, which are only available
+           if the system has some reserved, and fall back to transparent
+           huge pages otherwise */
+        if (alignment == CURSOR_HUGEPAGE_SIZE && size > 0) {
+            size_t length = (size + CURSOR_HUGEPAGE_SIZE - 1) & ~((size_t) CURSOR_HUGEPAGE_SIZE - 1);
+            memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (memory != MAP_FAILED) {
+                *mapped = length;
+                return memory;
+            }
+        }
+#endif
+    }
+    if (posix_memalign(&memory, alignment, size > 0 ? size : 1) != 0)
+        return NULL;
+#ifdef MADV_HUGEPAGE
+    if (hugepages && size > 0)
+        madvise(memory, size, MADV_HUGEPAGE);
+#endif
+#endif
 
-static PyObject*
-iocursor_cursor_Cursor_fileno_impl(cursor* self)
-{
-    PyObject* err = PyCursor_getunsupportedoperation();
-    if (err != NULL)
-        PyErr_SetString(err, "fileno");
-    return NULL;
+    if (memory != NULL)
+        memset(memory, 0, size);
+    return memory;
 }
 
 // --------------------------------------------------------------------------
 
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor_flush___doc__,
-  "flush(self)\n"
-  "--\n"
-  "\n"
-  "Flush write buffers, if applicable.\n"
-  "\n"
-  "This is a no-op for `Cursor`, since they write directly to the\n"
-  "provided buffer.\n"
-);
+/* The copy engine used by large reads and writes. Copies larger than the
+   streaming size bypass the cache with non-temporal stores, so that they
+   do not evict the working set of the program, and copies larger than
+   the parallel size are split across several threads. Both sizes are
+   tuned at module initialization, and can be changed with `copy_engine`. */
+#ifdef CURSOR_SSE2
+#define CURSOR_COPY_STREAM
+#endif
+#ifndef MS_WINDOWS
+#define CURSOR_COPY_PARALLEL
+#endif
 
-static PyObject*
-iocursor_cursor_Cursor_flush_impl(cursor* self)
+/* The maximum number of threads used for a single copy */
+#define CURSOR_COPY_THREADS_MAX 16
+
+static Py_ssize_t cursor_copy_stream_size   = PY_SSIZE_T_MAX;
+static Py_ssize_t cursor_copy_parallel_size = 64 << 20;
+static int        cursor_copy_threads       = 1;
+
+/* Copy `n` bytes with non-temporal stores, if supported. This does not
+   use the Python API, and can be called with the GIL released. */
+static void
+_copy_stream(char* dst, const char* src, size_t n)
 {
-    if (check_closed(self))
-        return NULL;
-    Py_RETURN_NONE;
+#ifdef CURSOR_COPY_STREAM
+    size_t head = (16 - ((uintptr_t) dst & 15)) & 15;
+
+    /* Copy the head with regular stores to align the destination */
+    if (head > n)
+        head = n;
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    n -= head;
+
+    /* Stream whole cache lines to the destination */
+    for (; n >= 64; n -= 64, dst += 64, src += 64) {
+        __m128i a = _mm_loadu_si128((const __m128i*) &src[0]);
+        __m128i b = _mm_loadu_si128((const __m128i*) &src[16]);
+        __m128i c = _mm_loadu_si128((const __m128i*) &src[32]);
+        __m128i d = _mm_loadu_si128((const __m128i*) &src[48]);
+        _mm_stream_si128((__m128i*) &dst[0], a);
+        _mm_stream_si128((__m128i*) &dst[16], b);
+        _mm_stream_si128((__m128i*) &dst[32], c);
+        _mm_stream_si128((__m128i*) &dst[48], d);
+    }
+
+    /* Make the streamed data visible before copying the tail */
+    _mm_sfence();
+#endif
+    memcpy(dst, src, n);
 }
 
-// --------------------------------------------------------------------------
+#ifdef CURSOR_COPY_PARALLEL
+typedef struct copy_task {
+    char*       dst;
+    const char* src;
+    size_t      n;
+} copy_task;
 
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor_getvalue___doc__,
-  "getvalue(self)\n"
-  "--\n"
-  "\n"
-  "Retrieve the backing memory buffer of the `Cursor` object.\n"
-  "\n"
-  "Example:\n"
-  "    >>> cursor = Cursor(bytearray(4))\n"
-  "    >>> cursor.write(b'abc')\n"
-  "    3\n"
-  "    >>> cursor.getvalue()\n"
-  "    bytearray(b'abc\\x00')\n"
-  "\n"
-);
+static void*
+_copy_worker(void* arg)
+{
+    copy_task* task = (copy_task*) arg;
+    _copy_stream(task->dst, task->src, task->n);
+    return NULL;
+}
+#endif
 
-static PyObject*
-iocursor_cursor_Cursor_getvalue_impl(cursor* self)
+/* Copy `n` bytes using the calling thread and up to `threads - 1`
+   other threads. Threads are only started for the duration of the copy,
+   since their startup cost is negligible next to the copy itself. This
+   does not use the Python API, and can be called with the GIL released. */
+static void
+_copy_parallel(char* dst, const char* src, size_t n, int threads)
 {
-    if (check_closed(self))
-        return NULL;
-    Py_INCREF(self->source);
-    return self->source;
+#ifdef CURSOR_COPY_PARALLEL
+    pthread_t  handles[CURSOR_COPY_THREADS_MAX];
+    copy_task  tasks[CURSOR_COPY_THREADS_MAX];
+    bool       started[CURSOR_COPY_THREADS_MAX];
+    size_t     chunk;
+    size_t     offset;
+    int        i;
+
+    /* Split on cache line boundaries so that threads never share one */
+    chunk = ((n + threads - 1) / threads + 63) & ~((size_t) 63);
+    for (i = 0, offset = 0; i < threads; i++, offset += chunk) {
+        tasks[i].dst = &dst[offset];
+        tasks[i].src = &src[offset];
+        tasks[i].n = offset >= n ? 0 : Py_MIN(chunk, n - offset);
+    }
+
+    /* Run the first chunk in the calling thread, and any chunk whose
+       thread could not be started as well */
+    for (i = 1; i < threads; i++)
+        started[i] = tasks[i].n > 0 && pthread_create(&handles[i], NULL, _copy_worker, &tasks[i]) == 0;
+    _copy_stream(tasks[0].dst, tasks[0].src, tasks[0].n);
+    for (i = 1; i < threads; i++) {
+        if (started[i])
+            pthread_join(handles[i], NULL);
+        else
+            _copy_stream(tasks[i].dst, tasks[i].src, tasks[i].n);
+    }
+#else
+    _copy_stream(dst, src, n);
+#endif
 }
 
-// --------------------------------------------------------------------------
+/* Copy `n` bytes between the cursor buffer and another buffer, with the
+   engine selected by the copy size. The cursor buffer is pinned while
+   the GIL is released for large copies. */
+static void
+cursor_copy(cursor* self, void* dst, const void* src, Py_ssize_t n)
+{
+    if (n < cursor_copy_stream_size) {
+        memcpy(dst, src, n);
+        return;
+    }
 
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor_isatty___doc__,
-  "isatty(self)\n"
-  "--\n"
-  "\n"
-  "Return whether the stream is attached to a TTY device.\n"
-  "\n"
-  "On `Cursor` instances, always return `False`.\n"
-);
+    self->exports++;
+    Py_BEGIN_ALLOW_THREADS
+    if (n >= cursor_copy_parallel_size && cursor_copy_threads > 1)
+        _copy_parallel((char*) dst, (const char*) src, (size_t) n, cursor_copy_threads);
+    else
+        _copy_stream((char*) dst, (const char*) src, (size_t) n);
+    Py_END_ALLOW_THREADS
+    self->exports--;
+}
 
-static PyObject*
-iocursor_cursor_Cursor_isatty_impl(cursor* self)
+/* Tune the copy engine for the host, using one thread per core up to a
+   small number, since a few threads are enough to saturate the memory
+   bandwidth. Streaming is left disabled: non-temporal stores evict the
+   destination of `readinto` right before it is usually read, and were
+   not measured faster than `memcpy`, so they must be enabled with
+   `copy_engine` where `benches/copy.py` shows a benefit. */
+static void
+copy_engine_init(void)
 {
-    if (check_closed(self))
-        return NULL;
-    Py_RETURN_FALSE;
+#ifndef MS_WINDOWS
+    long cpus;
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cursor_copy_threads = cpus > 1 ? (int) Py_MIN(cpus, 4) : 1;
+#endif
 }
 
 // --------------------------------------------------------------------------
 
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor_read___doc__,
-  "read(self, size=-1)\n"
-  "--\n"
-  "\n"
-  "Read at most ``size`` bytes, returned as a `bytes` object.\n"
-  "\n"
-  "An empty `bytes` object is returned at EOF.\n"
-  "\n"
-  "Arguments:\n"
-  "    size (int, *optional*): The number of bytes to read. If\n"
-  "        negative or `None`, read until EOF is reached.\n"
-  "\n"
-);
+/* The registry of cursors holding a buffer export, only filled while
+   enabled with `track_exports`. Cursors are linked through their own
+   fields, so that adding and removing them does not allocate. */
+#define CURSOR_TRACEMALLOC_DOMAIN 0x494F43  /* "IOC" */
 
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor_read1___doc__,
-  "read1(self, size=-1)\n"
-  "--\n"
-  "\n"
-  "Read at most ``size`` bytes with a single syscall.\n"
-  "\n"
-  "An empty `bytes` object is returned at EOF.\n"
-  "\n"
-  "Arguments:\n"
-  "    size (int, *optional*): The number of bytes to read. If\n"
-  "        negative or `None`, read until EOF is reached.\n"
-  "\n"
-);
+static cursor*   cursor_registry               = NULL;
+static bool      cursor_registry_enabled       = false;
+static int       cursor_registry_frames        = 0;
+static PyObject* cursor_registry_extract_stack = NULL;
 
-static inline PyObject*
-iocursor_cursor_Cursor_read_impl(cursor* self, Py_ssize_t size)
+/* Add a cursor to the registry after its buffer was exported */
+static void
+registry_add(cursor* self)
 {
-    if (check_closed(self))
-        return NULL;
-
-    if ((size == -1) || (self->offset >= self->buffer.len - size))
-        size = self->buffer.len - self->offset;
-    if (size < 0)
-        size = 0;
+    if (!cursor_registry_enabled || self->registered)
+        return;
 
-    PyObject* bytes = PyBytes_FromStringAndSize(&((char*) self->buffer.buf)[self->offset], size);
-    if (bytes == NULL) {
-        return PyErr_NoMemory();
+    /* Failing to get the traceback should not prevent creating a cursor */
+    if (cursor_registry_frames > 0 && cursor_registry_extract_stack != NULL) {
+        self->registry_traceback = PyObject_CallFunction(cursor_registry_extract_stack, "Oi", Py_None, cursor_registry_frames);
+        if (self->registry_traceback == NULL)
+            PyErr_Clear();
     }
 
-    self->offset += size;
-    return bytes;
+    self->registry_prev = NULL;
+    self->registry_next = cursor_registry;
+    if (cursor_registry != NULL)
+        cursor_registry->registry_prev = self;
+    cursor_registry = self;
+    self->registered = true;
+
+#if defined(CPYTHON) && PY_VERSION_HEX >= 0x03070000
+    /* The cursor address is used as the key, since several cursors
+       may export the same buffer */
+    PyTraceMalloc_Track(CURSOR_TRACEMALLOC_DOMAIN, (uintptr_t) self, (size_t) self->buffer.len);
+#endif
 }
 
-static PyObject*
-iocursor_cursor_Cursor_read(PyObject *self, PyObject *args, PyObject *kwargs)
+/* Remove a cursor from the registry before its buffer is released */
+static void
+registry_remove(cursor* self)
 {
-    assert(Py_TYPE(self) == &PyCursor_Type);
-
-    PyObject *return_value = NULL;
-    cursor* crs            = (cursor*) self;
-    Py_ssize_t size        = -1;
+    if (!self->registered)
+        return;
 
-    static char* keywords[] = {"size", NULL};
-    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &size)) {
-        return_value = iocursor_cursor_Cursor_read_impl(crs, size);
-    }
+    if (self->registry_prev != NULL)
+        self->registry_prev->registry_next = self->registry_next;
+    else
+        cursor_registry = self->registry_next;
+    if (self->registry_next != NULL)
+        self->registry_next->registry_prev = self->registry_prev;
+    self->registry_prev = NULL;
+    self->registry_next = NULL;
+    self->registered = false;
+    Py_CLEAR(self->registry_traceback);
+
+#if defined(CPYTHON) && PY_VERSION_HEX >= 0x03070000
+    PyTraceMalloc_Untrack(CURSOR_TRACEMALLOC_DOMAIN, (uintptr_t) self);
+#endif
+}
 
-    return return_value;
+static void
+registry_clear(void)
+{
+    while (cursor_registry != NULL)
+        registry_remove(cursor_registry);
+    Py_CLEAR(cursor_registry_extract_stack);
+    cursor_registry_enabled = false;
 }
 
 // --------------------------------------------------------------------------
 
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor_readable___doc__,
-  "readable(self)\n"
-  "--\n"
+/* Free the aligned memory owned by the cursor, if any */
+static void
+cursor_free_memory(cursor* self)
+{
+    if (self->memory == NULL)
+        return;
+#ifdef MS_WINDOWS
+    _aligned_free(self->memory);
+#else
+    if (self->memory_size > 0)
+        munmap(self->memory, self->memory_size);
+    else
+        free(self->memory);
+#endif
+    self->memory = NULL;
+    self->memory_size = 0;
+}
+
+/* Make the cursor wrap a new source object, from the start. With
+   `copy_on_write`, the source is only exported read-only, and copied by
+   `cursor_materialize` on the first write. */
+static int
+cursor_bind(cursor* self, PyObject* source, bool readonly, bool copy_on_write)
+{
+    int return_value = 0;
+
+    /* Allow binding more than once, in that case make sure to release
+       any previous object reference */
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "Existing exports of data: object cannot be re-sized");
+        return -1;
+    }
+    if (self->reserved) {
+        PyErr_SetString(PyExc_BufferError, "Pending reservation: object cannot be re-sized");
+        return -1;
+    }
+    self->offset = 0;
+    registry_remove(self);
+    if (self->buffer.buf != NULL)
+        PyBuffer_Release(&self->buffer);
+    self->buffer.buf = NULL;
+    cursor_free_memory(self);
+    Py_XDECREF(self->source);
+
+    /* Register the source object */
+    self->source = source;
+    Py_INCREF(source);
+
+    /* Mark the cursor as 'open' */
+    self->closed = false;
+    self->readonly = false;
+    self->copy_on_write = copy_on_write && !readonly;
+    if (copy_on_write)
+        readonly = true;
+
+    /* Avoid requesting a writable buffer from objects known to be
+       read-only, since a failed request raises an exception */
+    if (PyBytes_CheckExact(source))
+        readonly = true;
+    else if (PyMemoryView_Check(source) && PyMemoryView_GET_BUFFER(source)->readonly)
+        readonly = true;
+
+    /* Get a buffer for the source object */
+    if (!readonly) {
+        return_value = PyObject_GetBuffer(source, &self->buffer, PyBUF_SIMPLE | PyBUF_WRITABLE);
+        if (return_value < 0) {
+            PyErr_Clear();
+            readonly = true;
+            return_value = 0;
+        }
+    }
+
+    if (self->buffer.buf == NULL) {
+        return_value = PyObject_GetBuffer(source, &self->buffer, PyBUF_SIMPLE);
+        self->readonly = true;
+        /* Leave the cursor closed if the source has no buffer */
+        if (return_value < 0)
+            self->closed = true;
+    }
+
+    if (return_value == 0)
+        registry_add(self);
+    return return_value;
+}
+
+/* Replace the source of a copy-on-write cursor with a private copy of the
+   buffer, keeping the cursor position */
+static int
+cursor_materialize(cursor* self)
+{
+    Py_ssize_t offset = self->offset;
+    PyObject*  copy;
+    int        return_value;
+
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "Existing exports of data: object cannot be copied on write");
+        return -1;
+    }
+
+    copy = PyByteArray_FromStringAndSize(self->buffer.buf, self->buffer.len);
+    if (copy == NULL)
+        return -1;
+    return_value = cursor_bind(self, copy, false, false);
+    Py_DECREF(copy);
+    self->offset = offset;
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+static const char* cursor_op_names[CURSOR_OP_MAX] = {
+    [CURSOR_OP_READ]       = "read",
+    [CURSOR_OP_READINTO]   = "readinto",
+    [CURSOR_OP_READLINE]   = "readline",
+    [CURSOR_OP_READLINES]  = "readlines",
+    [CURSOR_OP_SEEK]       = "seek",
+    [CURSOR_OP_WRITE]      = "write",
+    [CURSOR_OP_WRITELINES] = "writelines",
+};
+
+static inline int
+_log2_bucket(Py_ssize_t size)
+{
+    int bucket = 0;
+    while (size > 0) {
+        size >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void
+stats_record(cursor_stats* stats, cursor_op op, Py_ssize_t nbytes)
+{
+    assert(stats != NULL);
+    assert(nbytes >= 0);
+
+    stats->calls[op]++;
+    stats->histogram[_log2_bucket(nbytes)]++;
+
+    switch (op) {
+        case CURSOR_OP_READ:
+        case CURSOR_OP_READINTO:
+        case CURSOR_OP_READLINE:
+        case CURSOR_OP_READLINES:
+            stats->bytes_read += nbytes;
+            break;
+        case CURSOR_OP_WRITE:
+        case CURSOR_OP_WRITELINES:
+            stats->bytes_written += nbytes;
+            break;
+        default:
+            break;
+    }
+}
+
+static void
+stats_record_seek(cursor_stats* stats, Py_ssize_t old_pos, Py_ssize_t new_pos)
+{
+    assert(stats != NULL);
+
+    stats->calls[CURSOR_OP_SEEK]++;
+    if (new_pos < old_pos) {
+        stats->backward_seeks++;
+        stats->seek_distance += old_pos - new_pos;
+    } else {
+        stats->seek_distance += new_pos - old_pos;
+    }
+}
+
+/* The magic header of serialized access traces, followed by a version byte */
+#define CURSOR_TRACE_MAGIC       "IOCT"
+#define CURSOR_TRACE_VERSION     1
+#define CURSOR_TRACE_HEADER_SIZE 13
+#define CURSOR_TRACE_RECORD_SIZE 17
+
+static void
+trace_record(cursor_trace* trace, cursor_op op, Py_ssize_t offset, Py_ssize_t nbytes)
+{
+    assert(trace != NULL);
+
+    if (trace->length == trace->capacity) {
+        size_t capacity = (trace->capacity == 0) ? 256 : trace->capacity * 2;
+        cursor_trace_record* records = PyMem_Realloc(trace->records, capacity * sizeof(cursor_trace_record));
+        if (records == NULL) {
+            trace->dropped++;
+            return;
+        }
+        trace->records = records;
+        trace->capacity = capacity;
+    }
+
+    trace->records[trace->length].op = (unsigned char) op;
+    trace->records[trace->length].offset = (unsigned long long) offset;
+    trace->records[trace->length].size = (unsigned long long) nbytes;
+    trace->length++;
+}
+
+static void
+trace_free(cursor_trace* trace)
+{
+    if (trace != NULL)
+        PyMem_Free(trace->records);
+    PyMem_Free(trace);
+}
+
+static inline void
+_write_u64le(unsigned char* dst, unsigned long long value)
+{
+    size_t i;
+    for (i = 0; i < 8; i++)
+        dst[i] = (unsigned char) (value >> (8*i));
+}
+
+// --------------------------------------------------------------------------
+
+static inline void
+cursor_record(cursor* self, cursor_op op, Py_ssize_t offset, Py_ssize_t nbytes)
+{
+    if (self->stats != NULL)
+        stats_record(self->stats, op, nbytes);
+    if (self->trace != NULL)
+        trace_record(self->trace, op, offset, nbytes);
+}
+
+static inline void
+cursor_record_seek(cursor* self, Py_ssize_t old_pos, Py_ssize_t new_pos)
+{
+    if (self->stats != NULL)
+        stats_record_seek(self->stats, old_pos, new_pos);
+    if (self->trace != NULL)
+        trace_record(self->trace, CURSOR_OP_SEEK, new_pos, 0);
+}
+
+// --------------------------------------------------------------------------
+
+/* Grow an array of the undo log to hold at least `needed` items */
+static int
+_undo_reserve(void** items, size_t* capacity, size_t needed, size_t itemsize)
+{
+    size_t new_capacity = (*capacity == 0) ? 16 : *capacity;
+    void*  new_items;
+
+    if (needed <= *capacity)
+        return 0;
+    while (new_capacity < needed)
+        new_capacity *= 2;
+    if ((new_items = PyMem_Realloc(*items, new_capacity * itemsize)) == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    *items = new_items;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static void
+undo_free(cursor_undo* undo)
+{
+    if (undo != NULL) {
+        PyMem_Free(undo->marks);
+        PyMem_Free(undo->records);
+        PyMem_Free(undo->data);
+    }
+    PyMem_Free(undo);
+}
+
+/* Drop all checkpoints and saved data, keeping the allocations */
+static void
+undo_clear(cursor_undo* undo)
+{
+    if (undo != NULL) {
+        undo->depth = 0;
+        undo->length = 0;
+        undo->size = 0;
+    }
+}
+
+/* Save `n` bytes of `buffer` at `offset` to the undo log. Writes that
+   continue the last range saved since the innermost checkpoint extend
+   that range instead of adding a record. */
+static int
+undo_save(cursor_undo* undo, const char* buffer, Py_ssize_t offset, Py_ssize_t n)
+{
+    cursor_undo_record* last;
+
+    assert(undo->depth > 0);
+    if (_undo_reserve((void**) &undo->data, &undo->allocated, undo->size + n, sizeof(char)) < 0)
+        return -1;
+
+    last = (undo->length > 0) ? &undo->records[undo->length - 1] : NULL;
+    if (last != NULL && undo->length > undo->marks[undo->depth - 1].records && last->offset + last->length == offset) {
+        last->length += n;
+    } else {
+        if (_undo_reserve((void**) &undo->records, &undo->capacity, undo->length + 1, sizeof(cursor_undo_record)) < 0)
+            return -1;
+        undo->records[undo->length].offset = offset;
+        undo->records[undo->length].length = n;
+        undo->records[undo->length].data = undo->size;
+        undo->length++;
+    }
+
+    memcpy(&undo->data[undo->size], &buffer[offset], n);
+    undo->size += n;
+    return 0;
+}
+
+/* Copy a copy-on-write buffer, if it was not copied yet */
+static inline int
+cursor_make_writable(cursor* self)
+{
+    if (self->readonly && self->copy_on_write)
+        return cursor_materialize(self);
+    return 0;
+}
+
+/* Prepare the `n` bytes of the buffer at `offset` to be overwritten, by
+   copying a copy-on-write buffer and saving the bytes if a checkpoint is
+   active. The buffer pointer must be read again after this call. */
+static inline int
+cursor_save(cursor* self, Py_ssize_t offset, Py_ssize_t n)
+{
+    if (n <= 0)
+        return 0;
+    if (cursor_make_writable(self) < 0)
+        return -1;
+    if (self->undo == NULL || self->undo->depth == 0)
+        return 0;
+    return undo_save(self->undo, (const char*) self->buffer.buf, offset, n);
+}
+
+/* Make a new checkpoint at the current position, returning its identifier */
+static int
+cursor_mark(cursor* self, unsigned long long* id)
+{
+    cursor_undo_mark* mark;
+
+    if (self->undo == NULL && (self->undo = PyMem_Calloc(1, sizeof(cursor_undo))) == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (_undo_reserve((void**) &self->undo->marks, &self->undo->marks_capacity, self->undo->depth + 1, sizeof(cursor_undo_mark)) < 0)
+        return -1;
+
+    mark = &self->undo->marks[self->undo->depth++];
+    mark->id = self->undo->next_id++;
+    mark->offset = self->offset;
+    mark->records = self->undo->length;
+    mark->size = self->undo->size;
+    if (id != NULL)
+        *id = mark->id;
+    return 0;
+}
+
+/* Check that a checkpoint is active, and the innermost one if `id` is given */
+static bool
+check_checkpoint(cursor* self, const unsigned long long* id)
+{
+    if (self->undo == NULL || self->undo->depth == 0) {
+        PyErr_SetString(PyExc_ValueError, "no active checkpoint");
+        return true;
+    }
+    if (id != NULL && self->undo->marks[self->undo->depth - 1].id != *id) {
+        PyErr_SetString(PyExc_ValueError, "checkpoint is not the innermost active checkpoint");
+        return true;
+    }
+    return false;
+}
+
+/* Release the innermost checkpoint, keeping the changes made since */
+static void
+cursor_commit(cursor* self)
+{
+    cursor_undo* undo = self->undo;
+
+    assert(undo != NULL && undo->depth > 0);
+    if (--undo->depth == 0)
+        undo_clear(undo);
+}
+
+/* Release the innermost checkpoint, restoring the overwritten ranges in
+   reverse order and the cursor position */
+static void
+cursor_rollback(cursor* self)
+{
+    cursor_undo*        undo = self->undo;
+    cursor_undo_mark*   mark;
+    cursor_undo_record* record;
+    Py_ssize_t          old_offset = self->offset;
+
+    assert(undo != NULL && undo->depth > 0);
+    mark = &undo->marks[undo->depth - 1];
+    while (undo->length > mark->records) {
+        record = &undo->records[--undo->length];
+        memcpy(&((char*) self->buffer.buf)[record->offset], &undo->data[record->data], record->length);
+    }
+    undo->size = mark->size;
+    self->offset = mark->offset;
+    undo->depth--;
+
+    cursor_record_seek(self, old_offset, self->offset);
+}
+
+// --------------------------------------------------------------------------
+
+/* Get the index of the lowest set bit of a non-zero mask */
+static inline int
+_mask_lowest(unsigned int mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    int i = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+/* Get the index of the highest set bit of a non-zero mask */
+static inline int
+_mask_highest(unsigned int mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 31 - __builtin_clz(mask);
+#else
+    int i = 31;
+    while (!(mask & (1u << i)))
+        i--;
+    return i;
+#endif
+}
+
+#ifdef CURSOR_SSE2
+/* Get a mask of the 16 positions starting at `data` where both the first
+   and the last byte of a needle of `n` bytes match */
+static inline unsigned int
+_search_block(const char* data, Py_ssize_t n, __m128i first, __m128i last)
+{
+    __m128i a = _mm_loadu_si128((const __m128i*) data);
+    __m128i b = _mm_loadu_si128((const __m128i*) &data[n - 1]);
+    return (unsigned int) _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+}
+#endif
+
+/* Find the first occurrence of `needle` in `data`, or return NULL.
+   Candidates are filtered on both the first and the last byte of the
+   needle, 16 positions at a time, which skips most of the false
+   positives of a first byte scan, e.g. on the `\r` of a MIME boundary. */
+static const char*
+_search_forward(const char* data, Py_ssize_t length, const char* needle, Py_ssize_t n)
+{
+    const char* found;
+    Py_ssize_t  i = 0;
+
+    if (n > length)
+        return NULL;
+    if (n == 0)
+        return data;
+    if (n == 1)
+        return memchr(data, needle[0], length);
+
+#ifdef CURSOR_SSE2
+    {
+        __m128i      first = _mm_set1_epi8(needle[0]);
+        __m128i      last  = _mm_set1_epi8(needle[n - 1]);
+        unsigned int mask;
+
+        for (; i + 16 <= length - n + 1; i += 16) {
+            for (mask = _search_block(&data[i], n, first, last); mask != 0; mask &= mask - 1) {
+                found = &data[i + _mask_lowest(mask)];
+                if (memcmp(found + 1, needle + 1, n - 1) == 0)
+                    return found;
+            }
+        }
+    }
+#endif
+
+    /* Look for the first byte of `needle` with memchr in the remaining
+       positions, and only compare the rest at the candidate positions */
+    data += i;
+    length -= i + n - 1;
+    while ((found = memchr(data, needle[0], length)) != NULL) {
+        if (memcmp(found + 1, needle + 1, n - 1) == 0)
+            return found;
+        length -= found - data + 1;
+        data = found + 1;
+    }
+    return NULL;
+}
+
+/* Find the last occurrence of `needle` in `data`, or return NULL */
+static const char*
+_search_backward(const char* data, Py_ssize_t length, const char* needle, Py_ssize_t n)
+{
+    const char* found;
+    Py_ssize_t  i;
+
+    if (n > length)
+        return NULL;
+    if (n == 0)
+        return &data[length];
+
+    /* `i` is one past the highest position left to check */
+    i = length - n + 1;
+
+#ifdef CURSOR_SSE2
+    {
+        __m128i      first = _mm_set1_epi8(needle[0]);
+        __m128i      last  = _mm_set1_epi8(needle[n - 1]);
+        unsigned int mask;
+        int          bit;
+
+        for (; i >= 16; i -= 16) {
+            for (mask = _search_block(&data[i - 16], n, first, last); mask != 0; mask &= ~(1u << bit)) {
+                bit = _mask_highest(mask);
+                found = &data[i - 16 + bit];
+                if (memcmp(found + 1, needle + 1, n - 1) == 0)
+                    return found;
+            }
+        }
+    }
+#endif
+
+    while (i-- > 0) {
+        if (data[i] == needle[0] && memcmp(&data[i + 1], needle + 1, n - 1) == 0)
+            return &data[i];
+    }
+    return NULL;
+}
+
+/* Clamp slice indices to the buffer, counting negative ones from the end,
+   like `bytes.find` does. Returns false if the slice starts after its end,
+   in which case not even an empty needle can be found in it. */
+static bool
+_clamp_slice(Py_ssize_t* start, Py_ssize_t* end, Py_ssize_t length)
+{
+    if (*end > length)
+        *end = length;
+    else if (*end < 0 && (*end += length) < 0)
+        *end = 0;
+    if (*start < 0 && (*start += length) < 0)
+        *start = 0;
+    return *start <= *end;
+}
+
+/* Get a `memoryview` over a slice of the cursor buffer without copy */
+static PyObject*
+cursor_getview(cursor* self, Py_ssize_t start, Py_ssize_t length)
+{
+    PyObject* view;
+
+    assert(start >= 0 && length >= 0);
+    assert(start <= self->buffer.len - length);
+
+    self->view_start = start;
+    self->view_length = length;
+    view = PyMemoryView_FromObject((PyObject*) self);
+    self->view_start = 0;
+    self->view_length = -1;
+
+    return view;
+}
+
+/* Get the length of the next line of at most `size` bytes, including the
+   line separator if it was found */
+static inline Py_ssize_t
+cursor_line_length(cursor* self, Py_ssize_t size, char line_sep)
+{
+    char* start = &((char*) self->buffer.buf)[self->offset];
+    char* end   = (char*) memchr(start, line_sep, size);
+    return (end == NULL) ? size : end - start + 1;
+}
+
+/* Split `length` bytes at `start` into a list or tuple of fields */
+static PyObject*
+cursor_split_fields(cursor* self, Py_ssize_t start, Py_ssize_t length, char sep, Py_ssize_t maxsplit, bool copy, bool tuple)
+{
+    Py_ssize_t  i;
+    Py_ssize_t  nfields = 1;
+    PyObject*   field;
+    PyObject*   fields;
+    char*       end;
+    char*       data    = &((char*) self->buffer.buf)[start];
+    char*       p       = data;
+    char*       stop    = data + length;
+
+    /* count the fields first so that the container is allocated once */
+    while ((maxsplit < 0 || nfields <= maxsplit) && (p = memchr(p, sep, stop - p)) != NULL) {
+        nfields++;
+        p++;
+    }
+
+    fields = tuple ? PyTuple_New(nfields) : PyList_New(nfields);
+    if (fields == NULL)
+        return NULL;
+
+    for (i = 0, p = data; i < nfields; i++) {
+        end = (i == nfields - 1) ? stop : memchr(p, sep, stop - p);
+        assert(end != NULL);
+        if (copy)
+            field = PyBytes_FromStringAndSize(p, end - p);
+        else
+            field = cursor_getview(self, p - (char*) self->buffer.buf, end - p);
+        if (field == NULL) {
+            Py_DECREF(fields);
+            return NULL;
+        }
+        if (tuple)
+            PyTuple_SET_ITEM(fields, i, field);
+        else
+            PyList_SET_ITEM(fields, i, field);
+        p = end + 1;
+    }
+
+    return fields;
+}
+
+// --------------------------------------------------------------------------
+
+static bool
+_convert_iter(PyObject* obj, PyObject** it)
+{
+    PyObject* tmp = PyObject_GetIter(obj);
+    if (tmp == NULL)
+        return false;
+
+    *it = tmp;
+    return true;
+}
+
+static bool
+_convert_optional_size(PyObject* obj, Py_ssize_t* s)
+{
+    if (obj == Py_None)
+        return true;
+
+    PyObject* n = PyNumber_Index(obj);
+    if (n == NULL)
+        return false;
+
+    Py_ssize_t tmp = PyLong_AsSsize_t(n);
+    Py_DECREF(n);
+
+    if (PyErr_Occurred())
+        return false;
+
+    *s = tmp;
+    return true;
+}
+
+/* Extract an optional positional size argument without going through the
+   keyword argument parser, which dominates the cost of small reads done
+   by consumers such as the C unpickler. Returns false if the arguments
+   need to be parsed the slow way. */
+static inline bool
+_fast_optional_size(PyObject* args, PyObject* kwargs, Py_ssize_t* size)
+{
+    PyObject* arg;
+
+    if (kwargs != NULL)
+        return false;
+
+    switch (PyTuple_GET_SIZE(args)) {
+        case 0:
+            return true;
+        case 1:
+            arg = PyTuple_GET_ITEM(args, 0);
+            if (!PyLong_CheckExact(arg))
+                return false;
+            *size = PyLong_AsSsize_t(arg);
+            return (*size != -1) || !PyErr_Occurred();
+        default:
+            return false;
+    }
+}
+
+// --------------------------------------------------------------------------
+
+static bool
+_convert_byteorder(PyObject* obj, bool* swap)
+{
+    bool        little;
+    const char* order = PyUnicode_AsUTF8(obj);
+
+    if (order == NULL)
+        return false;
+
+    if (strcmp(order, "<") == 0 || strcmp(order, "little") == 0)
+        little = true;
+    else if (strcmp(order, ">") == 0 || strcmp(order, "!") == 0 || strcmp(order, "big") == 0)
+        little = false;
+    else if (strcmp(order, "=") == 0 || strcmp(order, "@") == 0 || strcmp(order, "native") == 0)
+        little = PY_LITTLE_ENDIAN;
+    else {
+        PyErr_Format(PyExc_ValueError, "invalid byte order: %R", obj);
+        return false;
+    }
+
+    *swap = (little != PY_LITTLE_ENDIAN);
+    return true;
+}
+
+/* Reverse the byte order of `nitems` items of `itemsize` bytes in place.
+   The fixed-size loops are written so that compilers recognize them as
+   byte swaps and vectorize them. */
+static void
+_byteswap(unsigned char* data, Py_ssize_t nitems, Py_ssize_t itemsize)
+{
+    Py_ssize_t    i;
+    Py_ssize_t    j;
+    uint16_t      x16;
+    uint32_t      x32;
+    uint64_t      x64;
+    unsigned char tmp;
+
+    switch (itemsize) {
+        case 1:
+            break;
+        case 2:
+            for (i = 0; i < nitems; i++) {
+                memcpy(&x16, &data[2*i], 2);
+                x16 = (uint16_t) ((x16 >> 8) | (x16 << 8));
+                memcpy(&data[2*i], &x16, 2);
+            }
+            break;
+        case 4:
+            for (i = 0; i < nitems; i++) {
+                memcpy(&x32, &data[4*i], 4);
+                x32 = ((x32 & 0x000000FFU) << 24) | ((x32 & 0x0000FF00U) << 8)
+                    | ((x32 & 0x00FF0000U) >> 8)  | ((x32 & 0xFF000000U) >> 24);
+                memcpy(&data[4*i], &x32, 4);
+            }
+            break;
+        case 8:
+            for (i = 0; i < nitems; i++) {
+                memcpy(&x64, &data[8*i], 8);
+                x64 = ((x64 & 0x00000000000000FFULL) << 56) | ((x64 & 0x000000000000FF00ULL) << 40)
+                    | ((x64 & 0x0000000000FF0000ULL) << 24) | ((x64 & 0x00000000FF000000ULL) << 8)
+                    | ((x64 & 0x000000FF00000000ULL) >> 8)  | ((x64 & 0x0000FF0000000000ULL) >> 24)
+                    | ((x64 & 0x00FF000000000000ULL) >> 40) | ((x64 & 0xFF00000000000000ULL) >> 56);
+                memcpy(&data[8*i], &x64, 8);
+            }
+            break;
+        default:
+            for (i = 0; i < nitems; i++) {
+                for (j = 0; j < itemsize / 2; j++) {
+                    tmp = data[i*itemsize + j];
+                    data[i*itemsize + j] = data[i*itemsize + itemsize - 1 - j];
+                    data[i*itemsize + itemsize - 1 - j] = tmp;
+                }
+            }
+    }
+}
+
+// --------------------------------------------------------------------------
+
+static const char b64_encode_table[64] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Maps base64 characters to their 6-bit value, or 0xFF for invalid characters */
+static const unsigned char b64_decode_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+/* Maps hexadecimal digits to their 4-bit value, or 0xFF for invalid digits */
+static const unsigned char hex_decode_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+/* Get the number of bytes encoded by a base64 string, or -1 if invalid */
+static Py_ssize_t
+_b64_decoded_length(const unsigned char* src, Py_ssize_t len)
+{
+    if (len % 4 != 0)
+        return -1;
+    if (len == 0)
+        return 0;
+    if (src[len - 1] != '=')
+        return len / 4 * 3;
+    if (src[len - 2] != '=')
+        return len / 4 * 3 - 1;
+    return len / 4 * 3 - 2;
+}
+
+/* Decode a padded base64 string of `len` characters into `dst` */
+static bool
+_b64_decode(unsigned char* dst, const unsigned char* src, Py_ssize_t len)
+{
+    Py_ssize_t    i;
+    unsigned char a, b, c, d;
+    unsigned char err = 0;
+    Py_ssize_t    body = (len > 0 && src[len - 1] == '=') ? len - 4 : len;
+
+    assert(len % 4 == 0);
+
+    /* decode the full quads, only checking for errors once at the end */
+    for (i = 0; i < body; i += 4) {
+        a = b64_decode_table[src[i]];
+        b = b64_decode_table[src[i+1]];
+        c = b64_decode_table[src[i+2]];
+        d = b64_decode_table[src[i+3]];
+        err |= a | b | c | d;
+        dst[0] = (unsigned char) ((a << 2) | (b >> 4));
+        dst[1] = (unsigned char) ((b << 4) | (c >> 2));
+        dst[2] = (unsigned char) ((c << 6) | d);
+        dst += 3;
+    }
+
+    /* decode the last quad containing padding, if any */
+    if (body < len) {
+        a = b64_decode_table[src[body]];
+        b = b64_decode_table[src[body+1]];
+        err |= a | b;
+        dst[0] = (unsigned char) ((a << 2) | (b >> 4));
+        if (src[body+2] != '=') {
+            c = b64_decode_table[src[body+2]];
+            err |= c;
+            dst[1] = (unsigned char) ((b << 4) | (c >> 2));
+        }
+    }
+
+    return (err & 0xC0) == 0;
+}
+
+/* Encode `len` bytes from `src` into a padded base64 string in `dst` */
+static void
+_b64_encode(unsigned char* dst, const unsigned char* src, Py_ssize_t len)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i + 3 <= len; i += 3) {
+        dst[0] = b64_encode_table[src[i] >> 2];
+        dst[1] = b64_encode_table[((src[i] & 0x03) << 4) | (src[i+1] >> 4)];
+        dst[2] = b64_encode_table[((src[i+1] & 0x0F) << 2) | (src[i+2] >> 6)];
+        dst[3] = b64_encode_table[src[i+2] & 0x3F];
+        dst += 4;
+    }
+
+    if (len - i == 1) {
+        dst[0] = b64_encode_table[src[i] >> 2];
+        dst[1] = b64_encode_table[(src[i] & 0x03) << 4];
+        dst[2] = '=';
+        dst[3] = '=';
+    } else if (len - i == 2) {
+        dst[0] = b64_encode_table[src[i] >> 2];
+        dst[1] = b64_encode_table[((src[i] & 0x03) << 4) | (src[i+1] >> 4)];
+        dst[2] = b64_encode_table[(src[i+1] & 0x0F) << 2];
+        dst[3] = '=';
+    }
+}
+
+/* Decode `len` hexadecimal digits from `src` into `dst` */
+static bool
+_hex_decode(unsigned char* dst, const unsigned char* src, Py_ssize_t len)
+{
+    Py_ssize_t    i;
+    unsigned char hi, lo;
+    unsigned char err = 0;
+
+    assert(len % 2 == 0);
+
+    for (i = 0; i < len; i += 2) {
+        hi = hex_decode_table[src[i]];
+        lo = hex_decode_table[src[i+1]];
+        err |= hi | lo;
+        *dst++ = (unsigned char) ((hi << 4) | lo);
+    }
+
+    return (err & 0xF0) == 0;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_allocate___doc__,
+  "allocate(cls, size, alignment=4096, hugepages=False)\n"
+  "--\n"
+  "\n"
+  "Create a cursor over a new zeroed buffer with the given alignment.\n"
+  "\n"
+  "The buffer is owned by the cursor, and freed when the cursor is\n"
+  "closed or deallocated. It is writable, and can be passed to any\n"
+  "function accepting a buffer, such as `os.preadv`, so that aligned\n"
+  "reads from files opened with ``O_DIRECT`` are done in place.\n"
+  "\n"
+  "Arguments:\n"
+  "    size (int): The size of the buffer, in bytes.\n"
+  "    alignment (int): The alignment of the buffer address, which must\n"
+  "        be a power of two.\n"
+  "    hugepages (bool): Pass `True` to back the buffer with huge pages\n"
+  "        where supported, in which case the buffer is aligned on at\n"
+  "        least 2 MiB. Explicit huge pages are used if the system has\n"
+  "        some reserved, otherwise transparent huge pages are advised.\n"
+  "\n"
+  "Raises:\n"
+  "    ValueError: When ``size`` is negative, or ``alignment`` is not a\n"
+  "        power of two.\n"
+  "    MemoryError: When the buffer could not be allocated.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor.allocate(8192)\n"
+  "    >>> len(cursor.getbuffer())\n"
+  "    8192\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_allocate_impl(PyTypeObject* type, PyObject* args, Py_ssize_t size, Py_ssize_t alignment, bool hugepages)
+{
+    cursor* self;
+    void*   memory;
+    size_t  mapped;
+
+    if (size < 0) {
+        PyErr_Format(PyExc_ValueError, "negative size value %zd", size);
+        return NULL;
+    }
+    if (alignment <= 0 || (alignment & (alignment - 1)) != 0) {
+        PyErr_Format(PyExc_ValueError, "alignment must be a power of two, not %zd", alignment);
+        return NULL;
+    }
+    if ((size_t) alignment < sizeof(void*))
+        alignment = sizeof(void*);
+
+    if ((self = (cursor*) type->tp_new(type, args, NULL)) == NULL)
+        return NULL;
+
+    Py_BEGIN_ALLOW_THREADS
+    memory = _aligned_memory_alloc((size_t) size, (size_t) alignment, hugepages, &mapped);
+    Py_END_ALLOW_THREADS
+    if (memory == NULL) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+
+    self->memory = memory;
+    self->memory_size = mapped;
+    self->source = Py_None;
+    Py_INCREF(Py_None);
+    PyBuffer_FillInfo(&self->buffer, NULL, memory, size, 0, PyBUF_WRITABLE);
+
+    return (PyObject*) self;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_allocate(PyObject *type, PyObject *args, PyObject *kwargs)
+{
+    PyObject*  return_value = NULL;
+    Py_ssize_t size;
+    Py_ssize_t alignment    = 4096;
+    int        hugepages    = false;
+
+    static char* keywords[] = {"size", "alignment", "hugepages", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "n|np", keywords, &size, &alignment, &hugepages)) {
+        return_value = iocursor_cursor_Cursor_allocate_impl((PyTypeObject*) type, args, size, alignment, (bool) hugepages);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+/* Load the key of a record as an unsigned integer with the same order
+   as the key itself: signed keys have their sign bit flipped */
+static inline uint64_t
+_record_load_key(const record_layout* layout, const unsigned char* record)
+{
+    const unsigned char* p = &record[layout->key_offset];
+    uint64_t             x = 0;
+    Py_ssize_t           i;
+
+    if (layout->big_endian) {
+        for (i = 0; i < layout->key_size; i++)
+            x = (x << 8) | p[i];
+    } else {
+        for (i = layout->key_size - 1; i >= 0; i--)
+            x = (x << 8) | p[i];
+    }
+    if (layout->is_signed)
+        x ^= (uint64_t) 1 << (8 * layout->key_size - 1);
+    return x;
+}
+
+/* Convert an integer to search into the representation of the keys */
+static int
+_record_convert_key(const record_layout* layout, PyObject* key, uint64_t* value)
+{
+    int      bits = 8 * (int) layout->key_size;
+    uint64_t mask = bits == 64 ? UINT64_MAX : ((uint64_t) 1 << bits) - 1;
+
+    if (layout->is_signed) {
+        long long x = PyLong_AsLongLong(key);
+        if (x == -1 && PyErr_Occurred())
+            return -1;
+        if (bits < 64 && (x < -((long long) 1 << (bits - 1)) || x >= ((long long) 1 << (bits - 1))))
+            goto overflow;
+        *value = ((uint64_t) x & mask) ^ ((uint64_t) 1 << (bits - 1));
+    } else {
+        unsigned long long x = PyLong_AsUnsignedLongLong(key);
+        if (x == (unsigned long long) -1 && PyErr_Occurred())
+            return -1;
+        if (x > mask)
+            goto overflow;
+        *value = (uint64_t) x;
+    }
+    return 0;
+
+overflow:
+    PyErr_Format(PyExc_OverflowError, "key %R does not fit in %i bits", key, bits);
+    return -1;
+}
+
+/* Check whether the key of a record is lower than the searched key */
+static inline bool
+_record_less(const record_layout* layout, const unsigned char* record, uint64_t ikey, const char* bkey, Py_ssize_t blen)
+{
+    int cmp;
+
+    if (layout->integer)
+        return _record_load_key(layout, record) < ikey;
+    cmp = memcmp(&record[layout->key_offset], bkey, Py_MIN(layout->key_size, blen));
+    return cmp < 0 || (cmp == 0 && layout->key_size < blen);
+}
+
+/* Get the index of the first record in `[lo, hi)` whose key is not lower
+   than the searched key, or `hi` if there is none */
+static Py_ssize_t
+cursor_lower_bound(cursor* self, const record_layout* layout, uint64_t ikey, const char* bkey, Py_ssize_t blen, Py_ssize_t lo, Py_ssize_t hi)
+{
+    const unsigned char* data = (const unsigned char*) self->buffer.buf;
+    Py_ssize_t           mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (_record_less(layout, &data[mid * layout->record_size], ikey, bkey, blen))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Check the record layout against the buffer, and resolve the key size */
+static int
+cursor_check_layout(cursor* self, record_layout* layout)
+{
+    if (layout->record_size <= 0) {
+        PyErr_Format(PyExc_ValueError, "record_size must be positive, not %zd", layout->record_size);
+        return -1;
+    }
+    if (layout->key_offset < 0) {
+        PyErr_Format(PyExc_ValueError, "negative key_offset value %zd", layout->key_offset);
+        return -1;
+    }
+    if (layout->key_size < 0)
+        layout->key_size = layout->record_size - layout->key_offset;
+    if (layout->key_offset >= layout->record_size || layout->key_size > layout->record_size - layout->key_offset) {
+        PyErr_Format(
+            PyExc_ValueError,
+            "key of %zd bytes at offset %zd does not fit in records of %zd bytes",
+            layout->key_size,
+            layout->key_offset,
+            layout->record_size
+        );
+        return -1;
+    }
+    return 0;
+}
+
+static bool
+_convert_key_type(PyObject* obj, record_layout* layout)
+{
+    const char* name = PyUnicode_AsUTF8(obj);
+    char*       end;
+    long        bits;
+
+    if (name == NULL)
+        return false;
+
+    if (strcmp(name, "bytes") == 0) {
+        layout->integer = false;
+        return true;
+    }
+
+    /* Integer types are named like `u8`, `i16le` or `u64be` */
+    if (name[0] != 'u' && name[0] != 'i')
+        goto invalid;
+    bits = strtol(&name[1], &end, 10);
+    if (bits != 8 && bits != 16 && bits != 32 && bits != 64)
+        goto invalid;
+    if (strcmp(end, "be") == 0)
+        layout->big_endian = true;
+    else if (strcmp(end, "le") == 0 || (bits == 8 && *end == '\0'))
+        layout->big_endian = false;
+    else
+        goto invalid;
+
+    layout->integer = true;
+    layout->is_signed = name[0] == 'i';
+    layout->key_size = bits / 8;
+    return true;
+
+invalid:
+    PyErr_Format(PyExc_ValueError, "invalid key type: %R", obj);
+    return false;
+}
+
+/* Parse the record layout arguments shared by `bisect` and `bisect_many` */
+static int
+_parse_record_layout(PyObject* key_type, Py_ssize_t key_size, record_layout* layout)
+{
+    layout->key_size = -1;
+    layout->integer = false;
+    layout->is_signed = false;
+    layout->big_endian = false;
+
+    if (key_type != NULL && !_convert_key_type(key_type, layout))
+        return -1;
+    if (key_size >= 0) {
+        if (layout->integer && key_size != layout->key_size) {
+            PyErr_Format(PyExc_ValueError, "key_size must be %zd for key type %R", layout->key_size, key_type);
+            return -1;
+        }
+        layout->key_size = key_size;
+    }
+    return 0;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_bisect___doc__,
+  "bisect(self, key, record_size, key_offset=0, key_size=None, key_type='bytes', seek=False)\n"
+  "--\n"
+  "\n"
+  "Find a key in a buffer of sorted fixed-size records.\n"
+  "\n"
+  "The binary search is done directly over the buffer, which is seen\n"
+  "as a sequence of ``record_size`` bytes records sorted by their key.\n"
+  "Trailing bytes not filling a whole record are ignored.\n"
+  "\n"
+  "Arguments:\n"
+  "    key (bytes or int): The key to search for.\n"
+  "    record_size (int): The size of each record, in bytes.\n"
+  "    key_offset (int): The offset of the key in each record.\n"
+  "    key_size (int, *optional*): The size of the key in each record.\n"
+  "        Defaults to the rest of the record for ``bytes`` keys, and to\n"
+  "        the size of the integer type otherwise.\n"
+  "    key_type (str): The type of the key, either ``bytes`` to compare\n"
+  "        keys lexicographically, or an integer type such as ``u8``,\n"
+  "        ``i16le``, ``u32be`` or ``u64le``.\n"
+  "    seek (bool): Pass `True` to move the cursor to the start of the\n"
+  "        record that was found.\n"
+  "\n"
+  "Returns:\n"
+  "    `int`: The index of the first record whose key is not lower than\n"
+  "    ``key``, as returned by `bisect.bisect_left`, which is the number\n"
+  "    of records if all keys are lower.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'\\x01a\\x03b\\x05c')\n"
+  "    >>> cursor.bisect(3, 2, key_type='u8')\n"
+  "    1\n"
+  "    >>> cursor.bisect(b'\\x04', 2, key_size=1, seek=True)\n"
+  "    2\n"
+  "    >>> cursor.read(2)\n"
+  "    b'\\x05c'\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_bisect_impl(cursor* self, PyObject* key, record_layout* layout, bool seek)
+{
+    Py_buffer  bkey  = {NULL};
+    uint64_t   ikey  = 0;
+    Py_ssize_t index;
+
+    if (check_closed(self))
+        return NULL;
+    if (cursor_check_layout(self, layout) < 0)
+        return NULL;
+
+    if (layout->integer) {
+        if (_record_convert_key(layout, key, &ikey) < 0)
+            return NULL;
+    } else if (PyObject_GetBuffer(key, &bkey, PyBUF_SIMPLE) < 0) {
+        return NULL;
+    }
+
+    index = cursor_lower_bound(self, layout, ikey, bkey.buf, bkey.len, 0, self->buffer.len / layout->record_size);
+    if (bkey.obj != NULL)
+        PyBuffer_Release(&bkey);
+
+    if (seek) {
+        cursor_record_seek(self, self->offset, index * layout->record_size);
+        self->offset = index * layout->record_size;
+    }
+    return PyLong_FromSsize_t(index);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_bisect(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*     return_value = NULL;
+    cursor*       crs          = (cursor*) self;
+    PyObject*     key;
+    PyObject*     key_type     = NULL;
+    record_layout layout;
+    Py_ssize_t    key_size     = -1;
+    int           seek         = false;
+
+    layout.key_offset = 0;
+
+    static char* keywords[] = {"key", "record_size", "key_offset", "key_size", "key_type", "seek", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "On|nO&Up", keywords, &key, &layout.record_size, &layout.key_offset, &_convert_optional_size, &key_size, &key_type, &seek)) {
+        if (_parse_record_layout(key_type, key_size, &layout) == 0)
+            return_value = iocursor_cursor_Cursor_bisect_impl(crs, key, &layout, (bool) seek);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_bisect_many___doc__,
+  "bisect_many(self, keys, record_size, key_offset=0, key_size=None, key_type='bytes')\n"
+  "--\n"
+  "\n"
+  "Find many keys in a buffer of sorted fixed-size records.\n"
+  "\n"
+  "This is equivalent to calling `Cursor.bisect` for each key, but the\n"
+  "keys are searched in sorted order, each search starting from the\n"
+  "result of the previous one with an exponential search. Close keys\n"
+  "then only touch a few records, which are likely already cached.\n"
+  "\n"
+  "Arguments:\n"
+  "    keys (iterable of bytes or int): The keys to search for.\n"
+  "    record_size (int): The size of each record, in bytes.\n"
+  "    key_offset (int): The offset of the key in each record.\n"
+  "    key_size (int, *optional*): The size of the key in each record.\n"
+  "    key_type (str): The type of the keys, as in `Cursor.bisect`.\n"
+  "\n"
+  "Returns:\n"
+  "    `list` of `int`: The index of the first record whose key is not\n"
+  "    lower than each key, in the order of ``keys``.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'\\x01\\x03\\x05\\x07')\n"
+  "    >>> cursor.bisect_many([7, 0, 4], 1, key_type='u8')\n"
+  "    [3, 0, 2]\n"
+  "\n"
+);
+
+typedef struct record_probe {
+    uint64_t    ikey;
+    const char* bkey;
+    Py_ssize_t  blen;
+    Py_ssize_t  index;
+    Py_ssize_t  result;
+} record_probe;
+
+static int
+_record_probe_compare(const void* a, const void* b)
+{
+    const record_probe* x = (const record_probe*) a;
+    const record_probe* y = (const record_probe*) b;
+    int                 cmp;
+
+    if (x->ikey != y->ikey)
+        return x->ikey < y->ikey ? -1 : 1;
+    cmp = memcmp(x->bkey, y->bkey, Py_MIN(x->blen, y->blen));
+    if (cmp != 0)
+        return cmp;
+    if (x->blen != y->blen)
+        return x->blen < y->blen ? -1 : 1;
+    return x->index < y->index ? -1 : (x->index > y->index);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_bisect_many_impl(cursor* self, PyObject* keys, record_layout* layout)
+{
+    PyObject*     seq     = NULL;
+    PyObject*     results = NULL;
+    PyObject*     index;
+    Py_buffer*    buffers = NULL;
+    record_probe* probes  = NULL;
+    Py_ssize_t    count;
+    Py_ssize_t    length;
+    Py_ssize_t    lo;
+    Py_ssize_t    hi;
+    Py_ssize_t    step;
+    Py_ssize_t    i;
+    Py_ssize_t    acquired = 0;
+
+    if (check_closed(self))
+        return NULL;
+    if (cursor_check_layout(self, layout) < 0)
+        return NULL;
+
+    if ((seq = PySequence_Fast(keys, "keys must be iterable")) == NULL)
+        return NULL;
+    length = PySequence_Fast_GET_SIZE(seq);
+    count = self->buffer.len / layout->record_size;
+
+    if ((probes = PyMem_New(record_probe, length)) == NULL) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    if (!layout->integer && (buffers = PyMem_New(Py_buffer, length)) == NULL) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+
+    /* Convert all the keys first */
+    for (i = 0; i < length; i++) {
+        PyObject* key = PySequence_Fast_GET_ITEM(seq, i);
+        probes[i].index = i;
+        probes[i].ikey = 0;
+        probes[i].bkey = NULL;
+        probes[i].blen = 0;
+        if (layout->integer) {
+            if (_record_convert_key(layout, key, &probes[i].ikey) < 0)
+                goto exit;
+        } else {
+            if (PyObject_GetBuffer(key, &buffers[i], PyBUF_SIMPLE) < 0)
+                goto exit;
+            acquired++;
+            probes[i].bkey = buffers[i].buf;
+            probes[i].blen = buffers[i].len;
+        }
+    }
+
+    /* Search the keys in sorted order, starting each search from the
+       previous result and doubling the range until it contains the key */
+    qsort(probes, length, sizeof(record_probe), _record_probe_compare);
+    for (i = 0, lo = 0; i < length; i++) {
+        const record_probe* probe = &probes[i];
+        const unsigned char* data = (const unsigned char*) self->buffer.buf;
+        hi = lo;
+        step = 1;
+        while (hi < count && _record_less(layout, &data[hi * layout->record_size], probe->ikey, probe->bkey, probe->blen)) {
+            lo = hi + 1;
+            hi = (step < count - lo) ? lo + step : count;
+            step <<= 1;
+        }
+        lo = cursor_lower_bound(self, layout, probe->ikey, probe->bkey, probe->blen, lo, hi);
+        probes[i].result = lo;
+    }
+
+    /* Return the results in the order of the keys */
+    if ((results = PyList_New(length)) == NULL)
+        goto exit;
+    for (i = 0; i < length; i++) {
+        if ((index = PyLong_FromSsize_t(probes[i].result)) == NULL) {
+            Py_CLEAR(results);
+            goto exit;
+        }
+        PyList_SET_ITEM(results, probes[i].index, index);
+    }
+
+exit:
+    for (i = 0; i < acquired; i++)
+        PyBuffer_Release(&buffers[i]);
+    PyMem_Free(buffers);
+    PyMem_Free(probes);
+    Py_DECREF(seq);
+    return results;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_bisect_many(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*     return_value = NULL;
+    cursor*       crs          = (cursor*) self;
+    PyObject*     keys;
+    PyObject*     key_type     = NULL;
+    record_layout layout;
+    Py_ssize_t    key_size     = -1;
+
+    layout.key_offset = 0;
+
+    static char* keywords[] = {"keys", "record_size", "key_offset", "key_size", "key_type", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "On|nO&U", keywords, &keys, &layout.record_size, &layout.key_offset, &_convert_optional_size, &key_size, &key_type)) {
+        if (_parse_record_layout(key_type, key_size, &layout) == 0)
+            return_value = iocursor_cursor_Cursor_bisect_many_impl(crs, keys, &layout);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_bits___doc__,
+  "bits(self, order='msb')\n"
+  "--\n"
+  "\n"
+  "Get a `BitCursor` reading or writing bits from this cursor.\n"
+  "\n"
+  "This is a shortcut for ``BitCursor(cursor, order)``: the bit cursor\n"
+  "starts at the current position of this cursor, and updates it when\n"
+  "flushed or aligned.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(bytearray(2))\n"
+  "    >>> with cursor.bits() as bits:\n"
+  "    ...     bits.write_bits(0b101, 3)\n"
+  "    >>> cursor.tell(), cursor.getvalue()\n"
+  "    (1, bytearray(b'\\xa0\\x00'))\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_bits_impl(cursor* self, PyObject* order)
+{
+    if (check_closed(self))
+        return NULL;
+    if (order == NULL)
+        return PyObject_CallFunctionObjArgs((PyObject*) &PyBitCursor_Type, (PyObject*) self, NULL);
+    return PyObject_CallFunctionObjArgs((PyObject*) &PyBitCursor_Type, (PyObject*) self, order, NULL);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_bits(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* return_value = NULL;
+    PyObject* order        = NULL;
+
+    static char* keywords[] = {"order", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|U", keywords, &order)) {
+        return_value = iocursor_cursor_Cursor_bits_impl((cursor*) self, order);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_checkpoint___doc__,
+  "checkpoint(self)\n"
+  "--\n"
+  "\n"
+  "Make a checkpoint to return to the current state of the cursor.\n"
+  "\n"
+  "Until the checkpoint is committed or rolled back, the bytes about\n"
+  "to be overwritten by each write are saved to an undo log, so that\n"
+  "the cost of a checkpoint only depends on the number of bytes\n"
+  "written, and not on the size of the buffer. Checkpoints can be\n"
+  "nested, in which case they must be released in reverse order.\n"
+  "Writes done through views of the buffer exported by the cursor\n"
+  "are not recorded.\n"
+  "\n"
+  "Returns:\n"
+  "    `Checkpoint`: A context manager that commits the checkpoint on\n"
+  "    exit, or rolls it back if an exception was raised.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(bytearray(b'abcdef'))\n"
+  "    >>> with cursor.checkpoint() as checkpoint:\n"
+  "    ...     cursor.write(b'xyz')\n"
+  "    ...     checkpoint.rollback()\n"
+  "    3\n"
+  "    >>> cursor.tell(), cursor.getvalue()\n"
+  "    (0, bytearray(b'abcdef'))\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_checkpoint_impl(cursor* self)
+{
+    checkpoint* ckpt;
+
+    if (check_closed(self))
+        return NULL;
+    if ((ckpt = PyObject_GC_New(checkpoint, &PyCheckpoint_Type)) == NULL)
+        return NULL;
+    if (cursor_mark(self, &ckpt->id) < 0) {
+        ckpt->cursor = NULL;
+        Py_DECREF(ckpt);
+        return NULL;
+    }
+    Py_INCREF(self);
+    ckpt->cursor = self;
+    PyObject_GC_Track(ckpt);
+
+    return (PyObject*) ckpt;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_close___doc__,
+  "close(self)\n"
+  "--\n"
+  "\n"
+  "Disable all I/O operations.\n"
+  "\n"
+  "This method will effectively release the view on the buffer memory\n"
+  "wrapped by the cursor.\n"
+  "\n"
+  "Raises:\n"
+  "    BufferError: When views of the buffer exported by the cursor,\n"
+  "        such as the ones returned by `Cursor.getbuffer`, are still\n"
+  "        alive, or when a reservation made with `Cursor.reserve` was\n"
+  "        not committed.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_close_impl(cursor* self)
+{
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "Existing exports of data: object cannot be closed");
+        return NULL;
+    }
+    if (self->reserved) {
+        PyErr_SetString(PyExc_BufferError, "Pending reservation: object cannot be closed");
+        return NULL;
+    }
+    if (!self->closed) {
+        registry_remove(self);
+        PyBuffer_Release(&self->buffer);
+        cursor_free_memory(self);
+        undo_clear(self->undo);
+        self->closed = true;
+    }
+    Py_RETURN_NONE;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_commit___doc__,
+  "commit(self)\n"
+  "--\n"
+  "\n"
+  "Release the innermost checkpoint, keeping the changes made since.\n"
+  "\n"
+  "The changes can still be rolled back by an enclosing checkpoint.\n"
+  "\n"
+  "Raises:\n"
+  "    ValueError: When no checkpoint is active.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_commit_impl(cursor* self)
+{
+    if (check_closed(self) || check_checkpoint(self, NULL))
+        return NULL;
+    cursor_commit(self);
+    Py_RETURN_NONE;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_commit_reserved___doc__,
+  "commit_reserved(self, n)\n"
+  "--\n"
+  "\n"
+  "Commit the first ``n`` bytes of the pending reservation.\n"
+  "\n"
+  "The cursor is moved ``n`` bytes past the start of the reservation\n"
+  "made with `Cursor.reserve`, which is then released. Pass 0 to give\n"
+  "up a reservation without writing anything.\n"
+  "\n"
+  "Raises:\n"
+  "    ValueError: When no reservation is pending, or when ``n`` is\n"
+  "        larger than the size of the reservation.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_commit_reserved_impl(cursor* self, Py_ssize_t n)
+{
+    if (check_closed(self))
+        return NULL;
+    if (!self->reserved) {
+        PyErr_SetString(PyExc_ValueError, "no pending reservation");
+        return NULL;
+    }
+    if (n < 0 || n > self->reserve_size) {
+        PyErr_Format(PyExc_ValueError, "cannot commit %zd bytes of a %zd bytes reservation", n, self->reserve_size);
+        return NULL;
+    }
+
+    self->reserved = false;
+    self->offset = self->reserve_offset + n;
+    cursor_record(self, CURSOR_OP_WRITE, self->reserve_offset, n);
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_commit_reserved(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t n;
+
+    static char* keywords[] = {"n", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "n", keywords, &n)) {
+        return_value = iocursor_cursor_Cursor_commit_reserved_impl(crs, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_copy_within___doc__,
+  "copy_within(self, src, dst, n)\n"
+  "--\n"
+  "\n"
+  "Copy ``n`` bytes from position ``src`` to position ``dst``.\n"
+  "\n"
+  "The copy is done directly inside the buffer, and the source and\n"
+  "destination ranges may overlap. The cursor position is unchanged.\n"
+  "\n"
+  "Arguments:\n"
+  "    src (int): The position of the bytes to copy.\n"
+  "    dst (int): The position to copy the bytes to.\n"
+  "    n (int): The number of bytes to copy.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of bytes copied.\n"
+  "\n"
+  "Raises:\n"
+  "    BufferError: When either range exceeds the buffer size.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(bytearray(b'abc...'))\n"
+  "    >>> cursor.copy_within(0, 3, 3)\n"
+  "    3\n"
+  "    >>> cursor.getvalue()\n"
+  "    bytearray(b'abcabc')\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_copy_within_impl(cursor* self, Py_ssize_t src, Py_ssize_t dst, Py_ssize_t n)
+{
+    char* data;
+
+    if (check_closed(self))
+        return NULL;
+    if (check_writable(self))
+        return NULL;
+    if (check_position(src, "src") || check_position(dst, "dst") || check_position(n, "size"))
+        return NULL;
+
+    if (n > 0) {
+        if ((src >= self->buffer.len) || (n > self->buffer.len - src)) {
+            PyErr_Format(
+                PyExc_BufferError,
+                "cannot read %zd bytes from buffer of size %zd at position %zd",
+                n,
+                self->buffer.len,
+                src
+            );
+            return NULL;
+        }
+        if (check_space_at(self, dst, n))
+            return NULL;
+        if (cursor_save(self, dst, n) < 0)
+            return NULL;
+        data = (char*) self->buffer.buf;
+        if (n >= CURSOR_NOGIL_SIZE) {
+            /* Prevent the buffer from being released while the GIL is released */
+            self->exports++;
+            Py_BEGIN_ALLOW_THREADS
+            memmove(&data[dst], &data[src], n);
+            Py_END_ALLOW_THREADS
+            self->exports--;
+        } else {
+            memmove(&data[dst], &data[src], n);
+        }
+    }
+
+    cursor_record(self, CURSOR_OP_WRITE, dst, n);
+
+    return PyLong_FromSsize_t(n);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_copy_within(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t src;
+    Py_ssize_t dst;
+    Py_ssize_t n;
+
+    static char* keywords[] = {"src", "dst", "n", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "nnn", keywords, &src, &dst, &n)) {
+        return_value = iocursor_cursor_Cursor_copy_within_impl(crs, src, dst, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_count___doc__,
+  "count(self, sub, start=None, end=None)\n"
+  "--\n"
+  "\n"
+  "Count the non-overlapping occurrences of ``sub`` in the buffer.\n"
+  "\n"
+  "The search is done in ``buffer[start:end]``, without moving the\n"
+  "cursor. As with `Cursor.find`, it starts at the cursor position by\n"
+  "default.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'a\\r\\nb\\r\\nc')\n"
+  "    >>> cursor.count(b'\\r\\n')\n"
+  "    2\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_count_impl(cursor* self, Py_buffer* sub, Py_ssize_t start, Py_ssize_t end)
+{
+    const char* data = (const char*) self->buffer.buf;
+    const char* found;
+    Py_ssize_t  count = 0;
+
+    if (check_closed(self))
+        return NULL;
+
+    if (!_clamp_slice(&start, &end, self->buffer.len))
+        return PyLong_FromLong(0);
+    if (sub->len == 0)
+        return PyLong_FromSsize_t(end - start + 1);
+
+    while ((found = _search_forward(&data[start], end - start, (const char*) sub->buf, sub->len)) != NULL) {
+        start = found - data + sub->len;
+        count++;
+    }
+
+    return PyLong_FromSsize_t(count);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_count(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    Py_buffer  sub;
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t start        = crs->offset;
+    Py_ssize_t end          = crs->buffer.len;
+
+    static char* keywords[] = {"sub", "start", "end", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "y*|O&O&", keywords, &sub, _convert_optional_size, &start, _convert_optional_size, &end)) {
+        return_value = iocursor_cursor_Cursor_count_impl(crs, &sub, start, end);
+        PyBuffer_Release(&sub);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_detach___doc__,
+  "detach(self)\n"
+  "--\n"
+  "\n"
+  "Disconnect the wrapper from its underlying raw stream.\n"
+  "\n"
+  "This is not supported by `Cursor` instances, since they do not wrap\n"
+  "a raw stream, and calling this method will effectively raise the\n"
+  "`io.UnsupportedOperation` exception.\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_detach_impl(cursor* self)
+{
+    PyObject* err = PyCursor_getunsupportedoperation();
+    if (err != NULL)
+        PyErr_SetString(err, "detach");
+    return NULL;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_expect___doc__,
+  "expect(self, prefix, /)\n"
+  "--\n"
+  "\n"
+  "Check the buffer contains ``prefix`` at the current position.\n"
+  "\n"
+  "The comparison is done in place, without reading the data into a\n"
+  "new `bytes` object, and the cursor is advanced past ``prefix`` if\n"
+  "it matched. Otherwise the cursor is left unchanged.\n"
+  "\n"
+  "Arguments:\n"
+  "    prefix (bytes-like object): The bytes expected in the buffer,\n"
+  "        such as the magic number of a file format.\n"
+  "\n"
+  "Raises:\n"
+  "    ValueError: When the buffer does not contain ``prefix``.\n"
+  "    EOFError: When the buffer is too short to contain ``prefix``.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'\\x89PNG\\r\\n\\x1a\\n...')\n"
+  "    >>> cursor.expect(b'\\x89PNG\\r\\n\\x1a\\n')\n"
+  "    >>> cursor.tell()\n"
+  "    8\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_expect_impl(cursor* self, Py_buffer* prefix)
+{
+    const char* data;
+    PyObject*   found;
+
+    if (check_closed(self))
+        return NULL;
+    if (check_available(self, prefix->len))
+        return NULL;
+
+    data = &((const char*) self->buffer.buf)[self->offset];
+    if (memcmp(data, prefix->buf, prefix->len) != 0) {
+        if ((found = PyBytes_FromStringAndSize(data, prefix->len)) != NULL) {
+            PyErr_Format(PyExc_ValueError, "expected %R at position %zd, found %R", prefix->obj, self->offset, found);
+            Py_DECREF(found);
+        }
+        return NULL;
+    }
+
+    cursor_record(self, CURSOR_OP_READ, self->offset, prefix->len);
+    self->offset += prefix->len;
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_expect(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    Py_buffer prefix;
+    PyObject* return_value = NULL;
+    cursor*   crs          = (cursor*) self;
+
+    static char* keywords[] = {"prefix", NULL};
+    if (kwargs == NULL && PyTuple_GET_SIZE(args) == 1) {
+        if (PyObject_GetBuffer(PyTuple_GET_ITEM(args, 0), &prefix, PyBUF_SIMPLE) == 0) {
+            return_value = iocursor_cursor_Cursor_expect_impl(crs, &prefix);
+            PyBuffer_Release(&prefix);
+        }
+    } else if (PyArg_ParseTupleAndKeywords(args, kwargs, "y*", keywords, &prefix)) {
+        return_value = iocursor_cursor_Cursor_expect_impl(crs, &prefix);
+        PyBuffer_Release(&prefix);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_fileno___doc__,
+  "fileno(self)\n"
+  "--\n"
+  "\n"
+  "Return the underlying file descriptor if one exists.\n"
+  "\n"
+  "This is not supported by `Cursor` instances, since they do not wrap\n"
+  "a file descriptor, and calling this method will effectively raise\n"
+  "the `io.UnsupportedOperation` exception.\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_fileno_impl(cursor* self)
+{
+    PyObject* err = PyCursor_getunsupportedoperation();
+    if (err != NULL)
+        PyErr_SetString(err, "fileno");
+    return NULL;
+}
+
+// --------------------------------------------------------------------------
+
+/* Fill `n` bytes of the buffer at the current position with `byte`, and
+   advance the cursor. Large fills are done with the GIL released. */
+static PyObject*
+cursor_fill(cursor* self, int byte, Py_ssize_t n)
+{
+    char* data;
+
+    if (check_closed(self))
+        return NULL;
+    if (check_writable(self))
+        return NULL;
+    if (check_position(n, "size"))
+        return NULL;
+
+    if (n > 0) {
+        if (check_space(self, n))
+            return NULL;
+        if (cursor_save(self, self->offset, n) < 0)
+            return NULL;
+        data = (char*) self->buffer.buf;
+        if (n >= CURSOR_NOGIL_SIZE) {
+            char* start = &data[self->offset];
+            /* Prevent the buffer from being released while the GIL is released */
+            self->exports++;
+            Py_BEGIN_ALLOW_THREADS
+            memset(start, byte, n);
+            Py_END_ALLOW_THREADS
+            self->exports--;
+        } else {
+            memset(&data[self->offset], byte, n);
+        }
+        self->offset += n;
+    }
+
+    cursor_record(self, CURSOR_OP_WRITE, self->offset - n, n);
+
+    return PyLong_FromSsize_t(n);
+}
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_fill___doc__,
+  "fill(self, byte, n)\n"
+  "--\n"
+  "\n"
+  "Write ``n`` copies of the given byte to the buffer.\n"
+  "\n"
+  "Arguments:\n"
+  "    byte (int): The value of the byte to write, in ``range(256)``.\n"
+  "    n (int): The number of bytes to write.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of bytes written.\n"
+  "\n"
+  "Raises:\n"
+  "    BufferError: When the buffer is too small to fit ``n`` bytes\n"
+  "        at the current position.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(bytearray(4))\n"
+  "    >>> cursor.fill(0xFF, 3)\n"
+  "    3\n"
+  "    >>> cursor.getvalue()\n"
+  "    bytearray(b'\\xff\\xff\\xff\\x00')\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_fill(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    int        byte;
+    Py_ssize_t n;
+
+    static char* keywords[] = {"byte", "n", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "in", keywords, &byte, &n)) {
+        if (byte < 0 || byte > 255)
+            PyErr_SetString(PyExc_ValueError, "byte must be in range(0, 256)");
+        else
+            return_value = cursor_fill(crs, byte, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_find___doc__,
+  "find(self, sub, start=None, end=None)\n"
+  "--\n"
+  "\n"
+  "Return the lowest position in the buffer where ``sub`` is found.\n"
+  "\n"
+  "The search is done in ``buffer[start:end]``, without moving the\n"
+  "cursor, and ``-1`` is returned if ``sub`` is not found. Unlike\n"
+  "`bytes.find`, the search starts at the cursor position by default.\n"
+  "\n"
+  "Arguments:\n"
+  "    sub (bytes-like object): The bytes to search for.\n"
+  "    start (int, *optional*): The position to start searching from,\n"
+  "        interpreted as in slice notation. If `None`, use the\n"
+  "        current position.\n"
+  "    end (int, *optional*): The position to stop searching at,\n"
+  "        interpreted as in slice notation. If `None`, search until\n"
+  "        the end of the buffer.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'key: value\\r\\n')\n"
+  "    >>> cursor.find(b'\\r\\n')\n"
+  "    10\n"
+  "\n"
+);
+
+/* Get the position of the first occurrence of `sub` in the buffer
+   between `start` and `end`, given as in slice notation, or -1 */
+static Py_ssize_t
+cursor_find(cursor* self, const Py_buffer* sub, Py_ssize_t start, Py_ssize_t end)
+{
+    const char* data = (const char*) self->buffer.buf;
+    const char* found;
+
+    if (!_clamp_slice(&start, &end, self->buffer.len))
+        return -1;
+
+    found = _search_forward(&data[start], end - start, (const char*) sub->buf, sub->len);
+    return found == NULL ? -1 : found - data;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_find_impl(cursor* self, Py_buffer* sub, Py_ssize_t start, Py_ssize_t end)
+{
+    if (check_closed(self))
+        return NULL;
+    return PyLong_FromSsize_t(cursor_find(self, sub, start, end));
+}
+
+static PyObject*
+iocursor_cursor_Cursor_find(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    Py_buffer  sub;
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t start        = crs->offset;
+    Py_ssize_t end          = crs->buffer.len;
+
+    static char* keywords[] = {"sub", "start", "end", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "y*|O&O&", keywords, &sub, _convert_optional_size, &start, _convert_optional_size, &end)) {
+        return_value = iocursor_cursor_Cursor_find_impl(crs, &sub, start, end);
+        PyBuffer_Release(&sub);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_find_any___doc__,
+  "find_any(self, subs, start=None, end=None)\n"
+  "--\n"
+  "\n"
+  "Find the first occurrence of any of several byte strings.\n"
+  "\n"
+  "This is useful to scan for one of several markers at once, such as\n"
+  "the delimiter and the closing delimiter of a MIME multipart body.\n"
+  "Each needle is searched in turn, only up to the best match found\n"
+  "so far, so later needles are usually only searched in a small part\n"
+  "of the buffer.\n"
+  "\n"
+  "Arguments:\n"
+  "    subs (iterable of bytes-like objects): The bytes to search for.\n"
+  "        When several of them are found at the same position, the\n"
+  "        first one in ``subs`` is reported.\n"
+  "    start (int, *optional*): The position to start searching from,\n"
+  "        interpreted as in slice notation. If `None`, use the\n"
+  "        current position.\n"
+  "    end (int, *optional*): The position to stop searching at,\n"
+  "        interpreted as in slice notation. If `None`, search until\n"
+  "        the end of the buffer.\n"
+  "\n"
+  "Returns:\n"
+  "    `tuple` of `int`: The position of the match and the index of the\n"
+  "    matching byte string in ``subs``, or ``(-1, -1)`` if none of them\n"
+  "    was found.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'data\\r\\n--sep--\\r\\n')\n"
+  "    >>> cursor.find_any([b'\\r\\n--sep--', b'\\r\\n--sep'])\n"
+  "    (4, 0)\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_find_any_impl(cursor* self, PyObject* subs, Py_ssize_t start, Py_ssize_t end)
+{
+    PyObject*   seq;
+    Py_buffer   sub;
+    const char* data = (const char*) self->buffer.buf;
+    const char* found;
+    Py_ssize_t  best  = -1;
+    Py_ssize_t  index = -1;
+    Py_ssize_t  limit;
+    Py_ssize_t  i;
+
+    if (check_closed(self))
+        return NULL;
+    if (!_clamp_slice(&start, &end, self->buffer.len))
+        return Py_BuildValue("(nn)", best, index);
+    if ((seq = PySequence_Fast(subs, "subs must be iterable")) == NULL)
+        return NULL;
+
+    for (i = 0; i < PySequence_Fast_GET_SIZE(seq); i++) {
+        if (PyObject_GetBuffer(PySequence_Fast_GET_ITEM(seq, i), &sub, PyBUF_SIMPLE) < 0) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+        /* Only look for matches starting before the best one so far */
+        limit = (best < 0) ? end : Py_MIN(end, best + sub.len - 1);
+        if (limit >= start) {
+            found = _search_forward(&data[start], limit - start, (const char*) sub.buf, sub.len);
+            if (found != NULL) {
+                best = found - data;
+                index = i;
+            }
+        }
+        PyBuffer_Release(&sub);
+    }
+
+    Py_DECREF(seq);
+    return Py_BuildValue("(nn)", best, index);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_find_any(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  subs;
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t start        = crs->offset;
+    Py_ssize_t end          = crs->buffer.len;
+
+    static char* keywords[] = {"subs", "start", "end", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "O|O&O&", keywords, &subs, _convert_optional_size, &start, _convert_optional_size, &end)) {
+        return_value = iocursor_cursor_Cursor_find_any_impl(crs, subs, start, end);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_flush___doc__,
+  "flush(self)\n"
+  "--\n"
+  "\n"
+  "Flush write buffers, if applicable.\n"
+  "\n"
+  "This is a no-op for `Cursor`, since they write directly to the\n"
+  "provided buffer.\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_flush_impl(cursor* self)
+{
+    if (check_closed(self))
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_getbuffer___doc__,
+  "getbuffer(self)\n"
+  "--\n"
+  "\n"
+  "Get a `memoryview` over the contents of the buffer, without copy.\n"
+  "\n"
+  "The view is writable unless the cursor is in read-only mode. As\n"
+  "long as the view exists, the cursor cannot be closed.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(bytearray(b'abc'))\n"
+  "    >>> view = cursor.getbuffer()\n"
+  "    >>> view[1] = ord('x')\n"
+  "    >>> view.release()\n"
+  "    >>> cursor.getvalue()\n"
+  "    bytearray(b'axc')\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_getbuffer_impl(cursor* self)
+{
+    if (check_closed(self))
+        return NULL;
+    return cursor_getview(self, 0, self->buffer.len);
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_getvalue___doc__,
+  "getvalue(self)\n"
+  "--\n"
+  "\n"
+  "Retrieve the backing memory buffer of the `Cursor` object.\n"
+  "\n"
+  "For cursors created with `Cursor.allocate`, this returns a\n"
+  "`memoryview` over the memory owned by the cursor.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(bytearray(4))\n"
+  "    >>> cursor.write(b'abc')\n"
+  "    3\n"
+  "    >>> cursor.getvalue()\n"
+  "    bytearray(b'abc\\x00')\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_getvalue_impl(cursor* self)
+{
+    if (check_closed(self))
+        return NULL;
+    if (self->memory != NULL)
+        return cursor_getview(self, 0, self->buffer.len);
+    Py_INCREF(self->source);
+    return self->source;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_isatty___doc__,
+  "isatty(self)\n"
+  "--\n"
+  "\n"
+  "Return whether the stream is attached to a TTY device.\n"
+  "\n"
+  "On `Cursor` instances, always return `False`.\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_isatty_impl(cursor* self)
+{
+    if (check_closed(self))
+        return NULL;
+    Py_RETURN_FALSE;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_iter_frames___doc__,
+  "iter_frames(self, prefix='u32le', max_size=None, copy=False, strict=True)\n"
+  "--\n"
+  "\n"
+  "Iterate over length-prefixed frames, starting at the current position.\n"
+  "\n"
+  "Each frame is yielded as a `memoryview` over the cursor buffer,\n"
+  "without copy, and the cursor position is advanced past the frame.\n"
+  "As long as such views exist, the cursor cannot be closed.\n"
+  "\n"
+  "Arguments:\n"
+  "    prefix (str): The encoding of the frame lengths, either\n"
+  "        ``u16le``, ``u16be``, ``u32le``, ``u32be``, or ``varint``\n"
+  "        for unsigned LEB128 integers.\n"
+  "    max_size (int, *optional*): The maximum size of a frame, above\n"
+  "        which a `ValueError` is raised.\n"
+  "    copy (bool): Pass `True` to yield frames as `bytes` objects\n"
+  "        instead of views.\n"
+  "    strict (bool): Pass `False` to stop the iteration instead of\n"
+  "        raising a `ValueError` on a truncated trailing frame. The\n"
+  "        cursor is then left at the start of the truncated frame.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'\\x02\\x00ab\\x01\\x00c')\n"
+  "    >>> [bytes(frame) for frame in cursor.iter_frames('u16le')]\n"
+  "    [b'ab', b'c']\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_iter_frames_impl(cursor* self, frame_prefix prefix, Py_ssize_t max_size, bool copy, bool strict)
+{
+    frame_iterator* it;
+
+    if (check_closed(self))
+        return NULL;
+
+    it = PyObject_GC_New(frame_iterator, &PyFrameIterator_Type);
+    if (it == NULL)
+        return NULL;
+
+    Py_INCREF(self);
+    it->cursor = self;
+    it->prefix = prefix;
+    it->max_size = max_size;
+    it->copy = copy;
+    it->strict = strict;
+
+    PyObject_GC_Track(it);
+    return (PyObject*) it;
+}
+
+static bool
+_convert_frame_prefix(PyObject* obj, frame_prefix* prefix)
+{
+    const char* name = PyUnicode_AsUTF8(obj);
+    if (name == NULL)
+        return false;
+
+    if (strcmp(name, "u16le") == 0)
+        *prefix = FRAME_PREFIX_U16LE;
+    else if (strcmp(name, "u16be") == 0)
+        *prefix = FRAME_PREFIX_U16BE;
+    else if (strcmp(name, "u32le") == 0)
+        *prefix = FRAME_PREFIX_U32LE;
+    else if (strcmp(name, "u32be") == 0)
+        *prefix = FRAME_PREFIX_U32BE;
+    else if (strcmp(name, "varint") == 0)
+        *prefix = FRAME_PREFIX_VARINT;
+    else {
+        PyErr_Format(PyExc_ValueError, "invalid frame prefix: %R", obj);
+        return false;
+    }
+
+    return true;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_iter_frames(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*    return_value = NULL;
+    cursor*      crs          = (cursor*) self;
+    frame_prefix prefix       = FRAME_PREFIX_U32LE;
+    Py_ssize_t   max_size     = -1;
+    int          copy         = false;
+    int          strict       = true;
+
+    static char* keywords[] = {"prefix", "max_size", "copy", "strict", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&O&pp", keywords, &_convert_frame_prefix, &prefix, &_convert_optional_size, &max_size, &copy, &strict)) {
+        return_value = iocursor_cursor_Cursor_iter_frames_impl(crs, prefix, max_size, (bool) copy, (bool) strict);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_iter_records___doc__,
+  "iter_records(self, sep=b'\\t', line_sep=b'\\n', copy=False)\n"
+  "--\n"
+  "\n"
+  "Iterate over delimited records, starting at the current position.\n"
+  "\n"
+  "Each record is yielded as a `tuple` of fields, which are given as\n"
+  "`memoryview` objects over the cursor buffer, without copy, and do\n"
+  "not include the record separator. The cursor position is advanced\n"
+  "past each record. Quoting is not supported.\n"
+  "\n"
+  "Arguments:\n"
+  "    sep (bytes): The field separator, as a single byte.\n"
+  "    line_sep (bytes): The record separator, as a single byte.\n"
+  "    copy (bool): Pass `True` to get fields as `bytes` objects\n"
+  "        instead of views.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'a,b;c,d')\n"
+  "    >>> list(cursor.iter_records(b',', b';', copy=True))\n"
+  "    [(b'a', b'b'), (b'c', b'd')]\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_iter_records_impl(cursor* self, char sep, char line_sep, bool copy)
+{
+    record_iterator* it;
+
+    if (check_closed(self))
+        return NULL;
+
+    it = PyObject_GC_New(record_iterator, &PyRecordIterator_Type);
+    if (it == NULL)
+        return NULL;
+
+    Py_INCREF(self);
+    it->cursor = self;
+    it->sep = sep;
+    it->line_sep = line_sep;
+    it->copy = copy;
+
+    PyObject_GC_Track(it);
+    return (PyObject*) it;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_iter_records(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject* return_value = NULL;
+    cursor*   crs          = (cursor*) self;
+    char      sep          = '\t';
+    char      line_sep     = '\n';
+    int       copy         = false;
+
+    static char* keywords[] = {"sep", "line_sep", "copy", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|ccp", keywords, &sep, &line_sep, &copy)) {
+        return_value = iocursor_cursor_Cursor_iter_records_impl(crs, sep, line_sep, (bool) copy);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_mark___doc__,
+  "mark(self)\n"
+  "--\n"
+  "\n"
+  "Make a checkpoint, to be released with `commit` or `rollback`.\n"
+  "\n"
+  "This is the explicit form of `Cursor.checkpoint`, for code paths\n"
+  "where a context manager is not practical.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(bytearray(b'abcdef'))\n"
+  "    >>> cursor.mark()\n"
+  "    >>> cursor.write(b'xyz')\n"
+  "    3\n"
+  "    >>> cursor.rollback()\n"
+  "    >>> cursor.tell(), cursor.getvalue()\n"
+  "    (0, bytearray(b'abcdef'))\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_mark_impl(cursor* self)
+{
+    if (check_closed(self))
+        return NULL;
+    if (cursor_mark(self, NULL) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+// --------------------------------------------------------------------------
+
+/* The number of bytes returned by `Cursor.peek` when no size is given */
+#define CURSOR_PEEK_SIZE 8192
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_peek___doc__,
+  "peek(self, size=0)\n"
+  "--\n"
+  "\n"
+  "Return bytes from the stream without advancing the position.\n"
+  "\n"
+  "An empty `bytes` object is returned at EOF.\n"
+  "\n"
+  "Arguments:\n"
+  "    size (int, *optional*): The number of bytes to return. If\n"
+  "        zero, negative or `None`, return at most 8192 bytes.\n"
+  "\n"
+);
+
+static inline PyObject*
+iocursor_cursor_Cursor_peek_impl(cursor* self, Py_ssize_t size)
+{
+    if (check_closed(self))
+        return NULL;
+
+    if (size <= 0)
+        size = CURSOR_PEEK_SIZE;
+    if (self->offset >= self->buffer.len - size)
+        size = self->buffer.len - self->offset;
+    if (size < 0)
+        size = 0;
+
+    return PyBytes_FromStringAndSize(&((char*) self->buffer.buf)[self->offset], size);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_peek(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject *return_value = NULL;
+    cursor* crs            = (cursor*) self;
+    Py_ssize_t size        = 0;
+
+    static char* keywords[] = {"size", NULL};
+    if (_fast_optional_size(args, kwargs, &size)) {
+        return_value = iocursor_cursor_Cursor_peek_impl(crs, size);
+    } else if (PyErr_Occurred()) {
+        return NULL;
+    } else if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &size)) {
+        return_value = iocursor_cursor_Cursor_peek_impl(crs, size);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_read___doc__,
+  "read(self, size=-1)\n"
+  "--\n"
+  "\n"
+  "Read at most ``size`` bytes, returned as a `bytes` object.\n"
+  "\n"
+  "An empty `bytes` object is returned at EOF.\n"
+  "\n"
+  "Arguments:\n"
+  "    size (int, *optional*): The number of bytes to read. If\n"
+  "        negative or `None`, read until EOF is reached.\n"
+  "\n"
+);
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_read1___doc__,
+  "read1(self, size=-1)\n"
+  "--\n"
+  "\n"
+  "Read at most ``size`` bytes with a single syscall.\n"
+  "\n"
+  "An empty `bytes` object is returned at EOF.\n"
+  "\n"
+  "Arguments:\n"
+  "    size (int, *optional*): The number of bytes to read. If\n"
+  "        negative or `None`, read until EOF is reached.\n"
+  "\n"
+);
+
+static inline PyObject*
+iocursor_cursor_Cursor_read_impl(cursor* self, Py_ssize_t size)
+{
+    if (check_closed(self))
+        return NULL;
+
+    if ((size == -1) || (self->offset >= self->buffer.len - size))
+        size = self->buffer.len - self->offset;
+    if (size < 0)
+        size = 0;
+
+    PyObject* bytes = PyBytes_FromStringAndSize(&((char*) self->buffer.buf)[self->offset], size);
+    if (bytes == NULL) {
+        return PyErr_NoMemory();
+    }
+
+    cursor_record(self, CURSOR_OP_READ, self->offset, size);
+
+    self->offset += size;
+    return bytes;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_read(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject *return_value = NULL;
+    cursor* crs            = (cursor*) self;
+    Py_ssize_t size        = -1;
+
+    static char* keywords[] = {"size", NULL};
+    if (_fast_optional_size(args, kwargs, &size)) {
+        return_value = iocursor_cursor_Cursor_read_impl(crs, size);
+    } else if (PyErr_Occurred()) {
+        return NULL;
+    } else if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &size)) {
+        return_value = iocursor_cursor_Cursor_read_impl(crs, size);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_read_array___doc__,
+  "read_array(self, typecode, count=-1, byteorder='<')\n"
+  "--\n"
+  "\n"
+  "Read at most ``count`` items, returned as an `array.array`.\n"
+  "\n"
+  "Only complete items are read, and the items are copied once,\n"
+  "directly from the cursor buffer, then byte-swapped in place if\n"
+  "their byte order differs from the native one.\n"
+  "\n"
+  "Arguments:\n"
+  "    typecode (str): The type code of the array items, as accepted\n"
+  "        by `array.array`.\n"
+  "    count (int, *optional*): The number of items to read. If\n"
+  "        negative or `None`, read until EOF is reached.\n"
+  "    byteorder (str): The byte order of the items in the buffer,\n"
+  "        either ``<`` or ``little``, ``>``, ``!`` or ``big``, or\n"
+  "        ``=``, ``@`` or ``native``.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'\\x00\\x01\\x00\\x02\\x00')\n"
+  "    >>> cursor.read_array('H', byteorder='>')\n"
+  "    array('H', [1, 2])\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_read_array_impl(cursor* self, PyObject* typecode, Py_ssize_t count, bool swap)
+{
+    Py_ssize_t available;
+    Py_ssize_t itemsize;
+    Py_ssize_t nbytes;
+    Py_buffer  buffer;
+    PyObject*  tmp;
+    PyObject*  view;
+    PyObject*  array_type;
+    PyObject*  array      = NULL;
+
+    if (check_closed(self))
+        return NULL;
+
+    /* Create an empty array and get the size of its items */
+    if ((array_type = PyCursor_getarraytype()) == NULL)
+        return NULL;
+    if ((array = PyObject_CallFunctionObjArgs(array_type, typecode, NULL)) == NULL)
+        return NULL;
+    if ((tmp = PyObject_GetAttrString(array, "itemsize")) == NULL)
+        goto fail;
+    itemsize = PyLong_AsSsize_t(tmp);
+    Py_DECREF(tmp);
+    if (itemsize <= 0)
+        goto fail;
+
+    /* Only read complete items */
+    available = (self->offset >= self->buffer.len) ? 0 : (self->buffer.len - self->offset) / itemsize;
+    if ((count < 0) || (count > available))
+        count = available;
+    nbytes = count * itemsize;
+
+    if (count > 0) {
+        /* Copy the items from the cursor buffer into the array */
+        if ((view = cursor_getview(self, self->offset, nbytes)) == NULL)
+            goto fail;
+        tmp = PyObject_CallMethod(array, "frombytes", "O", view);
+        Py_DECREF(view);
+        if (tmp == NULL)
+            goto fail;
+        Py_DECREF(tmp);
+        /* Swap the items in place if needed */
+        if (swap) {
+            if (PyObject_GetBuffer(array, &buffer, PyBUF_WRITABLE) < 0)
+                goto fail;
+            _byteswap(buffer.buf, count, itemsize);
+            PyBuffer_Release(&buffer);
+        }
+    }
+
+    cursor_record(self, CURSOR_OP_READ, self->offset, nbytes);
+    self->offset += nbytes;
+    return array;
+
+fail:
+    if (!PyErr_Occurred())
+        PyErr_SetString(PyExc_ValueError, "invalid array item size");
+    Py_DECREF(array);
+    return NULL;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_read_array(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    PyObject*  typecode     = NULL;
+    Py_ssize_t count        = -1;
+    bool       swap         = false;
+
+    static char* keywords[] = {"typecode", "count", "byteorder", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "U|O&O&", keywords, &typecode, &_convert_optional_size, &count, &_convert_byteorder, &swap)) {
+        return_value = iocursor_cursor_Cursor_read_array_impl(crs, typecode, count, swap);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_read_b64encode___doc__,
+  "read_b64encode(self, size=-1)\n"
+  "--\n"
+  "\n"
+  "Read at most ``size`` bytes, returned encoded in base64.\n"
+  "\n"
+  "The encoding is done directly from the cursor buffer, without\n"
+  "first copying the raw bytes into an intermediate `bytes` object.\n"
+  "\n"
+  "Arguments:\n"
+  "    size (int, *optional*): The number of bytes to read. If\n"
+  "        negative or `None`, read until EOF is reached.\n"
+  "\n"
+  "Example:\n"
+  "    >>> Cursor(b'abcd').read_b64encode()\n"
+  "    b'YWJjZA=='\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_read_b64encode_impl(cursor* self, Py_ssize_t size)
+{
+    PyObject* encoded;
+
+    if (check_closed(self))
+        return NULL;
+
+    if ((size < 0) || (self->offset >= self->buffer.len - size))
+        size = self->buffer.len - self->offset;
+    if (size < 0)
+        size = 0;
+    if (size > (PY_SSIZE_T_MAX - 2) / 4 * 3)
+        return PyErr_NoMemory();
+
+    encoded = PyBytes_FromStringAndSize(NULL, (size + 2) / 3 * 4);
+    if (encoded == NULL)
+        return PyErr_NoMemory();
+
+    _b64_encode(
+        (unsigned char*) PyBytes_AS_STRING(encoded),
+        &((unsigned char*) self->buffer.buf)[self->offset],
+        size
+    );
+
+    cursor_record(self, CURSOR_OP_READ, self->offset, size);
+    self->offset += size;
+    return encoded;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_read_b64encode(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject *return_value = NULL;
+    cursor* crs            = (cursor*) self;
+    Py_ssize_t size        = -1;
+
+    static char* keywords[] = {"size", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &size)) {
+        return_value = iocursor_cursor_Cursor_read_b64encode_impl(crs, size);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_read_fields___doc__,
+  "read_fields(self, sep=b'\\t', maxsplit=-1, copy=False)\n"
+  "--\n"
+  "\n"
+  "Read the next line and split it into fields.\n"
+  "\n"
+  "Fields are returned as `memoryview` objects over the cursor buffer,\n"
+  "without copy, and do not include the line terminator. An empty\n"
+  "`list` is returned at EOF. Quoting is not supported.\n"
+  "\n"
+  "Arguments:\n"
+  "    sep (bytes): The field separator, as a single byte.\n"
+  "    maxsplit (int): The maximum number of splits to do, or -1 to\n"
+  "        split on every separator, like `bytes.split`.\n"
+  "    copy (bool): Pass `True` to get fields as `bytes` objects\n"
+  "        instead of views.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'a\\tb\\tc\\nd\\te\\n')\n"
+  "    >>> cursor.read_fields(copy=True)\n"
+  "    [b'a', b'b', b'c']\n"
+  "    >>> cursor.read_fields(copy=True)\n"
+  "    [b'd', b'e']\n"
+  "    >>> cursor.read_fields()\n"
+  "    []\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_read_fields_impl(cursor* self, char sep, Py_ssize_t maxsplit, bool copy)
+{
+    Py_ssize_t length;
+    Py_ssize_t size;
+    PyObject*  fields;
+
+    if (check_closed(self))
+        return NULL;
+
+    size = (self->offset > self->buffer.len) ? 0 : self->buffer.len - self->offset;
+    if (size == 0) {
+        cursor_record(self, CURSOR_OP_READLINE, self->offset, 0);
+        return PyList_New(0);
+    }
+
+    length = cursor_line_length(self, size, '\n');
+    fields = cursor_split_fields(
+        self,
+        self->offset,
+        ((char*) self->buffer.buf)[self->offset + length - 1] == '\n' ? length - 1 : length,
+        sep,
+        maxsplit,
+        copy,
+        false
+    );
+    if (fields == NULL)
+        return NULL;
+
+    cursor_record(self, CURSOR_OP_READLINE, self->offset, length);
+    self->offset += length;
+    return fields;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_read_fields(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    char       sep          = '\t';
+    Py_ssize_t maxsplit     = -1;
+    int        copy         = false;
+
+    static char* keywords[] = {"sep", "maxsplit", "copy", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|cnp", keywords, &sep, &maxsplit, &copy)) {
+        return_value = iocursor_cursor_Cursor_read_fields_impl(crs, sep, maxsplit, (bool) copy);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_read_many___doc__,
+  "read_many(self, sizes, copy=True)\n"
+  "--\n"
+  "\n"
+  "Read consecutive chunks of the given sizes in a single call.\n"
+  "\n"
+  "This is equivalent to ``[cursor.read(n) for n in sizes]``, but\n"
+  "checks only once that the buffer holds enough data for all the\n"
+  "chunks, so that either all of them or none are read.\n"
+  "\n"
+  "Arguments:\n"
+  "    sizes (sequence of int): The sizes of the chunks to read.\n"
+  "    copy (bool): Pass `False` to get `memoryview` objects over the\n"
+  "        buffer instead of `bytes` objects.\n"
+  "\n"
+  "Returns:\n"
+  "    list: A list with one `bytes` or `memoryview` object per size.\n"
+  "\n"
+  "Raises:\n"
+  "    EOFError: When the buffer is too short to read all the chunks.\n"
+  "        The cursor is left unchanged in this case.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'GIF89a\\x01\\x00\\x01\\x00')\n"
+  "    >>> cursor.read_many([6, 2, 2])\n"
+  "    [b'GIF89a', b'\\x01\\x00', b'\\x01\\x00']\n"
+  "\n"
+);
+
+/* The number of sizes `Cursor.read_many` can handle without allocating */
+#define CURSOR_READ_MANY_SMALL 16
+
+static PyObject*
+iocursor_cursor_Cursor_read_many_impl(cursor* self, PyObject* sizes, bool copy)
+{
+    Py_ssize_t  i;
+    Py_ssize_t  count;
+    Py_ssize_t  total  = 0;
+    Py_ssize_t  start  = self->offset;
+    Py_ssize_t  small[CURSOR_READ_MANY_SMALL];
+    Py_ssize_t* lengths = small;
+    PyObject*   item;
+    PyObject*   chunk;
+    PyObject*   list   = NULL;
+    PyObject*   seq;
+
+    if (check_closed(self))
+        return NULL;
+    if ((seq = PySequence_Fast(sizes, "sizes must be a sequence")) == NULL)
+        return NULL;
+    count = PySequence_Fast_GET_SIZE(seq);
+    if (count > CURSOR_READ_MANY_SMALL && (lengths = PyMem_New(Py_ssize_t, count)) == NULL) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+
+    /* Compute the total size first, to check the bounds only once */
+    for (i = 0; i < count; i++) {
+        item = PySequence_Fast_GET_ITEM(seq, i);
+        if (PyLong_CheckExact(item))
+            lengths[i] = PyLong_AsSsize_t(item);
+        else
+            lengths[i] = PyNumber_AsSsize_t(item, PyExc_OverflowError);
+        if (lengths[i] == -1 && PyErr_Occurred())
+            goto exit;
+        if (check_position(lengths[i], "size"))
+            goto exit;
+        if (lengths[i] > PY_SSIZE_T_MAX - total) {
+            PyErr_SetString(PyExc_OverflowError, "total size overflow");
+            goto exit;
+        }
+        total += lengths[i];
+    }
+    if (check_available(self, total))
+        goto exit;
+
+    if ((list = PyList_New(count)) == NULL)
+        goto exit;
+    for (i = 0; i < count; i++) {
+        if (copy)
+            chunk = PyBytes_FromStringAndSize(&((char*) self->buffer.buf)[self->offset], lengths[i]);
+        else
+            chunk = cursor_getview(self, self->offset, lengths[i]);
+        if (chunk == NULL) {
+            Py_CLEAR(list);
+            self->offset = start;
+            goto exit;
+        }
+        PyList_SET_ITEM(list, i, chunk);
+        self->offset += lengths[i];
+    }
+
+    cursor_record(self, CURSOR_OP_READ, start, total);
+
+exit:
+    if (lengths != small)
+        PyMem_Free(lengths);
+    Py_DECREF(seq);
+    return list;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_read_many(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject* return_value = NULL;
+    cursor*   crs          = (cursor*) self;
+    PyObject* sizes        = NULL;
+    int       copy         = true;
+
+    static char* keywords[] = {"sizes", "copy", NULL};
+    if (kwargs == NULL && PyTuple_GET_SIZE(args) == 1) {
+        return_value = iocursor_cursor_Cursor_read_many_impl(crs, PyTuple_GET_ITEM(args, 0), true);
+    } else if (PyArg_ParseTupleAndKeywords(args, kwargs, "O|p", keywords, &sizes, &copy)) {
+        return_value = iocursor_cursor_Cursor_read_many_impl(crs, sizes, (bool) copy);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_read_view___doc__,
+  "read_view(self, size=-1)\n"
+  "--\n"
+  "\n"
+  "Read at most ``size`` bytes, returned as a `memoryview`.\n"
+  "\n"
+  "The view is taken directly over the cursor buffer, without copy,\n"
+  "and the cursor cannot be closed as long as it exists. Wrapped in a\n"
+  "`pickle.PickleBuffer`, it can be passed as an out-of-band buffer to\n"
+  "`pickle.load` so that large payloads are loaded without copy.\n"
+  "\n"
+  "Arguments:\n"
+  "    size (int, *optional*): The number of bytes to read. If\n"
+  "        negative or `None`, read until EOF is reached.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'abcdef')\n"
+  "    >>> view = cursor.read_view(4)\n"
+  "    >>> view.tobytes()\n"
+  "    b'abcd'\n"
+  "    >>> view.release()\n"
+  "\n"
+);
+
+static inline PyObject*
+iocursor_cursor_Cursor_read_view_impl(cursor* self, Py_ssize_t size)
+{
+    PyObject* view;
+
+    if (check_closed(self))
+        return NULL;
+
+    if ((size < 0) || (self->offset >= self->buffer.len - size))
+        size = self->buffer.len - self->offset;
+    if (size < 0)
+        size = 0;
+
+    view = cursor_getview(self, (size == 0) ? 0 : self->offset, size);
+    if (view == NULL)
+        return NULL;
+
+    cursor_record(self, CURSOR_OP_READ, self->offset, size);
+    self->offset += size;
+    return view;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_read_view(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject *return_value = NULL;
+    cursor* crs            = (cursor*) self;
+    Py_ssize_t size        = -1;
+
+    static char* keywords[] = {"size", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &size)) {
+        return_value = iocursor_cursor_Cursor_read_view_impl(crs, size);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_readable___doc__,
+  "readable(self)\n"
+  "--\n"
+  "\n"
+  "Return ``True`` if the stream can be read from.\n"
+  "\n"
+  "On `Cursor` instances, this always returns `True`, since the\n"
+  "buffers cannot be opened in write-only mode.\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_readable_impl(cursor* self)
+{
+    if (check_closed(self))
+        return NULL;
+    Py_RETURN_TRUE;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_readinto___doc__,
+  "readinto(self, buffer)\n"
+  "--\n"
+  "\n"
+  "Read bytes into the provided buffer.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of bytes read, or 0 if the cursor is at EOF.\n"
+  "\n"
+);
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_readinto1___doc__,
+  "readinto1(self, buffer)\n"
+  "--\n"
+  "\n"
+  "Read bytes into the provided buffer with a single syscall.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of bytes read, or 0 if the cursor is at EOF.\n"
+  "\n"
+);
+
+static inline PyObject*
+iocursor_cursor_Cursor_readinto_impl(cursor* self, Py_buffer* buffer)
+{
+    Py_ssize_t nbytes = buffer->len;
+    Py_ssize_t start;
+
+    if (check_closed(self))
+        return NULL;
+
+    if (self->offset >= self->buffer.len)
+        nbytes = 0;
+    else if (nbytes > self->buffer.len - self->offset)
+        nbytes = self->buffer.len - self->offset;
+
+    /* Claim the range before the copy, which may release the GIL */
+    start = self->offset;
+    self->offset += nbytes;
+    cursor_record(self, CURSOR_OP_READINTO, start, nbytes);
+
+    cursor_copy(self, buffer->buf, &((char*) self->buffer.buf)[start], nbytes);
+    return PyLong_FromSsize_t(nbytes);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_readinto(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    Py_buffer buffer;
+    PyObject* return_value = NULL;
+    cursor*   crs            = (cursor*) self;
+
+    static char* keywords[] = {"buffer", NULL};
+    if (kwargs == NULL && PyTuple_GET_SIZE(args) == 1) {
+        if (PyObject_GetBuffer(PyTuple_GET_ITEM(args, 0), &buffer, PyBUF_WRITABLE) == 0) {
+            return_value = iocursor_cursor_Cursor_readinto_impl(crs, &buffer);
+            PyBuffer_Release(&buffer);
+            return return_value;
+        }
+        /* Let the argument parser raise the same `TypeError` as `w*` */
+        PyErr_Clear();
+    }
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "w*", keywords, &buffer)) {
+        return_value = iocursor_cursor_Cursor_readinto_impl(crs, &buffer);
+        PyBuffer_Release(&buffer);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_readinto_array___doc__,
+  "readinto_array(self, target, byteorder='<')\n"
+  "--\n"
+  "\n"
+  "Read typed items into the provided buffer.\n"
+  "\n"
+  "The size of the items is taken from the buffer exported by\n"
+  "``target``, such as an `array.array` or a `numpy.ndarray`, and only\n"
+  "complete items are read. Items are copied directly into the\n"
+  "target, then byte-swapped in place if their byte order differs\n"
+  "from the native one.\n"
+  "\n"
+  "Arguments:\n"
+  "    target (object): A writable, contiguous buffer.\n"
+  "    byteorder (str): The byte order of the items in the cursor\n"
+  "        buffer, as accepted by `Cursor.read_array`.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of items read, or 0 if the cursor is at EOF.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_readinto_array_impl(cursor* self, Py_buffer* target, bool swap)
+{
+    Py_ssize_t count;
+    Py_ssize_t available;
+    Py_ssize_t itemsize = target->itemsize;
+
+    if (check_closed(self))
+        return NULL;
+
+    count = target->len / itemsize;
+    available = (self->offset >= self->buffer.len) ? 0 : (self->buffer.len - self->offset) / itemsize;
+    if (count > available)
+        count = available;
+
+    memcpy(target->buf, &((char*) self->buffer.buf)[self->offset], count * itemsize);
+    if (swap)
+        _byteswap(target->buf, count, itemsize);
+
+    cursor_record(self, CURSOR_OP_READINTO, self->offset, count * itemsize);
+    self->offset += count * itemsize;
+    return PyLong_FromSsize_t(count);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_readinto_array(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject* return_value = NULL;
+    cursor*   crs          = (cursor*) self;
+    PyObject* target       = NULL;
+    bool      swap         = false;
+    Py_buffer buffer;
+
+    static char* keywords[] = {"target", "byteorder", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "O|O&", keywords, &target, &_convert_byteorder, &swap)) {
+        if (PyObject_GetBuffer(target, &buffer, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) == 0) {
+            return_value = iocursor_cursor_Cursor_readinto_array_impl(crs, &buffer, swap);
+            PyBuffer_Release(&buffer);
+        }
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_readline___doc__,
+  "readline(self, size=-1)\n"
+  "--\n"
+  "\n"
+  "Return the next line from the file, as a bytes object.\n"
+  "\n"
+);
+
+static inline PyObject*
+iocursor_cursor_Cursor_readline_impl(cursor* self, Py_ssize_t size) {
+    if (check_closed(self))
+        return NULL;
+
+    if ((size < 0) || (size >= self->buffer.len - self->offset))
+        size = (self->offset > self->buffer.len) ? 0 : self->buffer.len - self->offset;
+    if (size == 0) {
+        cursor_record(self, CURSOR_OP_READLINE, self->offset, 0);
+        return PyBytes_FromStringAndSize(NULL, 0);
+    }
+
+    char*      start  = &((char*) self->buffer.buf)[self->offset];
+    Py_ssize_t length = cursor_line_length(self, size, '\n');
+    PyObject*  bytes  = PyBytes_FromStringAndSize(start, length);
+    if (bytes == NULL)
+        return PyErr_NoMemory();
+
+    cursor_record(self, CURSOR_OP_READLINE, self->offset, length);
+
+    self->offset += length;
+    return bytes;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_readline(PyObject* self, PyObject *args, PyObject *kwargs) {
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject* return_value = NULL;
+    cursor* crs            = (cursor*) self;
+    Py_ssize_t size        = -1;
+
+    static char* keywords[] = {"size", NULL};
+    if (_fast_optional_size(args, kwargs, &size)) {
+        return_value = iocursor_cursor_Cursor_readline_impl(crs, size);
+    } else if (PyErr_Occurred()) {
+        return NULL;
+    } else if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &size)) {
+        return_value = iocursor_cursor_Cursor_readline_impl(crs, size);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_readlines___doc__,
+  "readlines(self, hint=-1)\n"
+  "--\n"
+  "\n"
+  "Collect all lines from the file into a `list` of `bytes`.\n"
+  "\n"
+  "Arguments:\n"
+  "    hint (int, *optional*): An approximate bound on the total\n"
+  "        number of bytes to be read. When positive, `readlines` will\n"
+  "        stop reading lines when the total number of bytes read\n"
+  "        exceeds ``hint``.\n"
+  "\n"
+  "Example:\n"
+  "    >>> text = b'abc\\ndef\\nghi\\n'\n"
+  "    >>> Cursor(text).readlines()\n"
+  "    [b'abc\\n', b'def\\n', b'ghi\\n']\n"
+  "    >>> Cursor(text).readlines(5)\n"
+  "    [b'abc\\n', b'def\\n']\n"
+  "\n"
+);
+
+static inline PyObject*
+iocursor_cursor_Cursor_readlines_impl(cursor* self, Py_ssize_t hint) {
+
+    char*      start;
+    PyObject*  bytes;
+    PyObject*  lines;
+    Py_ssize_t length = 0;
+    Py_ssize_t total  = 0;
+    Py_ssize_t size   = (self->offset > self->buffer.len) ? 0 : self->buffer.len - self->offset;
+
+    if ((hint <= 0) || hint > size)
+        hint = size;
+
+    if (check_closed(self))
+        return NULL;
+
+    if ((lines = PyList_New(0)) == NULL)
+        return PyErr_NoMemory();
+
+    while (total < hint) {
+        start  = &((char*) self->buffer.buf)[self->offset];
+        length = cursor_line_length(self, size, '\n');
+        if ((bytes = PyBytes_FromStringAndSize((char*) start, length)) == NULL) {
+            Py_DECREF(lines);
+            return PyErr_NoMemory();
+        } else {
+            PyList_Append(lines, bytes);
+            Py_DECREF(bytes);
+        }
+
+        self->offset += length;
+        size -= length;
+        total += length;
+    }
+
+    cursor_record(self, CURSOR_OP_READLINES, self->offset - total, total);
+
+    return lines;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_readlines(PyObject* self, PyObject *args, PyObject *kwargs) {
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject* return_value = NULL;
+    cursor* crs            = (cursor*) self;
+    Py_ssize_t hint        = -1;
+
+    static char* keywords[] = {"hint", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &hint)) {
+        return_value = iocursor_cursor_Cursor_readlines_impl(crs, hint);
+    }
+
+    return return_value;
+}
+
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_rebind___doc__,
+  "rebind(self, buffer, readonly=False, copy_on_write=False)\n"
+  "--\n"
+  "\n"
+  "Make the cursor wrap a new buffer, and rewind it to the start.\n"
+  "\n"
+  "This is cheaper than creating a new `Cursor` for each buffer,\n"
+  "and reopens the cursor if it was closed. I/O statistics and access\n"
+  "traces, if enabled, keep being recorded.\n"
+  "\n"
+  "Arguments:\n"
+  "    buffer (object): An object implementing the buffer protocol.\n"
+  "    readonly (bool): Pass `True` to force the cursor in read-only\n"
+  "        mode, even if the buffer is writable.\n"
+  "    copy_on_write (bool): Pass `True` to make the cursor writable\n"
+  "        without modifying the buffer, as with `Cursor`.\n"
+  "\n"
+  "Raises:\n"
+  "    BufferError: When views of the previous buffer exported by the\n"
+  "        cursor are still alive.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'abc')\n"
+  "    >>> cursor.read()\n"
+  "    b'abc'\n"
+  "    >>> cursor.rebind(b'def')\n"
+  "    >>> cursor.read()\n"
+  "    b'def'\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_rebind_impl(cursor* self, PyObject* source, bool readonly, bool copy_on_write)
+{
+    if (cursor_bind(self, source, readonly, copy_on_write) < 0)
+        return NULL;
+    undo_clear(self->undo);
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_rebind(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject* return_value = NULL;
+    cursor*   crs          = (cursor*) self;
+    PyObject* source        = NULL;
+    int       readonly      = false;
+    int       copy_on_write = false;
+
+    static char* keywords[] = {"buffer", "readonly", "copy_on_write", NULL};
+    if (kwargs == NULL && PyTuple_GET_SIZE(args) == 1) {
+        return_value = iocursor_cursor_Cursor_rebind_impl(crs, PyTuple_GET_ITEM(args, 0), false, false);
+    } else if (PyArg_ParseTupleAndKeywords(args, kwargs, "O|pp", keywords, &source, &readonly, &copy_on_write)) {
+        return_value = iocursor_cursor_Cursor_rebind_impl(crs, source, (bool) readonly, (bool) copy_on_write);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+/* Move up to `n` bytes between the buffer at the cursor position and
+   `target`, stopping early at EOF or when a non-blocking target would
+   block. Objects with `send` and `recv_into` methods, such as sockets,
+   are called with views over the buffer; anything else is treated as a
+   file descriptor and accessed with the GIL released. The cursor is
+   advanced by the number of bytes moved, even when an error occurs. */
+static Py_ssize_t
+cursor_transfer(cursor* self, PyObject* target, Py_ssize_t n, bool receive)
+{
+    const char* method = receive ? "recv_into" : "send";
+    Py_ssize_t  total  = 0;
+    Py_ssize_t  count;
+    PyObject*   view;
+    PyObject*   result;
+    char*       data;
+    bool        failed = false;
+    int         err;
+    int         fd;
+
+    if (!PyLong_Check(target) && PyObject_HasAttrString(target, method)) {
+        while (total < n) {
+            if ((view = cursor_getview(self, self->offset, n - total)) == NULL)
+                return -1;
+            result = PyObject_CallMethod(target, method, "O", view);
+            Py_DECREF(view);
+            /* Report a partial transfer on a non-blocking socket, like
+               the file descriptor path does, rather than losing it */
+            if (result == NULL && total > 0 && PyErr_ExceptionMatches(PyExc_BlockingIOError)) {
+                PyErr_Clear();
+                break;
+            }
+            if (result == NULL)
+                return -1;
+            count = PyLong_AsSsize_t(result);
+            Py_DECREF(result);
+            if (count == -1 && PyErr_Occurred())
+                return -1;
+            if (count <= 0)
+                break;
+            self->offset += count;
+            total += count;
+        }
+        return total;
+    }
+
+    if ((fd = PyObject_AsFileDescriptor(target)) < 0)
+        return -1;
+
+    /* Prevent the buffer from being released while the GIL is released */
+    self->exports++;
+    while (total < n) {
+        data = &((char*) self->buffer.buf)[self->offset];
+        Py_BEGIN_ALLOW_THREADS
+#ifdef MS_WINDOWS
+        if (receive)
+            count = _read(fd, data, (unsigned int) Py_MIN(n - total, INT_MAX));
+        else
+            count = _write(fd, data, (unsigned int) Py_MIN(n - total, INT_MAX));
+#else
+        if (receive)
+            count = read(fd, data, n - total);
+        else
+            count = write(fd, data, n - total);
+#endif
+        err = errno;
+        Py_END_ALLOW_THREADS
+        if (count < 0) {
+            if (err == EINTR) {
+                if (PyErr_CheckSignals() < 0) {
+                    failed = true;
+                    break;
+                }
+                continue;
+            }
+            if ((err == EAGAIN || err == EWOULDBLOCK) && total > 0)
+                break;
+            errno = err;
+            PyErr_SetFromErrno(PyExc_OSError);
+            failed = true;
+            break;
+        }
+        if (count == 0)
+            break;
+        self->offset += count;
+        total += count;
+    }
+    self->exports--;
+
+    return failed ? -1 : total;
+}
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_recv_from___doc__,
+  "recv_from(self, source, n=-1)\n"
+  "--\n"
+  "\n"
+  "Receive bytes from a socket or file descriptor into the buffer.\n"
+  "\n"
+  "The data is received directly at the cursor position, without an\n"
+  "intermediate buffer, and the cursor is advanced by the number of\n"
+  "bytes received. Sockets are read with their ``recv_into`` method,\n"
+  "so that their timeout is honoured. Other objects are read from\n"
+  "their file descriptor with the GIL released, bypassing any\n"
+  "buffering done by the file object. Interrupted system calls are\n"
+  "retried after running the signal handlers.\n"
+  "\n"
+  "Arguments:\n"
+  "    source (socket, file or int): The object to receive data from,\n"
+  "        or a file descriptor.\n"
+  "    n (int, *optional*): The number of bytes to receive. If negative\n"
+  "        or `None`, receive until the end of the buffer.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of bytes received, which is less than ``n``\n"
+  "    only if EOF was reached, or if ``source`` is non-blocking and no\n"
+  "    more data is available.\n"
+  "\n"
+  "Raises:\n"
+  "    BufferError: When the buffer is too small to fit ``n`` bytes\n"
+  "        at the current position.\n"
+  "    OSError: When receiving fails. The cursor is still advanced by\n"
+  "        the number of bytes received before the error.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_recv_from_impl(cursor* self, PyObject* source, Py_ssize_t n)
+{
+    Py_ssize_t start = self->offset;
+    Py_ssize_t total;
+
+    if (check_closed(self))
+        return NULL;
+    if (check_writable(self))
+        return NULL;
+
+    if (n < 0)
+        n = self->offset < self->buffer.len ? self->buffer.len - self->offset : 0;
+    else if (n > 0 && check_space(self, n))
+        return NULL;
+    if (cursor_save(self, self->offset, n) < 0)
+        return NULL;
+
+    total = cursor_transfer(self, source, n, true);
+    cursor_record(self, CURSOR_OP_WRITE, start, self->offset - start);
+
+    return total < 0 ? NULL : PyLong_FromSsize_t(total);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_recv_from(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    PyObject*  source       = NULL;
+    Py_ssize_t n            = -1;
+
+    static char* keywords[] = {"source", "n", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "O|O&", keywords, &source, _convert_optional_size, &n)) {
+        return_value = iocursor_cursor_Cursor_recv_from_impl(crs, source, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_reserve___doc__,
+  "reserve(self, n)\n"
+  "--\n"
+  "\n"
+  "Reserve ``n`` bytes at the current position for a direct write.\n"
+  "\n"
+  "The returned `memoryview` is taken directly over the cursor buffer,\n"
+  "so that producers such as `socket.socket.recv_into` can write to it\n"
+  "without an intermediate copy. Once the data is produced, the\n"
+  "reservation must be committed with `Cursor.commit_reserved`, which\n"
+  "moves the cursor past the bytes that were actually written. The\n"
+  "cursor cannot be closed or rebound until then.\n"
+  "\n"
+  "Raises:\n"
+  "    BufferError: When another reservation is pending, or when the\n"
+  "        buffer is too small to hold ``n`` more bytes.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(bytearray(8))\n"
+  "    >>> with cursor.reserve(4) as view:\n"
+  "    ...     view[:3] = b'abc'\n"
+  "    >>> cursor.commit_reserved(3)\n"
+  "    >>> cursor.tell()\n"
+  "    3\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_reserve_impl(cursor* self, Py_ssize_t n)
+{
+    PyObject* view;
+
+    if (check_closed(self))
+        return NULL;
+    if (n < 0) {
+        PyErr_Format(PyExc_ValueError, "negative size value %zd", n);
+        return NULL;
+    }
+    if (self->reserved) {
+        PyErr_SetString(PyExc_BufferError, "another reservation is pending");
+        return NULL;
+    }
+    if (check_writable(self))
+        return NULL;
+
+    if (n > 0) {
+        if (check_space(self, n))
+            return NULL;
+        /* The producer writes behind our back, so save the whole range */
+        if (cursor_save(self, self->offset, n) < 0)
+            return NULL;
+    }
+
+    if ((view = cursor_getview(self, (n == 0) ? 0 : self->offset, n)) == NULL)
+        return NULL;
+
+    self->reserved = true;
+    self->reserve_offset = self->offset;
+    self->reserve_size = n;
+    return view;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_reserve(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t n;
+
+    static char* keywords[] = {"n", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "n", keywords, &n)) {
+        return_value = iocursor_cursor_Cursor_reserve_impl(crs, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_rfind___doc__,
+  "rfind(self, sub, start=None, end=None)\n"
+  "--\n"
+  "\n"
+  "Return the highest position in the buffer where ``sub`` is found.\n"
+  "\n"
+  "The search is done in ``buffer[start:end]``, without moving the\n"
+  "cursor, and ``-1`` is returned if ``sub`` is not found. As with\n"
+  "`Cursor.find`, the search starts at the cursor position by default.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'a\\r\\nb\\r\\nc')\n"
+  "    >>> cursor.rfind(b'\\r\\n')\n"
+  "    4\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_rfind_impl(cursor* self, Py_buffer* sub, Py_ssize_t start, Py_ssize_t end)
+{
+    const char* data = (const char*) self->buffer.buf;
+    const char* found;
+
+    if (check_closed(self))
+        return NULL;
+
+    if (!_clamp_slice(&start, &end, self->buffer.len))
+        return PyLong_FromLong(-1);
+
+    found = _search_backward(&data[start], end - start, (const char*) sub->buf, sub->len);
+    return PyLong_FromSsize_t(found == NULL ? -1 : found - data);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_rfind(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    Py_buffer  sub;
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t start        = crs->offset;
+    Py_ssize_t end          = crs->buffer.len;
+
+    static char* keywords[] = {"sub", "start", "end", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "y*|O&O&", keywords, &sub, _convert_optional_size, &start, _convert_optional_size, &end)) {
+        return_value = iocursor_cursor_Cursor_rfind_impl(crs, &sub, start, end);
+        PyBuffer_Release(&sub);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_rollback___doc__,
+  "rollback(self)\n"
+  "--\n"
+  "\n"
+  "Release the innermost checkpoint, undoing the changes made since.\n"
+  "\n"
+  "The bytes overwritten since the checkpoint was made are restored,\n"
+  "and the cursor is moved back to its position at that time.\n"
+  "\n"
+  "Raises:\n"
+  "    ValueError: When no checkpoint is active.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_rollback_impl(cursor* self)
+{
+    if (check_closed(self) || check_checkpoint(self, NULL))
+        return NULL;
+    cursor_rollback(self);
+    Py_RETURN_NONE;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_seek___doc__,
+  "seek(self, pos, whence=0)\n"
+  "--\n"
+  "\n"
+  "Change the stream position.\n"
+  "\n"
+  "Seek to byte offset pos relative to position indicated by whence:\n"
+  "    - 0  Start of stream (the default) - pos should be >= 0.\n"
+  "    - 1  Current position - pos may be negative.\n"
+  "    - 2  End of stream - pos usually negative.\n"
+  "\n"
+  "Returns\n"
+  "    int: The new absolute position.\n"
+  "\n"
+);
+
+static inline PyObject*
+iocursor_cursor_Cursor_seek_impl(cursor* self, Py_ssize_t pos, int whence)
+{
+    Py_ssize_t new_pos;
+
+    if (check_closed(self))
+        return NULL;
+
+    switch (whence) {
+        case SEEK_SET:
+            new_pos = pos;
+            break;
+        case SEEK_CUR:
+            if (pos > PY_SSIZE_T_MAX - self->offset) {
+                PyErr_SetString(PyExc_OverflowError, "new position too large");
+                return NULL;
+            }
+            new_pos = self->offset + pos;
+            break;
+        case SEEK_END:
+            if (pos > PY_SSIZE_T_MAX - self->buffer.len) {
+                PyErr_SetString(PyExc_OverflowError, "new position too large");
+                return NULL;
+            }
+            new_pos = self->buffer.len + pos;
+            break;
+        default:
+            return PyErr_Format(
+                PyExc_ValueError,
+                "invalid whence (%i, should be %i, %i or %i)",
+                whence,
+                SEEK_SET,
+                SEEK_CUR,
+                SEEK_END
+            );
+    }
+
+    if (new_pos < 0) {
+        if (whence == SEEK_SET) {
+            PyErr_Format(PyExc_ValueError, "negative seek value %zd", pos);
+            return NULL;
+        } else {
+            new_pos = 0;
+        }
+    }
+
+    cursor_record_seek(self, self->offset, new_pos);
+
+    self->offset = new_pos;
+    return PyLong_FromSsize_t(new_pos);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_seek(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject* return_value = NULL;
+    cursor* crs            = (cursor*) self;
+    Py_ssize_t pos         = 0;
+    int whence             = SEEK_SET;
+
+    static char* keywords[] = {"pos", "whence", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "n|i", keywords, &pos, &whence)) {
+        return_value = iocursor_cursor_Cursor_seek_impl(crs, pos, whence);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_seek_to___doc__,
+  "seek_to(self, sub, end=None)\n"
+  "--\n"
+  "\n"
+  "Move to the next occurrence of ``sub`` after the cursor position.\n"
+  "\n"
+  "The cursor is left at the start of the occurrence, so that reading\n"
+  "continues with ``sub`` itself. If ``sub`` is not found before ``end``,\n"
+  "the cursor is not moved.\n"
+  "\n"
+  "Arguments:\n"
+  "    sub (bytes-like object): The bytes to search for.\n"
+  "    end (int, *optional*): The position to stop searching at,\n"
+  "        interpreted as in slice notation. If `None`, search until\n"
+  "        the end of the buffer.\n"
+  "\n"
+  "Returns:\n"
+  "    `int`: The new position of the cursor, or ``-1`` if ``sub`` was\n"
+  "    not found.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'garbage\\xff\\xd8\\xff\\xe0')\n"
+  "    >>> cursor.seek_to(b'\\xff\\xd8')\n"
+  "    7\n"
+  "    >>> cursor.read(2)\n"
+  "    b'\\xff\\xd8'\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_seek_to_impl(cursor* self, Py_buffer* sub, Py_ssize_t end)
+{
+    Py_ssize_t position;
+
+    if (check_closed(self))
+        return NULL;
+
+    position = cursor_find(self, sub, self->offset, end);
+    if (position >= 0) {
+        cursor_record_seek(self, self->offset, position);
+        self->offset = position;
+    }
+
+    return PyLong_FromSsize_t(position);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_seek_to(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    Py_buffer  sub;
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t end          = crs->buffer.len;
+
+    static char* keywords[] = {"sub", "end", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "y*|O&", keywords, &sub, _convert_optional_size, &end)) {
+        return_value = iocursor_cursor_Cursor_seek_to_impl(crs, &sub, end);
+        PyBuffer_Release(&sub);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_seekable___doc__,
+  "seekable(self)\n"
+  "--\n"
+  "\n"
+  "Return `True` if the stream supports random access.\n"
+  "\n"
+  "Always `True` for `Cursor` instances.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_seekable_impl(cursor* self)
+{
+    if (check_closed(self))
+        return NULL;
+    Py_RETURN_TRUE;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_send_to___doc__,
+  "send_to(self, target, n=-1)\n"
+  "--\n"
+  "\n"
+  "Send bytes from the buffer to a socket or file descriptor.\n"
+  "\n"
+  "The data is sent directly from the cursor position, without an\n"
+  "intermediate copy, and the cursor is advanced by the number of\n"
+  "bytes sent. Sockets are written with their ``send`` method, so\n"
+  "that their timeout is honoured. Other objects are written to their\n"
+  "file descriptor with the GIL released, bypassing any buffering\n"
+  "done by the file object. Partial writes are resumed, and\n"
+  "interrupted system calls are retried after running the signal\n"
+  "handlers.\n"
+  "\n"
+  "Arguments:\n"
+  "    target (socket, file or int): The object to send data to, or\n"
+  "        a file descriptor.\n"
+  "    n (int, *optional*): The number of bytes to send. If negative\n"
+  "        or `None`, send until EOF is reached.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of bytes sent, which is less than ``n`` only if\n"
+  "    EOF was reached, or if ``target`` is non-blocking and cannot\n"
+  "    accept more data.\n"
+  "\n"
+  "Raises:\n"
+  "    OSError: When sending fails. The cursor is still advanced by\n"
+  "        the number of bytes sent before the error.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_send_to_impl(cursor* self, PyObject* target, Py_ssize_t n)
+{
+    Py_ssize_t start = self->offset;
+    Py_ssize_t total;
+
+    if (check_closed(self))
+        return NULL;
+
+    if (self->offset >= self->buffer.len)
+        n = 0;
+    else if (n < 0 || n > self->buffer.len - self->offset)
+        n = self->buffer.len - self->offset;
+
+    total = cursor_transfer(self, target, n, false);
+    cursor_record(self, CURSOR_OP_READ, start, self->offset - start);
+
+    return total < 0 ? NULL : PyLong_FromSsize_t(total);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_send_to(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    PyObject*  target       = NULL;
+    Py_ssize_t n            = -1;
+
+    static char* keywords[] = {"target", "n", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "O|O&", keywords, &target, _convert_optional_size, &n)) {
+        return_value = iocursor_cursor_Cursor_send_to_impl(crs, target, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_skip___doc__,
+  "skip(self, n, /)\n"
+  "--\n"
+  "\n"
+  "Advance the cursor by ``n`` bytes, without reading them.\n"
+  "\n"
+  "Unlike `Cursor.seek`, this cannot move the cursor past the end of\n"
+  "the buffer, which makes it suitable to skip over padding or unused\n"
+  "fields while parsing.\n"
+  "\n"
+  "Raises:\n"
+  "    EOFError: When the buffer is too short to skip ``n`` bytes. The\n"
+  "        cursor is left unchanged in this case.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_skip_impl(cursor* self, Py_ssize_t n)
+{
+    if (check_closed(self))
+        return NULL;
+    if (check_position(n, "size"))
+        return NULL;
+    if (check_available(self, n))
+        return NULL;
+
+    cursor_record_seek(self, self->offset, self->offset + n);
+    self->offset += n;
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_skip(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t n;
+
+    static char* keywords[] = {"n", NULL};
+    if (PyTuple_GET_SIZE(args) == 1 && _fast_optional_size(args, kwargs, &n)) {
+        return_value = iocursor_cursor_Cursor_skip_impl(crs, n);
+    } else if (PyErr_Occurred()) {
+        return NULL;
+    } else if (PyArg_ParseTupleAndKeywords(args, kwargs, "n", keywords, &n)) {
+        return_value = iocursor_cursor_Cursor_skip_impl(crs, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_split_aligned___doc__,
+  "split_aligned(self, n_parts, sep=b'\\n', ranges=False)\n"
+  "--\n"
+  "\n"
+  "Split the rest of the buffer into parts ending on a separator.\n"
+  "\n"
+  "The data between the current position and the end of the buffer is\n"
+  "cut in ``n_parts`` parts of roughly equal size, each cut being moved\n"
+  "forward to just after the next separator, so that records are never\n"
+  "split between two parts. Parts can be empty when records are longer\n"
+  "than the part size. The cursor position is unchanged.\n"
+  "\n"
+  "Arguments:\n"
+  "    n_parts (int): The number of parts to split the buffer into.\n"
+  "    sep (bytes): The record separator, as a single byte.\n"
+  "    ranges (bool): Pass `True` to get ``(start, end)`` pairs of\n"
+  "        positions in the buffer instead of cursors.\n"
+  "\n"
+  "Returns:\n"
+  "    list: A list of ``n_parts`` new `Cursor` objects, each wrapping\n"
+  "    a view over one part of the buffer without copy, or a list of\n"
+  "    ``(start, end)`` tuples if ``ranges`` is `True`.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'a\\nbb\\nccc\\ndddd\\n')\n"
+  "    >>> [part.read() for part in cursor.split_aligned(2)]\n"
+  "    [b'a\\nbb\\nccc\\n', b'dddd\\n']\n"
+  "    >>> cursor.split_aligned(2, ranges=True)\n"
+  "    [(0, 9), (9, 14)]\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_split_aligned_impl(cursor* self, Py_ssize_t n_parts, char sep, bool ranges)
+{
+    Py_ssize_t  i;
+    Py_ssize_t  start;
+    Py_ssize_t  end;
+    Py_ssize_t  length;
+    Py_ssize_t  target;
+    const char* data = (const char*) self->buffer.buf;
+    const char* found;
+    PyObject*   part;
+    PyObject*   view;
+    PyObject*   list;
+
+    if (check_closed(self))
+        return NULL;
+    if (n_parts <= 0) {
+        PyErr_Format(PyExc_ValueError, "n_parts must be positive, not %zd", n_parts);
+        return NULL;
+    }
+
+    start = self->offset < self->buffer.len ? self->offset : self->buffer.len;
+    length = self->buffer.len - start;
+    if ((list = PyList_New(n_parts)) == NULL)
+        return NULL;
+
+    for (i = 0; i < n_parts; i++) {
+        /* Move each cut to just after the first separator following the
+           evenly spaced target, or to the end of the buffer */
+        if (i == n_parts - 1) {
+            end = self->buffer.len;
+        } else {
+            target = self->buffer.len - length + (Py_ssize_t) ((double) length * (i + 1) / n_parts);
+            if (target <= start) {
+                end = start;
+            } else {
+                found = memchr(&data[target - 1], sep, self->buffer.len - target + 1);
+                end = (found == NULL) ? self->buffer.len : found - data + 1;
+            }
+        }
+
+        if (ranges) {
+            part = Py_BuildValue("(nn)", start, end);
+        } else {
+            view = cursor_getview(self, start, end - start);
+            if (view == NULL) {
+                Py_DECREF(list);
+                return NULL;
+            }
+            part = PyObject_CallFunction((PyObject*) &PyCursor_Type, "Oi", view, (int) self->readonly);
+            Py_DECREF(view);
+        }
+        if (part == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, part);
+        start = end;
+    }
+
+    return list;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_split_aligned(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t n_parts;
+    char       sep          = '\n';
+    int        ranges       = false;
+
+    static char* keywords[] = {"n_parts", "sep", "ranges", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "n|cp", keywords, &n_parts, &sep, &ranges)) {
+        return_value = iocursor_cursor_Cursor_split_aligned_impl(crs, n_parts, sep, (bool) ranges);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_stats___doc__,
+  "stats(self, reset=False)\n"
+  "--\n"
+  "\n"
+  "Get the I/O statistics recorded since the cursor was created.\n"
+  "\n"
+  "Statistics are only recorded for cursors created with\n"
+  "``stats=True``, and this method returns `None` otherwise. The\n"
+  "returned `dict` contains the number of ``calls`` to each I/O\n"
+  "method, the total number of ``bytes_read`` and ``bytes_written``,\n"
+  "the total ``seek_distance`` and the number of ``backward_seeks``,\n"
+  "as well as a ``histogram`` of request sizes, where bucket *i*\n"
+  "counts the requests of size in the range ``[2**(i-1), 2**i)``.\n"
+  "\n"
+  "Arguments:\n"
+  "    reset (bool): Pass `True` to reset the statistics to zero\n"
+  "        after they have been retrieved.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(b'abc\\ndef\\n', stats=True)\n"
+  "    >>> cursor.readline()\n"
+  "    b'abc\\n'\n"
+  "    >>> cursor.stats()['bytes_read']\n"
+  "    4\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_stats_impl(cursor* self, bool reset)
+{
+    size_t     i;
+    PyObject*  value;
+    PyObject*  calls     = NULL;
+    PyObject*  histogram = NULL;
+    PyObject*  stats     = NULL;
+
+    if (self->stats == NULL)
+        Py_RETURN_NONE;
+
+    if ((calls = PyDict_New()) == NULL)
+        goto fail;
+    for (i = 0; i < CURSOR_OP_MAX; i++) {
+        if ((value = PyLong_FromUnsignedLongLong(self->stats->calls[i])) == NULL)
+            goto fail;
+        if (PyDict_SetItemString(calls, cursor_op_names[i], value) < 0) {
+            Py_DECREF(value);
+            goto fail;
+        }
+        Py_DECREF(value);
+    }
+
+    if ((histogram = PyList_New(CURSOR_HISTOGRAM_SIZE)) == NULL)
+        goto fail;
+    for (i = 0; i < CURSOR_HISTOGRAM_SIZE; i++) {
+        if ((value = PyLong_FromUnsignedLongLong(self->stats->histogram[i])) == NULL)
+            goto fail;
+        PyList_SET_ITEM(histogram, i, value);
+    }
+
+    stats = Py_BuildValue(
+        "{sOsKsKsKsKsO}",
+        "calls",          calls,
+        "bytes_read",     self->stats->bytes_read,
+        "bytes_written",  self->stats->bytes_written,
+        "seek_distance",  self->stats->seek_distance,
+        "backward_seeks", self->stats->backward_seeks,
+        "histogram",      histogram
+    );
+    if (stats != NULL && reset)
+        memset(self->stats, 0, sizeof(cursor_stats));
+
+fail:
+    Py_XDECREF(calls);
+    Py_XDECREF(histogram);
+    return stats;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_stats(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject* return_value = NULL;
+    cursor*   crs          = (cursor*) self;
+    int       reset        = false;
+
+    static char* keywords[] = {"reset", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|p", keywords, &reset)) {
+        return_value = iocursor_cursor_Cursor_stats_impl(crs, (bool) reset);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_tell___doc__,
+  "tell(self)\n"
+  "--\n"
+  "\n"
+  "Get the current file position as an integer.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_tell_impl(cursor* self)
+{
+    if (check_closed(self))
+        return NULL;
+    return PyLong_FromSsize_t(self->offset);
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_text___doc__,
+  "text(self)\n"
+  "--\n"
+  "\n"
+  "Get a `TextCursor` reading UTF-8 text from this cursor.\n"
+  "\n"
+  "This is a shortcut for ``TextCursor(cursor)``: the text cursor\n"
+  "shares the position of this cursor.\n"
+  "\n"
+  "Raises:\n"
+  "    UnicodeDecodeError: When the buffer is not valid UTF-8.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor('h\\u00e9llo\\nw\\u00f6rld\\n'.encode())\n"
+  "    >>> cursor.text().readline()\n"
+  "    'h\\xe9llo\\n'\n"
+  "    >>> cursor.tell()\n"
+  "    7\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_text_impl(cursor* self)
+{
+    if (check_closed(self))
+        return NULL;
+    return PyObject_CallFunctionObjArgs((PyObject*) &PyTextCursor_Type, (PyObject*) self, NULL);
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_trace___doc__,
+  "trace(self, reset=False)\n"
+  "--\n"
+  "\n"
+  "Get the access trace recorded since the cursor was created.\n"
+  "\n"
+  "Traces are only recorded for cursors created with ``trace=True``,\n"
+  "and this method returns `None` otherwise. The trace is returned\n"
+  "serialized as a `bytes` object, starting with the ``b'IOCT'``\n"
+  "magic, a version byte and the number of records that could not\n"
+  "be stored because of an allocation failure, as a little-endian\n"
+  "unsigned 64-bit integer. It is followed by one 17-byte record per\n"
+  "operation, with the operation code as an unsigned byte, and the\n"
+  "offset and size of the operation as little-endian unsigned 64-bit\n"
+  "integers (``struct`` format ``'<BQQ'``). Seeks are recorded with\n"
+  "the new position as their offset and a size of zero.\n"
+  "\n"
+  "Operation codes are, in order: ``read``, ``readinto``,\n"
+  "``readline``, ``readlines``, ``seek``, ``write`` and ``writelines``.\n"
+  "\n"
+  "Arguments:\n"
+  "    reset (bool): Pass `True` to clear the trace, and the count of\n"
+  "        dropped records, after it has been retrieved.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_trace_impl(cursor* self, bool reset)
+{
+    size_t         i;
+    unsigned char* dst;
+    PyObject*      bytes;
+
+    if (self->trace == NULL)
+        Py_RETURN_NONE;
+
+    bytes = PyBytes_FromStringAndSize(NULL, CURSOR_TRACE_HEADER_SIZE + CURSOR_TRACE_RECORD_SIZE*self->trace->length);
+    if (bytes == NULL)
+        return PyErr_NoMemory();
+
+    dst = (unsigned char*) PyBytes_AS_STRING(bytes);
+    memcpy(dst, CURSOR_TRACE_MAGIC, 4);
+    dst[4] = CURSOR_TRACE_VERSION;
+    _write_u64le(&dst[5], (unsigned long long) self->trace->dropped);
+    dst += CURSOR_TRACE_HEADER_SIZE;
+
+    for (i = 0; i < self->trace->length; i++) {
+        dst[0] = self->trace->records[i].op;
+        _write_u64le(&dst[1], self->trace->records[i].offset);
+        _write_u64le(&dst[9], self->trace->records[i].size);
+        dst += CURSOR_TRACE_RECORD_SIZE;
+    }
+
+    if (reset) {
+        self->trace->length = 0;
+        self->trace->dropped = 0;
+    }
+
+    return bytes;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_trace(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject* return_value = NULL;
+    cursor*   crs          = (cursor*) self;
+    int       reset        = false;
+
+    static char* keywords[] = {"reset", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|p", keywords, &reset)) {
+        return_value = iocursor_cursor_Cursor_trace_impl(crs, (bool) reset);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_truncate___doc__,
+  "truncate(self, size=None, /)\n"
+  "--\n"
+  "\n"
+  "Truncate the file to at most size bytes.\n"
+  "\n"
+  "This is not supported by `Cursor` instances, and calling this\n"
+  "method will effectively raise the `io.UnsupportedOperation`\n"
+  "exception.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_truncate_impl(cursor* self, Py_ssize_t size)
+{
+    if (check_closed(self))
+        return NULL;
+
+    PyObject* err = PyCursor_getunsupportedoperation();
+    if (err != NULL)
+        PyErr_SetString(err, "truncate");
+
+    return NULL;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_truncate(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value   = NULL;
+    cursor*    crs            = (cursor*) self;
+    Py_ssize_t size           = crs->offset;
+
+    static char* keywords[] = {"b", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &size)) {
+        return_value = iocursor_cursor_Cursor_truncate_impl(crs, size);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_writable___doc__,
+  "writable(self)\n"
+  "--\n"
+  "\n"
+  "Return ``True`` if the stream supports writing to it."
+);
+
+static PyObject*
+iocursor_cursor_Cursor_writable_impl(cursor* self)
+{
+    if (check_closed(self))
+        return NULL;
+    if (self->copy_on_write)
+        Py_RETURN_TRUE;
+    return PyBool_FromLong(!(self->readonly || self->buffer.readonly));
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_write___doc__,
+  "write(self, b, /)\n"
+  "--\n"
+  "\n"
+  "Write the given bytes to the buffer.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of bytes written.\n"
+  "\n"
+);
+
+static inline PyObject*
+iocursor_cursor_Cursor_write_impl(cursor* self, Py_buffer* bytes)
+{
+    Py_ssize_t start = self->offset;
+
+    /* Check the cursor is still writable */
+    if (check_closed(self))
+        return NULL;
+    if (check_writable(self))
+        return NULL;
+
+    /* No-op if there are no bytes to write */
+    if (bytes->len > 0) {
+        /* Check the buffer is large enough to hold the data */
+        if (check_space(self, bytes->len))
+            return NULL;
+        if (cursor_save(self, self->offset, bytes->len) < 0)
+            return NULL;
+        /* Claim the range before the copy, which may release the GIL */
+        self->offset += bytes->len;
+        cursor_record(self, CURSOR_OP_WRITE, start, bytes->len);
+        /* Copy data from `bytes` to the buffer */
+        cursor_copy(self, &((char*) self->buffer.buf)[start], bytes->buf, bytes->len);
+    } else {
+        cursor_record(self, CURSOR_OP_WRITE, start, 0);
+    }
+
+    return PyLong_FromSsize_t(bytes->len);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_write(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    Py_buffer bytes;
+    PyObject *return_value = NULL;
+    cursor* crs            = (cursor*) self;
+
+    static char* keywords[] = {"b", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "y*", keywords, &bytes)) {
+        return_value = iocursor_cursor_Cursor_write_impl(crs, &bytes);
+        PyBuffer_Release(&bytes);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_write_at___doc__,
+  "write_at(self, offset, data)\n"
+  "--\n"
+  "\n"
+  "Write the given bytes to the buffer at the given position.\n"
+  "\n"
+  "The cursor position is unchanged, which makes this method suitable\n"
+  "to patch headers after the rest of the data has been written.\n"
+  "\n"
+  "Arguments:\n"
+  "    offset (int): The position to write the bytes at.\n"
+  "    data (bytes-like object): The bytes to write.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of bytes written.\n"
+  "\n"
+  "Raises:\n"
+  "    BufferError: When the buffer is too small to fit the data at\n"
+  "        the given position.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(bytearray(6))\n"
+  "    >>> cursor.seek(2)\n"
+  "    2\n"
+  "    >>> cursor.write(b'data')\n"
+  "    4\n"
+  "    >>> cursor.write_at(0, b'\\x00\\x04')\n"
+  "    2\n"
+  "    >>> cursor.getvalue()\n"
+  "    bytearray(b'\\x00\\x04data')\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_write_at_impl(cursor* self, Py_ssize_t offset, Py_buffer* bytes)
+{
+    if (check_closed(self))
+        return NULL;
+    if (check_writable(self))
+        return NULL;
+    if (check_position(offset, "offset"))
+        return NULL;
+
+    if (bytes->len > 0) {
+        if (check_space_at(self, offset, bytes->len))
+            return NULL;
+        if (cursor_save(self, offset, bytes->len) < 0)
+            return NULL;
+        cursor_copy(self, &((char*) self->buffer.buf)[offset], bytes->buf, bytes->len);
+    }
+
+    cursor_record(self, CURSOR_OP_WRITE, offset, bytes->len);
+
+    return PyLong_FromSsize_t(bytes->len);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_write_at(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    Py_buffer  bytes;
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t offset;
+
+    static char* keywords[] = {"offset", "data", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "ny*", keywords, &offset, &bytes)) {
+        return_value = iocursor_cursor_Cursor_write_at_impl(crs, offset, &bytes);
+        PyBuffer_Release(&bytes);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_write_b64decode___doc__,
+  "write_b64decode(self, data, /)\n"
+  "--\n"
+  "\n"
+  "Decode the given base64 data and write it to the buffer.\n"
+  "\n"
+  "The decoding is done directly into the cursor buffer, without\n"
+  "allocating an intermediate `bytes` object. The input must use\n"
+  "the standard alphabet with padding, and may not contain any\n"
+  "whitespace, like with ``base64.b64decode(data, validate=True)``.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of bytes written.\n"
+  "\n"
+  "Raises:\n"
+  "    ValueError: When ``data`` is not valid base64. In that case,\n"
+  "        the position of the cursor is left unchanged, but the\n"
+  "        buffer may have been partially overwritten.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(bytearray(4))\n"
+  "    >>> cursor.write_b64decode(b'YWJj')\n"
+  "    3\n"
+  "    >>> cursor.getvalue()\n"
+  "    bytearray(b'abc\\x00')\n"
+  "\n"
+);
+
+static inline PyObject*
+iocursor_cursor_Cursor_write_b64decode_impl(cursor* self, Py_buffer* data)
+{
+    Py_ssize_t length;
+
+    /* Check the cursor is still writable */
+    if (check_closed(self))
+        return NULL;
+    if (check_writable(self))
+        return NULL;
+
+    /* Check the input is valid and get the size of the decoded data */
+    length = _b64_decoded_length(data->buf, data->len);
+    if (length < 0) {
+        PyErr_SetString(PyExc_ValueError, "invalid base64 data length");
+        return NULL;
+    }
+
+    /* No-op if there are no bytes to write */
+    if (length > 0) {
+        /* Check the buffer is large enough to hold the decoded data */
+        if (check_space(self, length))
+            return NULL;
+        if (cursor_save(self, self->offset, length) < 0)
+            return NULL;
+        /* Decode data straight into the buffer */
+        if (!_b64_decode(&((unsigned char*) self->buffer.buf)[self->offset], data->buf, data->len)) {
+            PyErr_SetString(PyExc_ValueError, "invalid base64 data");
+            return NULL;
+        }
+        self->offset += length;
+    }
+
+    cursor_record(self, CURSOR_OP_WRITE, self->offset - length, length);
+    return PyLong_FromSsize_t(length);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_write_b64decode(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    Py_buffer data;
+    PyObject *return_value = NULL;
+    cursor* crs            = (cursor*) self;
+
+    static char* keywords[] = {"data", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "s*", keywords, &data)) {
+        return_value = iocursor_cursor_Cursor_write_b64decode_impl(crs, &data);
+        PyBuffer_Release(&data);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_write_hexdecode___doc__,
+  "write_hexdecode(self, data, /)\n"
+  "--\n"
+  "\n"
+  "Decode the given hexadecimal data and write it to the buffer.\n"
+  "\n"
+  "The decoding is done directly into the cursor buffer, without\n"
+  "allocating an intermediate `bytes` object. Both lowercase and\n"
+  "uppercase digits are accepted, but whitespace is not.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of bytes written.\n"
+  "\n"
+  "Raises:\n"
+  "    ValueError: When ``data`` is not valid hexadecimal. In that\n"
+  "        case, the position of the cursor is left unchanged, but\n"
+  "        the buffer may have been partially overwritten.\n"
+  "\n"
+  "Example:\n"
+  "    >>> cursor = Cursor(bytearray(4))\n"
+  "    >>> cursor.write_hexdecode('616263')\n"
+  "    3\n"
+  "    >>> cursor.getvalue()\n"
+  "    bytearray(b'abc\\x00')\n"
+  "\n"
+);
+
+static inline PyObject*
+iocursor_cursor_Cursor_write_hexdecode_impl(cursor* self, Py_buffer* data)
+{
+    Py_ssize_t length = data->len / 2;
+
+    /* Check the cursor is still writable */
+    if (check_closed(self))
+        return NULL;
+    if (check_writable(self))
+        return NULL;
+
+    /* Check the input has an even number of digits */
+    if (data->len % 2 != 0) {
+        PyErr_SetString(PyExc_ValueError, "odd-length hexadecimal data");
+        return NULL;
+    }
+
+    /* No-op if there are no bytes to write */
+    if (length > 0) {
+        /* Check the buffer is large enough to hold the decoded data */
+        if (check_space(self, length))
+            return NULL;
+        if (cursor_save(self, self->offset, length) < 0)
+            return NULL;
+        /* Decode data straight into the buffer */
+        if (!_hex_decode(&((unsigned char*) self->buffer.buf)[self->offset], data->buf, data->len)) {
+            PyErr_SetString(PyExc_ValueError, "invalid hexadecimal data");
+            return NULL;
+        }
+        self->offset += length;
+    }
+
+    cursor_record(self, CURSOR_OP_WRITE, self->offset - length, length);
+    return PyLong_FromSsize_t(length);
+}
+
+static PyObject*
+iocursor_cursor_Cursor_write_hexdecode(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    Py_buffer data;
+    PyObject *return_value = NULL;
+    cursor* crs            = (cursor*) self;
+
+    static char* keywords[] = {"data", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "s*", keywords, &data)) {
+        return_value = iocursor_cursor_Cursor_write_hexdecode_impl(crs, &data);
+        PyBuffer_Release(&data);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_writelines___doc__,
+  "writelines(self, lines, /)\n"
+  "--\n"
+  "\n"
+  "Write a list of lines to the buffer.\n"
+  "\n"
+);
+
+static inline PyObject*
+iocursor_cursor_Cursor_writelines_impl(cursor* self, PyObject* it)
+{
+    PyObject*  item;
+    Py_buffer  line;
+    Py_ssize_t total = 0;
+
+    /* Check the cursor is still writable */
+    if (check_closed(self))
+        return NULL;
+    if (check_writable(self))
+        return NULL;
+
+    while ((item = PyIter_Next(it))) {
+        /* Extract the item to a buffer */
+        if (PyObject_GetBuffer(item, &line, PyBUF_SIMPLE) < 0) {
+            Py_DECREF(item);
+            return NULL;
+        }
+
+        /* Check we can write the entirety of the line to the buffer */
+        if (check_space(self, line.len) || cursor_save(self, self->offset, line.len) < 0) {
+            PyBuffer_Release(&line);
+            Py_DECREF(item);
+            return NULL;
+        }
+
+        /* Write the line to the buffer */
+        memcpy(&((char*) self->buffer.buf)[self->offset], line.buf, line.len);
+        self->offset += line.len;
+        total += line.len;
+
+        /* release buffer and reference when done */
+        PyBuffer_Release(&line);
+        Py_DECREF(item);
+    }
+
+    if (PyErr_Occurred())
+        return NULL;
+
+    cursor_record(self, CURSOR_OP_WRITELINES, self->offset - total, total);
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+iocursor_cursor_Cursor_writelines(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject* it;
+    PyObject* return_value = NULL;
+    cursor*   crs          = (cursor*) self;
+
+    static char* keywords[] = {"b", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "O&", keywords, &_convert_iter, &it)) {
+        return_value = iocursor_cursor_Cursor_writelines_impl(crs, it);
+        Py_DECREF(it);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_zero___doc__,
+  "zero(self, n)\n"
+  "--\n"
+  "\n"
+  "Write ``n`` null bytes to the buffer.\n"
+  "\n"
+  "This is equivalent to ``cursor.write(bytes(n))``, without the\n"
+  "allocation of a temporary `bytes` object.\n"
+  "\n"
+  "Arguments:\n"
+  "    n (int): The number of bytes to write.\n"
+  "\n"
+  "Returns:\n"
+  "    int: The number of bytes written.\n"
+  "\n"
+  "Raises:\n"
+  "    BufferError: When the buffer is too small to fit ``n`` bytes\n"
+  "        at the current position.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_Cursor_zero(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    assert(Py_TYPE(self) == &PyCursor_Type);
+
+    PyObject*  return_value = NULL;
+    cursor*    crs          = (cursor*) self;
+    Py_ssize_t n;
+
+    static char* keywords[] = {"n", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "n", keywords, &n)) {
+        return_value = cursor_fill(crs, 0, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+/* A freelist of deallocated `Cursor` objects, reused by `Cursor.__new__`
+   to avoid a round-trip through the GC allocator for each new cursor. It
+   relies on CPython object layout, and on the GIL for synchronisation. */
+#if defined(CPYTHON) && !defined(Py_GIL_DISABLED)
+#define CURSOR_FREELIST
+#define CURSOR_FREELIST_SIZE 64
+static cursor* cursor_freelist[CURSOR_FREELIST_SIZE];
+static int     cursor_freelist_length = 0;
+#endif
+
+static void
+cursor_freelist_clear(void)
+{
+#ifdef CURSOR_FREELIST
+    while (cursor_freelist_length > 0)
+        PyObject_GC_Del(cursor_freelist[--cursor_freelist_length]);
+#endif
+}
+
+static PyObject *
+iocursor_cursor_Cursor___new__(PyTypeObject* type, PyObject* args, PyObject* kwds)
+{
+    cursor *self;
+
+#ifdef CURSOR_FREELIST
+    if (type == &PyCursor_Type && cursor_freelist_length > 0) {
+        self = cursor_freelist[--cursor_freelist_length];
+        memset(&self->closed, 0, sizeof(cursor) - offsetof(cursor, closed));
+        (void) PyObject_INIT(self, type);
+        PyObject_GC_Track(self);
+    } else
+#endif
+    {
+        assert(type != NULL && type->tp_alloc != NULL);
+        self = (cursor*) type->tp_alloc(type, 0);
+        if (self == NULL)
+            return NULL;
+    }
+
+    self->buffer.obj = NULL;
+    self->readonly = false;
+    self->copy_on_write = false;
+    self->closed = false;
+    self->offset = 0;
+    self->source = NULL;
+    self->stats = NULL;
+    self->trace = NULL;
+    self->undo = NULL;
+    self->exports = 0;
+    self->view_start = 0;
+    self->view_length = -1;
+    self->reserved = false;
+    self->reserve_offset = 0;
+    self->reserve_size = 0;
+    self->memory = NULL;
+    self->memory_size = 0;
+    self->registered = false;
+    self->registry_traceback = NULL;
+    self->registry_prev = NULL;
+    self->registry_next = NULL;
+
+    return (PyObject *)self;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor___init____doc__,
+  "\n"
+  "A buffered I/O implementation wrapping a bytes buffer.\n"
+  "\n"
+  "Arguments:\n"
+  "    buffer (object): An object implementing the buffer protocol.\n"
+  "    readonly (bool): Pass `True` to force the cursor in read-only\n"
+  "        mode, even if the buffer is writable.\n"
+  "    copy_on_write (bool): Pass `True` to make the cursor writable\n"
+  "        without ever modifying the buffer, even if it is immutable:\n"
+  "        the buffer is copied to a private `bytearray` on the first\n"
+  "        write, which `Cursor.getvalue` then returns.\n"
+  "    stats (bool): Pass `True` to record I/O statistics about the\n"
+  "        operations performed with this cursor, which can then be\n"
+  "        retrieved with the `Cursor.stats` method.\n"
+  "    trace (bool): Pass `True` to record the sequence of operations\n"
+  "        performed with this cursor, which can then be retrieved\n"
+  "        with the `Cursor.trace` method.\n"
+  "\n"
+);
+
+static inline int
+iocursor_cursor_Cursor___init___impl(cursor* self, PyObject* source, bool readonly, bool copy_on_write, bool stats, bool trace)
+{
+    cursor_stats* new_stats = NULL;
+    cursor_trace* new_trace = NULL;
+
+    /* Allocate the I/O statistics and the access trace if they were
+       requested, but only replace the current ones once the cursor is
+       bound, so that they are kept if binding fails */
+    if (stats && (new_stats = PyMem_Calloc(1, sizeof(cursor_stats))) == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (trace && (new_trace = PyMem_Calloc(1, sizeof(cursor_trace))) == NULL) {
+        PyMem_Free(new_stats);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    if (cursor_bind(self, source, readonly, copy_on_write) < 0) {
+        PyMem_Free(new_stats);
+        trace_free(new_trace);
+        return -1;
+    }
+
+    PyMem_Free(self->stats);
+    self->stats = new_stats;
+    trace_free(self->trace);
+    self->trace = new_trace;
+    undo_clear(self->undo);
+    return 0;
+}
+
+static int
+iocursor_cursor_Cursor___init__(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    int return_value = -1;
+    static char* keywords[] = {"buffer", "readonly", "stats", "trace", "copy_on_write", NULL};
+
+    PyObject* source        = NULL;
+    int       readonly      = false;
+    int       stats         = false;
+    int       trace         = false;
+    int       copy_on_write = false;
+
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "O|pppp", keywords, &source, &readonly, &stats, &trace, &copy_on_write)) {
+        return_value = iocursor_cursor_Cursor___init___impl(
+            (cursor*) self,
+            source,
+            (bool) readonly,
+            (bool) copy_on_write,
+            (bool) stats,
+            (bool) trace
+        );
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor___enter_____doc__,
+  "__enter__(self)\n"
+  "--\n"
+  "\n"
+  ""
+);
+
+static PyObject*
+iocursor_cursor_Cursor___enter___impl(cursor* self)
+{
+    Py_INCREF(self);
+    return (PyObject*) self;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor___exit_____doc__,
+  "__exit__(self, exc_type, exc_value, traceback)\n"
+  "--\n"
+  "\n"
+  ""
+);
+
+static PyObject*
+iocursor_cursor_Cursor___exit___impl(cursor* self, PyObject* exc_type, PyObject* exc_value, PyObject* traceback)
+{
+    if (iocursor_cursor_Cursor_close_impl(self) == NULL)
+        return NULL;
+    Py_RETURN_FALSE;
+}
+
+static PyObject*
+iocursor_cursor_Cursor___exit__(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+
+    PyObject*    return_value = NULL;
+    static char* keywords[]   = {"exc_type", "exc_value", "traceback", NULL};
+
+    PyObject* exc_type  = Py_None;
+    PyObject* exc_value = Py_None;
+    PyObject* traceback = Py_None;
+
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|OOO", keywords, &exc_type, &exc_value, &traceback)) {
+        return_value = iocursor_cursor_Cursor___exit___impl(
+            (cursor*) self,
+            exc_type,
+            exc_value,
+            traceback
+        );
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+static PyObject*
+iocursor_cursor_Cursor___next___impl(cursor* self)
+{
+    if (self->offset >= self->buffer.len)
+        return NULL;
+    return iocursor_cursor_Cursor_readline_impl(self, -1);
+}
+
+// --------------------------------------------------------------------------
+
+static PyObject*
+iocursor_cursor_Cursor___repr___impl(cursor* self)
+{
+    if (self->memory != NULL)
+        return PyUnicode_FromFormat("Cursor.allocate(%zd)", self->buffer.len);
+    if (self->copy_on_write)
+        return PyUnicode_FromFormat("Cursor(\%R, copy_on_write=True)", self->source);
+    if (self->readonly && !self->buffer.readonly)
+        return PyUnicode_FromFormat("Cursor(\%R, readonly=True)", self->source);
+    else
+        return PyUnicode_FromFormat("Cursor(\%R)", self->source);
+}
+
+// --------------------------------------------------------------------------
+
+static int
+cursor_getbuffer(cursor* self, Py_buffer* view, int flags)
+{
+    Py_ssize_t length = (self->view_length < 0) ? self->buffer.len : self->view_length;
+
+    if (check_closed(self)) {
+        view->obj = NULL;
+        return -1;
+    }
+    if ((flags & PyBUF_WRITABLE) && self->copy_on_write && cursor_materialize(self) < 0) {
+        view->obj = NULL;
+        return -1;
+    }
+
+    char* start = &((char*) self->buffer.buf)[self->view_start];
+    if (PyBuffer_FillInfo(view, (PyObject*) self, start, length, self->readonly, flags) < 0)
+        return -1;
+
+    self->exports++;
+    return 0;
+}
+
+static void
+cursor_releasebuffer(cursor* self, Py_buffer* view)
+{
+    self->exports--;
+}
+
+// --------------------------------------------------------------------------
+
+static int
+cursor_clear(cursor *self)
+{
+    Py_CLEAR(self->source);
+    return 0;
+}
+
+static void
+cursor_dealloc(cursor *self)
+{
+    if (!self->closed) {
+        self->closed = true;
+        PyBuffer_Release(&self->buffer);
+    }
+    registry_remove(self);
+    cursor_free_memory(self);
+    PyObject_GC_UnTrack(self);
+    Py_CLEAR(self->source);
+    PyMem_Free(self->stats);
+    trace_free(self->trace);
+    undo_free(self->undo);
+#ifdef CURSOR_FREELIST
+    if (Py_TYPE(self) == &PyCursor_Type && cursor_freelist_length < CURSOR_FREELIST_SIZE) {
+        cursor_freelist[cursor_freelist_length++] = self;
+        return;
+    }
+#endif
+    Py_TYPE(self)->tp_free(self);
+}
+
+static int
+cursor_traverse(cursor* self, visitproc visit, void* arg)
+{
+    Py_VISIT(self->source);
+    return 0;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Cursor_closed___doc__,
+  "closed: `True` if the stream has been closed.\n"
+  "\n"
+);
+
+static struct PyMemberDef cursor_members[] = {
+    {"closed",   T_BOOL, offsetof(cursor, closed), READONLY, iocursor_cursor_Cursor_closed___doc__},
+    {NULL}  /* Sentinel */
+};
+
+static PyBufferProcs cursor_as_buffer = {
+    .bf_getbuffer     = (getbufferproc) cursor_getbuffer,
+    .bf_releasebuffer = (releasebufferproc) cursor_releasebuffer,
+};
+
+static struct PyMethodDef cursor_methods[] = {
+    {"__enter__",       (PyCFunction)                          iocursor_cursor_Cursor___enter___impl,  METH_NOARGS,                               iocursor_cursor_Cursor___enter_____doc__},
+    {"__exit__",        (PyCFunction)                          iocursor_cursor_Cursor___exit__,        METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor___exit_____doc__},
+    {"allocate",        (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_allocate,        METH_CLASS | METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor_allocate___doc__},
+    {"bisect",          (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_bisect,          METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_bisect___doc__},
+    {"bisect_many",     (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_bisect_many,     METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_bisect_many___doc__},
+    {"bits",            (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_bits,            METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_bits___doc__},
+    {"checkpoint",      (PyCFunction)                          iocursor_cursor_Cursor_checkpoint_impl, METH_NOARGS,                               iocursor_cursor_Cursor_checkpoint___doc__},
+    {"close",           (PyCFunction)                          iocursor_cursor_Cursor_close_impl,      METH_NOARGS,                               iocursor_cursor_Cursor_close___doc__},
+    {"commit",          (PyCFunction)                          iocursor_cursor_Cursor_commit_impl,     METH_NOARGS,                               iocursor_cursor_Cursor_commit___doc__},
+    {"commit_reserved", (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_commit_reserved, METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_commit_reserved___doc__},
+    {"copy_within",     (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_copy_within,     METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_copy_within___doc__},
+    {"count",           (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_count,           METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_count___doc__},
+    {"detach",          (PyCFunction)                          iocursor_cursor_Cursor_detach_impl,     METH_NOARGS,                               iocursor_cursor_Cursor_detach___doc__},
+    {"expect",          (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_expect,          METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_expect___doc__},
+    {"fileno",          (PyCFunction)                          iocursor_cursor_Cursor_fileno_impl,     METH_NOARGS,                               iocursor_cursor_Cursor_fileno___doc__},
+    {"fill",            (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_fill,            METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_fill___doc__},
+    {"find",            (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_find,            METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_find___doc__},
+    {"find_any",        (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_find_any,        METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_find_any___doc__},
+    {"flush",           (PyCFunction)                          iocursor_cursor_Cursor_flush_impl,      METH_NOARGS,                               iocursor_cursor_Cursor_flush___doc__},
+    {"getbuffer",       (PyCFunction)                          iocursor_cursor_Cursor_getbuffer_impl,  METH_NOARGS,                               iocursor_cursor_Cursor_getbuffer___doc__},
+    {"getvalue",        (PyCFunction)                          iocursor_cursor_Cursor_getvalue_impl,   METH_NOARGS,                               iocursor_cursor_Cursor_getvalue___doc__},
+    {"isatty",          (PyCFunction)                          iocursor_cursor_Cursor_isatty_impl,     METH_NOARGS,                               iocursor_cursor_Cursor_isatty___doc__},
+    {"iter_frames",     (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_iter_frames,     METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_iter_frames___doc__},
+    {"iter_records",    (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_iter_records,    METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_iter_records___doc__},
+    {"mark",            (PyCFunction)                          iocursor_cursor_Cursor_mark_impl,       METH_NOARGS,                               iocursor_cursor_Cursor_mark___doc__},
+    {"peek",            (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_peek,            METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_peek___doc__},
+    {"read",            (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_read,            METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_read___doc__},
+    {"read1",           (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_read,            METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_read1___doc__},
+    {"read_array",      (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_read_array,      METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_read_array___doc__},
+    {"read_b64encode",  (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_read_b64encode,  METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_read_b64encode___doc__},
+    {"read_fields",     (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_read_fields,     METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_read_fields___doc__},
+    {"read_many",       (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_read_many,       METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_read_many___doc__},
+    {"read_view",       (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_read_view,       METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_read_view___doc__},
+    {"readable",        (PyCFunction)                          iocursor_cursor_Cursor_readable_impl,   METH_NOARGS,                               iocursor_cursor_Cursor_readable___doc__},
+    {"readinto",        (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_readinto,        METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_readinto___doc__},
+    {"readinto1",       (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_readinto,        METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_readinto1___doc__},
+    {"readinto_array",  (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_readinto_array,  METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_readinto_array___doc__},
+    {"readline",        (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_readline,        METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_readline___doc__},
+    {"readlines",       (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_readlines,       METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_readlines___doc__},
+    {"rebind",          (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_rebind,          METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_rebind___doc__},
+    {"recv_from",       (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_recv_from,       METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_recv_from___doc__},
+    {"reserve",         (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_reserve,         METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_reserve___doc__},
+    {"rfind",           (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_rfind,           METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_rfind___doc__},
+    {"rollback",        (PyCFunction)                          iocursor_cursor_Cursor_rollback_impl,   METH_NOARGS,                               iocursor_cursor_Cursor_rollback___doc__},
+    {"seek",            (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_seek,            METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_seek___doc__},
+    {"seek_to",         (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_seek_to,         METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_seek_to___doc__},
+    {"seekable",        (PyCFunction)                          iocursor_cursor_Cursor_seekable_impl,   METH_NOARGS,                               iocursor_cursor_Cursor_seekable___doc__},
+    {"send_to",         (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_send_to,         METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_send_to___doc__},
+    {"skip",            (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_skip,            METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_skip___doc__},
+    {"split_aligned",   (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_split_aligned,   METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_split_aligned___doc__},
+    {"stats",           (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_stats,           METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_stats___doc__},
+    {"tell",            (PyCFunction)                          iocursor_cursor_Cursor_tell_impl,       METH_NOARGS,                               iocursor_cursor_Cursor_tell___doc__},
+    {"text",            (PyCFunction)                          iocursor_cursor_Cursor_text_impl,       METH_NOARGS,                               iocursor_cursor_Cursor_text___doc__},
+    {"trace",           (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_trace,           METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_trace___doc__},
+    {"truncate",        (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_truncate,        METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_truncate___doc__},
+    {"writable",        (PyCFunction)                          iocursor_cursor_Cursor_writable_impl,   METH_NOARGS,                               iocursor_cursor_Cursor_writable___doc__},
+    {"write",           (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_write,           METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_write___doc__},
+    {"write_at",        (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_write_at,        METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_write_at___doc__},
+    {"write_b64decode", (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_write_b64decode, METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_write_b64decode___doc__},
+    {"write_hexdecode", (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_write_hexdecode, METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_write_hexdecode___doc__},
+    {"writelines",      (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_writelines,      METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_writelines___doc__},
+    {"zero",            (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_zero,            METH_VARARGS | METH_KEYWORDS,              iocursor_cursor_Cursor_zero___doc__},
+    {NULL, NULL}  /* sentinel */
+};
+
+PyTypeObject PyCursor_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "iocursor.cursor.Cursor",
+    .tp_basicsize = sizeof(cursor),
+    .tp_dealloc   = (destructor) cursor_dealloc,
+    .tp_repr      = (reprfunc) iocursor_cursor_Cursor___repr___impl,
+    .tp_as_buffer = &cursor_as_buffer,
+    .tp_flags     = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,
+    .tp_doc       = iocursor_cursor_Cursor___init____doc__,
+    .tp_traverse  = (traverseproc) cursor_traverse,
+    .tp_clear     = (inquiry) cursor_clear,
+    .tp_iter      = PyObject_SelfIter,
+    .tp_iternext  = (iternextfunc) iocursor_cursor_Cursor___next___impl,
+    .tp_methods   = cursor_methods,
+    .tp_members   = cursor_members,
+    .tp_init      = iocursor_cursor_Cursor___init__,
+    .tp_new       = iocursor_cursor_Cursor___new__,
+};
+
+// --- BitCursor -------------------------------------------------------------
+
+/* Get a mask of the `n` lowest bits, for `n` in [0, 64] */
+static inline uint64_t
+_bits_mask(int n)
+{
+    return (n >= 64) ? UINT64_MAX : (((uint64_t) 1) << n) - 1;
+}
+
+/* Get the current position of the bit cursor, in bits */
+static long long
+_bits_tell(bit_cursor* self)
+{
+    long long position = ((long long) self->cursor->offset) * 8;
+
+    switch (self->mode) {
+        case BIT_MODE_READ:
+            return position - self->count;
+        case BIT_MODE_WRITE:
+            return position + self->count;
+        default:
+            return position + self->bit;
+    }
+}
+
+/* Get the number of bits available for reading or writing after the
+   current position */
+static long long
+_bits_remaining(bit_cursor* self)
+{
+    long long total = ((long long) self->cursor->buffer.len) * 8;
+    long long position = _bits_tell(self);
+    return (position < total) ? total - position : 0;
+}
+
+/* Load whole bytes from the buffer into the register, until it holds more
+   than 56 bits or the end of the buffer is reached */
+static inline void
+_bits_refill(bit_cursor* self)
+{
+    const unsigned char* data = (const unsigned char*) self->cursor->buffer.buf;
+    Py_ssize_t           len  = self->cursor->buffer.len;
+
+    while (self->count <= 56 && self->cursor->offset < len) {
+        if (self->lsb)
+            self->reg |= ((uint64_t) data[self->cursor->offset]) << self->count;
+        else
+            self->reg = (self->reg << 8) | data[self->cursor->offset];
+        self->cursor->offset++;
+        self->count += 8;
+    }
+}
+
+/* Store the whole bytes pending in the register to the buffer */
+static int
+_bits_flush(bit_cursor* self)
+{
+    unsigned char* data = (unsigned char*) self->cursor->buffer.buf;
+
+    if (self->count >= 8 && check_space(self->cursor, self->count / 8))
+        return -1;
+    if (cursor_save(self->cursor, self->cursor->offset, self->count / 8) < 0)
+        return -1;
+    while (self->count >= 8) {
+        if (self->lsb) {
+            data[self->cursor->offset] = (unsigned char) (self->reg & 0xFF);
+            self->reg >>= 8;
+        } else {
+            data[self->cursor->offset] = (unsigned char) (self->reg >> (self->count - 8));
+        }
+        self->cursor->offset++;
+        self->count -= 8;
+    }
+
+    return 0;
+}
+
+/* Release the register, storing pending bits to the buffer, so that the
+   cursor offset and `bit` hold the current position */
+static int
+_bits_sync(bit_cursor* self)
+{
+    unsigned char* data = (unsigned char*) self->cursor->buffer.buf;
+    unsigned char  mask;
+
+    if (self->mode == BIT_MODE_READ) {
+        self->cursor->offset -= (self->count + 7) / 8;
+        self->bit = (8 - self->count % 8) % 8;
+    } else if (self->mode == BIT_MODE_WRITE) {
+        if (_bits_flush(self) < 0)
+            return -1;
+        /* Merge the trailing bits with the ones already in the buffer */
+        if (self->count > 0) {
+            if (check_space(self->cursor, 1) || cursor_save(self->cursor, self->cursor->offset, 1) < 0)
+                return -1;
+            if (self->lsb) {
+                mask = (unsigned char) _bits_mask(self->count);
+                data[self->cursor->offset] = (data[self->cursor->offset] & ~mask) | (self->reg & mask);
+            } else {
+                mask = (unsigned char) (0xFF >> self->count);
+                data[self->cursor->offset] = (data[self->cursor->offset] & mask) | (unsigned char) (self->reg << (8 - self->count));
+            }
+        }
+        self->bit = self->count;
+    }
+
+    self->mode = BIT_MODE_SYNCED;
+    self->reg = 0;
+    self->count = 0;
+    return 0;
+}
+
+/* Move the bit cursor to an absolute bit position */
+static int
+_bits_seek(bit_cursor* self, long long position)
+{
+    if (_bits_sync(self) < 0)
+        return -1;
+    self->cursor->offset = (Py_ssize_t) (position / 8);
+    self->bit = (int) (position % 8);
+    return 0;
+}
+
+/* Prepare the register for reading, loading the current byte if the
+   cursor is in the middle of it */
+static int
+_bits_start_read(bit_cursor* self)
+{
+    const unsigned char* data = (const unsigned char*) self->cursor->buffer.buf;
+
+    if (self->mode == BIT_MODE_READ)
+        return 0;
+    if (_bits_sync(self) < 0)
+        return -1;
+
+    self->mode = BIT_MODE_READ;
+    if (self->bit > 0) {
+        if (check_available(self->cursor, 1))
+            return -1;
+        if (self->lsb)
+            self->reg = data[self->cursor->offset] >> self->bit;
+        else
+            self->reg = data[self->cursor->offset];
+        self->count = 8 - self->bit;
+        self->cursor->offset++;
+        self->bit = 0;
+    }
+
+    return 0;
+}
+
+/* Prepare the register for writing, keeping the bits of the current byte
+   before the cursor if it is in the middle of it */
+static int
+_bits_start_write(bit_cursor* self)
+{
+    const unsigned char* data = (const unsigned char*) self->cursor->buffer.buf;
+
+    if (self->mode == BIT_MODE_WRITE)
+        return 0;
+    if (_bits_sync(self) < 0)
+        return -1;
+
+    self->mode = BIT_MODE_WRITE;
+    if (self->bit > 0) {
+        if (check_space(self->cursor, 1))
+            return -1;
+        if (self->lsb)
+            self->reg = data[self->cursor->offset] & _bits_mask(self->bit);
+        else
+            self->reg = data[self->cursor->offset] >> (8 - self->bit);
+        self->count = self->bit;
+        self->bit = 0;
+    }
+
+    return 0;
+}
+
+/* Consume `n` bits from the register, with `n` in [1, 56] or the register
+   already holding at least `n` bits */
+static inline uint64_t
+_bits_take(bit_cursor* self, int n)
+{
+    uint64_t value;
+
+    if (self->count < n)
+        _bits_refill(self);
+    if (self->lsb) {
+        value = self->reg & _bits_mask(n);
+        self->reg = (n < 64) ? self->reg >> n : 0;
+    } else {
+        value = (self->reg >> (self->count - n)) & _bits_mask(n);
+    }
+    self->count -= n;
+
+    return value;
+}
+
+/* Read `n` bits, with `n` in [1, 64], after checking they are available */
+static inline uint64_t
+_bits_read(bit_cursor* self, int n)
+{
+    uint64_t hi;
+    uint64_t lo;
+
+    if (n <= 56 || self->count >= n)
+        return _bits_take(self, n);
+    if (self->lsb) {
+        lo = _bits_take(self, 32);
+        hi = _bits_take(self, n - 32);
+    } else {
+        hi = _bits_take(self, n - 32);
+        lo = _bits_take(self, 32);
+    }
+    return (hi << 32) | lo;
+}
+
+/* Append `n` bits to the register, with `n` in [1, 56] */
+static inline int
+_bits_put(bit_cursor* self, uint64_t value, int n)
+{
+    if (self->count + n > 64 && _bits_flush(self) < 0)
+        return -1;
+    if (self->lsb)
+        self->reg |= value << self->count;
+    else
+        self->reg = (self->reg << n) | value;
+    self->count += n;
+    return 0;
+}
+
+/* Write `n` bits, with `n` in [1, 64], after checking there is space */
+static inline int
+_bits_write(bit_cursor* self, uint64_t value, int n)
+{
+    if (n <= 56)
+        return _bits_put(self, value, n);
+    if (self->lsb) {
+        if (_bits_put(self, value & _bits_mask(32), 32) < 0)
+            return -1;
+        return _bits_put(self, value >> 32, n - 32);
+    } else {
+        if (_bits_put(self, value >> 32, n - 32) < 0)
+            return -1;
+        return _bits_put(self, value & _bits_mask(32), 32);
+    }
+}
+
+static bool
+check_bit_count(long n)
+{
+    if (n < 0 || n > 64) {
+        PyErr_Format(PyExc_ValueError, "bit count must be between 0 and 64, got %ld", n);
+        return true;
+    }
+    return false;
+}
+
+static bool
+check_bits_available(bit_cursor* self, int n)
+{
+    long long remaining = _bits_remaining(self);
+    if (n > remaining) {
+        PyErr_Format(
+            PyExc_EOFError,
+            "cannot read %i bits from buffer of size %zd at bit position %lld",
+            n,
+            self->cursor->buffer.len,
+            _bits_tell(self)
+        );
+        return true;
+    }
+    return false;
+}
+
+static PyObject*
+iocursor_cursor_BitCursor___new__(PyTypeObject* type, PyObject* args, PyObject* kwds)
+{
+    PyObject*   buffer;
+    const char* order = "msb";
+    bit_cursor* self;
+    cursor*     crs;
+
+    static char* keywords[] = {"buffer", "order", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|s", keywords, &buffer, &order))
+        return NULL;
+    if (strcmp(order, "msb") != 0 && strcmp(order, "lsb") != 0) {
+        PyErr_Format(PyExc_ValueError, "invalid bit order: %s", order);
+        return NULL;
+    }
+
+    if (PyObject_TypeCheck(buffer, &PyCursor_Type)) {
+        crs = (cursor*) buffer;
+        Py_INCREF(crs);
+    } else {
+        crs = (cursor*) PyObject_CallFunctionObjArgs((PyObject*) &PyCursor_Type, buffer, NULL);
+        if (crs == NULL)
+            return NULL;
+    }
+
+    self = (bit_cursor*) type->tp_alloc(type, 0);
+    if (self == NULL) {
+        Py_DECREF(crs);
+        return NULL;
+    }
+    self->cursor = crs;
+    self->reg = 0;
+    self->count = 0;
+    self->bit = 0;
+    self->mode = BIT_MODE_SYNCED;
+    self->lsb = order[0] == 'l';
+
+    return (PyObject*) self;
+}
+
+PyDoc_STRVAR(
+  iocursor_cursor_BitCursor___doc__,
+  "BitCursor(buffer, order='msb')\n"
+  "--\n"
   "\n"
-  "Return ``True`` if the stream can be read from.\n"
+  "A reader and writer of bit-packed data over a buffer.\n"
+  "\n"
+  "Bits are moved between the buffer and a 64-bit register one byte at\n"
+  "a time, so that most calls to `read_bits` and `write_bits` do not\n"
+  "access the buffer memory. As a consequence, the position of the\n"
+  "underlying cursor is only updated, and written bits only stored to\n"
+  "the buffer, after a call to `flush` or `align`, or when leaving the\n"
+  "``with`` block the bit cursor is used in.\n"
+  "\n"
+  "Arguments:\n"
+  "    buffer (object): A `Cursor` to read from or write to, starting\n"
+  "        at its current position, or an object implementing the\n"
+  "        buffer protocol.\n"
+  "    order (str): The order of the bits in each byte: ``'msb'`` to\n"
+  "        read the most significant bit first, as in most codec\n"
+  "        bitstreams, or ``'lsb'`` to read the least significant bit\n"
+  "        first, as in DEFLATE.\n"
+  "\n"
+  "Example:\n"
+  "    >>> bits = BitCursor(b'\\xa5\\xf0')\n"
+  "    >>> bits.read_bits(3), bits.read_bits(5), bits.read_bits(4)\n"
+  "    (5, 5, 15)\n"
+  "    >>> bits.tell()\n"
+  "    12\n"
+  "\n"
+);
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_BitCursor_align___doc__,
+  "align(self)\n"
+  "--\n"
+  "\n"
+  "Move the bit cursor to the start of the next byte, and flush it.\n"
+  "\n"
+  "The remaining bits of the current byte are skipped when reading, or\n"
+  "set to zero when writing. This does nothing if the bit cursor is\n"
+  "already on a byte boundary.\n"
+  "\n"
+  "Raises:\n"
+  "    BufferError: When the padding bits do not fit in the buffer.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_BitCursor_align_impl(bit_cursor* self)
+{
+    int padding;
+
+    if (check_closed(self->cursor))
+        return NULL;
+
+    if (self->mode == BIT_MODE_WRITE) {
+        padding = (8 - self->count % 8) % 8;
+        if (padding > 0 && _bits_put(self, 0, padding) < 0)
+            return NULL;
+    } else if (self->mode == BIT_MODE_READ) {
+        padding = self->count % 8;
+        if (self->lsb)
+            self->reg >>= padding;
+        self->count -= padding;
+    }
+    if (_bits_sync(self) < 0)
+        return NULL;
+    if (self->bit > 0) {
+        self->cursor->offset++;
+        self->bit = 0;
+    }
+
+    Py_RETURN_NONE;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_BitCursor_flush___doc__,
+  "flush(self)\n"
+  "--\n"
+  "\n"
+  "Store pending bits to the buffer and update the cursor position.\n"
+  "\n"
+  "After a flush, the underlying cursor is positioned on the byte\n"
+  "containing the current bit, and a partially written byte is merged\n"
+  "with the bits already in the buffer.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_BitCursor_flush_impl(bit_cursor* self)
+{
+    if (check_closed(self->cursor))
+        return NULL;
+    if (_bits_sync(self) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_BitCursor_peek_bits___doc__,
+  "peek_bits(self, n)\n"
+  "--\n"
+  "\n"
+  "Read ``n`` bits as an unsigned integer without moving the cursor.\n"
+  "\n"
+  "Arguments:\n"
+  "    n (int): The number of bits to read, at most 64.\n"
+  "\n"
+  "Raises:\n"
+  "    EOFError: When less than ``n`` bits remain in the buffer.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_BitCursor_peek_bits_impl(bit_cursor* self, long n)
+{
+    long long position;
+    uint64_t  value;
+
+    if (check_closed(self->cursor) || check_bit_count(n))
+        return NULL;
+    if (n == 0)
+        return PyLong_FromLong(0);
+    if (_bits_start_read(self) < 0 || check_bits_available(self, (int) n))
+        return NULL;
+
+    if (self->count < n)
+        _bits_refill(self);
+    if (self->count >= n) {
+        if (self->lsb)
+            value = self->reg & _bits_mask(n);
+        else
+            value = (self->reg >> (self->count - n)) & _bits_mask(n);
+    } else {
+        /* The register cannot hold more than 57 bits after a refill,
+           so longer reads have to rewind the cursor */
+        position = _bits_tell(self);
+        value = _bits_read(self, (int) n);
+        if (_bits_seek(self, position) < 0)
+            return NULL;
+    }
+
+    return PyLong_FromUnsignedLongLong(value);
+}
+
+static PyObject*
+iocursor_cursor_BitCursor_peek_bits(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* return_value = NULL;
+    long      n;
+
+    static char* keywords[] = {"n", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "l", keywords, &n)) {
+        return_value = iocursor_cursor_BitCursor_peek_bits_impl((bit_cursor*) self, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_BitCursor_read_bits___doc__,
+  "read_bits(self, n)\n"
+  "--\n"
+  "\n"
+  "Read ``n`` bits as an unsigned integer.\n"
+  "\n"
+  "Arguments:\n"
+  "    n (int): The number of bits to read, at most 64.\n"
+  "\n"
+  "Raises:\n"
+  "    EOFError: When less than ``n`` bits remain in the buffer. No\n"
+  "        bits are consumed in this case.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_BitCursor_read_bits_impl(bit_cursor* self, long n)
+{
+    if (check_closed(self->cursor) || check_bit_count(n))
+        return NULL;
+    if (n == 0)
+        return PyLong_FromLong(0);
+    if (_bits_start_read(self) < 0)
+        return NULL;
+    if (self->count < n && check_bits_available(self, (int) n))
+        return NULL;
+    return PyLong_FromUnsignedLongLong(_bits_read(self, (int) n));
+}
+
+static PyObject*
+iocursor_cursor_BitCursor_read_bits(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* return_value = NULL;
+    long      n;
+
+    static char* keywords[] = {"n", NULL};
+    if (kwargs == NULL && PyTuple_GET_SIZE(args) == 1 && PyLong_CheckExact(PyTuple_GET_ITEM(args, 0))) {
+        n = PyLong_AsLong(PyTuple_GET_ITEM(args, 0));
+        if (n == -1 && PyErr_Occurred())
+            return NULL;
+        return_value = iocursor_cursor_BitCursor_read_bits_impl((bit_cursor*) self, n);
+    } else if (PyArg_ParseTupleAndKeywords(args, kwargs, "l", keywords, &n)) {
+        return_value = iocursor_cursor_BitCursor_read_bits_impl((bit_cursor*) self, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_BitCursor_skip_bits___doc__,
+  "skip_bits(self, n)\n"
+  "--\n"
+  "\n"
+  "Move the cursor ``n`` bits forward.\n"
+  "\n"
+  "Arguments:\n"
+  "    n (int): The number of bits to skip. It is not limited to 64.\n"
+  "\n"
+  "Raises:\n"
+  "    EOFError: When less than ``n`` bits remain in the buffer.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_BitCursor_skip_bits_impl(bit_cursor* self, long long n)
+{
+    if (check_closed(self->cursor))
+        return NULL;
+    if (n < 0) {
+        PyErr_Format(PyExc_ValueError, "negative bit count %lld", n);
+        return NULL;
+    }
+
+    if (self->mode == BIT_MODE_READ && n <= self->count) {
+        if (self->lsb)
+            self->reg = (n < 64) ? self->reg >> n : 0;
+        self->count -= (int) n;
+    } else if (n > _bits_remaining(self)) {
+        PyErr_Format(
+            PyExc_EOFError,
+            "cannot skip %lld bits from buffer of size %zd at bit position %lld",
+            n,
+            self->cursor->buffer.len,
+            _bits_tell(self)
+        );
+        return NULL;
+    } else if (_bits_seek(self, _bits_tell(self) + n) < 0) {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+iocursor_cursor_BitCursor_skip_bits(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* return_value = NULL;
+    long long n;
+
+    static char* keywords[] = {"n", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "L", keywords, &n)) {
+        return_value = iocursor_cursor_BitCursor_skip_bits_impl((bit_cursor*) self, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_BitCursor_tell___doc__,
+  "tell(self)\n"
+  "--\n"
+  "\n"
+  "Return the current position, as a number of bits from the start of\n"
+  "the buffer.\n"
+  "\n"
+);
+
+static PyObject*
+iocursor_cursor_BitCursor_tell_impl(bit_cursor* self)
+{
+    if (check_closed(self->cursor))
+        return NULL;
+    return PyLong_FromLongLong(_bits_tell(self));
+}
+
+// --------------------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_BitCursor_write_bits___doc__,
+  "write_bits(self, value, n)\n"
+  "--\n"
+  "\n"
+  "Write the ``n`` lowest bits of an unsigned integer.\n"
+  "\n"
+  "Arguments:\n"
+  "    value (int): The value to write, which must fit in ``n`` bits.\n"
+  "    n (int): The number of bits to write, at most 64.\n"
+  "\n"
+  "Raises:\n"
+  "    ValueError: When ``value`` does not fit in ``n`` bits.\n"
+  "    BufferError: When less than ``n`` bits remain in the buffer.\n"
   "\n"
-  "On `Cursor` instances, this always returns `True`, since the\n"
-  "buffers cannot be opened in write-only mode.\n"
 );
 
 static PyObject*
-iocursor_cursor_Cursor_readable_impl(cursor* self)
+iocursor_cursor_BitCursor_write_bits_impl(bit_cursor* self, PyObject* value, long n)
 {
-    if (check_closed(self))
+    unsigned long long bits;
+    long long          position;
+
+    if (check_closed(self->cursor) || check_writable(self->cursor) || check_bit_count(n))
         return NULL;
-    Py_RETURN_TRUE;
+    /* Pending bits are stored later, so copy the buffer now */
+    if (cursor_make_writable(self->cursor) < 0)
+        return NULL;
+
+    bits = PyLong_AsUnsignedLongLong(value);
+    if (bits == (unsigned long long) -1 && PyErr_Occurred())
+        return NULL;
+    if (n < 64 && (bits >> n) != 0) {
+        PyErr_Format(PyExc_ValueError, "value %R does not fit in %ld bits", value, n);
+        return NULL;
+    }
+    if (n == 0)
+        Py_RETURN_NONE;
+
+    if (_bits_start_write(self) < 0)
+        return NULL;
+    if (n > _bits_remaining(self)) {
+        position = _bits_tell(self);
+        PyErr_Format(
+            PyExc_BufferError,
+            "cannot write %ld bits to buffer of size %zd at bit position %lld",
+            n,
+            self->cursor->buffer.len,
+            position
+        );
+        return NULL;
+    }
+    if (_bits_write(self, bits, (int) n) < 0)
+        return NULL;
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+iocursor_cursor_BitCursor_write_bits(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    PyObject* return_value = NULL;
+    PyObject* value;
+    long      n;
+
+    static char* keywords[] = {"value", "n", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "O!l", keywords, &PyLong_Type, &value, &n)) {
+        return_value = iocursor_cursor_BitCursor_write_bits_impl((bit_cursor*) self, value, n);
+    }
+
+    return return_value;
+}
+
+// --------------------------------------------------------------------------
+
+static PyObject*
+iocursor_cursor_BitCursor___enter___impl(bit_cursor* self)
+{
+    if (check_closed(self->cursor))
+        return NULL;
+    Py_INCREF(self);
+    return (PyObject*) self;
+}
+
+static PyObject*
+iocursor_cursor_BitCursor___exit__(bit_cursor* self, PyObject* args)
+{
+    return iocursor_cursor_BitCursor_align_impl(self);
+}
+
+static PyObject*
+iocursor_cursor_BitCursor_order_get(bit_cursor* self, void* closure)
+{
+    return PyUnicode_FromString(self->lsb ? "lsb" : "msb");
+}
+
+static PyObject*
+iocursor_cursor_BitCursor___repr___impl(bit_cursor* self)
+{
+    return PyUnicode_FromFormat("BitCursor(%R, order=%s)", self->cursor, self->lsb ? "'lsb'" : "'msb'");
+}
+
+static int
+bit_cursor_clear(bit_cursor* self)
+{
+    Py_CLEAR(self->cursor);
+    return 0;
+}
+
+static void
+bit_cursor_dealloc(bit_cursor* self)
+{
+    PyObject* type;
+    PyObject* value;
+    PyObject* traceback;
+
+    PyObject_GC_UnTrack(self);
+    /* Store bits pending in the register, like `io.BufferedWriter` does,
+       and give back the bytes prefetched in read mode */
+    if (self->cursor != NULL && !self->cursor->closed && self->mode != BIT_MODE_SYNCED) {
+        PyErr_Fetch(&type, &value, &traceback);
+        if (_bits_sync(self) < 0)
+            PyErr_WriteUnraisable((PyObject*) self);
+        PyErr_Restore(type, value, traceback);
+    }
+    Py_CLEAR(self->cursor);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static int
+bit_cursor_traverse(bit_cursor* self, visitproc visit, void* arg)
+{
+    Py_VISIT(self->cursor);
+    return 0;
 }
 
+static PyMethodDef bit_cursor_methods[] = {
+    {"__enter__",  (PyCFunction)                          iocursor_cursor_BitCursor___enter___impl, METH_NOARGS,                  NULL},
+    {"__exit__",   (PyCFunction)                          iocursor_cursor_BitCursor___exit__,       METH_VARARGS,                 NULL},
+    {"align",      (PyCFunction)                          iocursor_cursor_BitCursor_align_impl,     METH_NOARGS,                  iocursor_cursor_BitCursor_align___doc__},
+    {"flush",      (PyCFunction)                          iocursor_cursor_BitCursor_flush_impl,     METH_NOARGS,                  iocursor_cursor_BitCursor_flush___doc__},
+    {"peek_bits",  (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_BitCursor_peek_bits,      METH_VARARGS | METH_KEYWORDS, iocursor_cursor_BitCursor_peek_bits___doc__},
+    {"read_bits",  (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_BitCursor_read_bits,      METH_VARARGS | METH_KEYWORDS, iocursor_cursor_BitCursor_read_bits___doc__},
+    {"skip_bits",  (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_BitCursor_skip_bits,      METH_VARARGS | METH_KEYWORDS, iocursor_cursor_BitCursor_skip_bits___doc__},
+    {"tell",       (PyCFunction)                          iocursor_cursor_BitCursor_tell_impl,      METH_NOARGS,                  iocursor_cursor_BitCursor_tell___doc__},
+    {"write_bits", (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_BitCursor_write_bits,     METH_VARARGS | METH_KEYWORDS, iocursor_cursor_BitCursor_write_bits___doc__},
+    {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+static struct PyMemberDef bit_cursor_members[] = {
+    {"buffer", T_OBJECT, offsetof(bit_cursor, cursor), READONLY, "The `Cursor` the bits are read from or written to."},
+    {NULL}  /* Sentinel */
+};
+
+static PyGetSetDef bit_cursor_getset[] = {
+    {"order", (getter) iocursor_cursor_BitCursor_order_get, NULL, "The order of the bits in each byte, ``'msb'`` or ``'lsb'``.", NULL},
+    {NULL}  /* Sentinel */
+};
+
+PyTypeObject PyBitCursor_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "iocursor.cursor.BitCursor",
+    .tp_basicsize = sizeof(bit_cursor),
+    .tp_dealloc   = (destructor) bit_cursor_dealloc,
+    .tp_repr      = (reprfunc) iocursor_cursor_BitCursor___repr___impl,
+    .tp_flags     = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    .tp_doc       = iocursor_cursor_BitCursor___doc__,
+    .tp_traverse  = (traverseproc) bit_cursor_traverse,
+    .tp_clear     = (inquiry) bit_cursor_clear,
+    .tp_methods   = bit_cursor_methods,
+    .tp_members   = bit_cursor_members,
+    .tp_getset    = bit_cursor_getset,
+    .tp_new       = iocursor_cursor_BitCursor___new__,
+};
+
+// --- Checkpoint ------------------------------------------------------------
+
+PyDoc_STRVAR(
+  iocursor_cursor_Checkpoint___doc__,
+  "A checkpoint made with `Cursor.checkpoint`.\n"
+  "\n"
+  "When used as a context manager, the checkpoint is committed when\n"
+  "leaving the ``with`` block normally, and rolled back when leaving\n"
+  "it because of an exception, unless it was already released.\n"
+  "\n"
+);
+
 // --------------------------------------------------------------------------
 
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor_readinto___doc__,
-  "readinto(self, buffer)\n"
+  iocursor_cursor_Checkpoint_commit___doc__,
+  "commit(self)\n"
   "--\n"
   "\n"
-  "Read bytes into the provided buffer.\n"
+  "Release the checkpoint, keeping the changes made since.\n"
   "\n"
-  "Returns:\n"
-  "    int: The number of bytes read, or 0 if the cursor is at EOF.\n"
+  "Raises:\n"
+  "    ValueError: When the checkpoint was already released, or is not\n"
+  "        the innermost active checkpoint of the cursor.\n"
   "\n"
 );
 
+static PyObject*
+iocursor_cursor_Checkpoint_commit_impl(checkpoint* self)
+{
+    if (check_closed(self->cursor) || check_checkpoint(self->cursor, &self->id))
+        return NULL;
+    cursor_commit(self->cursor);
+    Py_RETURN_NONE;
+}
+
+// --------------------------------------------------------------------------
+
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor_readinto1___doc__,
-  "readinto1(self, buffer)\n"
+  iocursor_cursor_Checkpoint_rollback___doc__,
+  "rollback(self)\n"
   "--\n"
   "\n"
-  "Read bytes into the provided buffer with a single syscall.\n"
+  "Release the checkpoint, undoing the changes made since.\n"
   "\n"
-  "Returns:\n"
-  "    int: The number of bytes read, or 0 if the cursor is at EOF.\n"
+  "Raises:\n"
+  "    ValueError: When the checkpoint was already released, or is not\n"
+  "        the innermost active checkpoint of the cursor.\n"
   "\n"
 );
 
-static inline PyObject*
-iocursor_cursor_Cursor_readinto_impl(cursor* self, Py_buffer* buffer)
+static PyObject*
+iocursor_cursor_Checkpoint_rollback_impl(checkpoint* self)
 {
-    Py_ssize_t nbytes = buffer->len;
+    if (check_closed(self->cursor) || check_checkpoint(self->cursor, &self->id))
+        return NULL;
+    cursor_rollback(self->cursor);
+    Py_RETURN_NONE;
+}
 
-    if (check_closed(self))
+// --------------------------------------------------------------------------
+
+/* Check whether the checkpoint is still the innermost active one */
+static bool
+_checkpoint_active(checkpoint* self)
+{
+    cursor_undo* undo = self->cursor->undo;
+    return !self->cursor->closed && undo != NULL && undo->depth > 0 && undo->marks[undo->depth - 1].id == self->id;
+}
+
+static PyObject*
+iocursor_cursor_Checkpoint___enter___impl(checkpoint* self)
+{
+    Py_INCREF(self);
+    return (PyObject*) self;
+}
+
+static PyObject*
+iocursor_cursor_Checkpoint___exit__(checkpoint* self, PyObject* args)
+{
+    PyObject* exc_type  = Py_None;
+    PyObject* exc_value = Py_None;
+    PyObject* traceback = Py_None;
+
+    if (!PyArg_ParseTuple(args, "|OOO", &exc_type, &exc_value, &traceback))
         return NULL;
+    if (_checkpoint_active(self)) {
+        if (exc_type == Py_None)
+            cursor_commit(self->cursor);
+        else
+            cursor_rollback(self->cursor);
+    }
 
-    if (self->offset >= self->buffer.len)
-        nbytes = 0;
-    else if (nbytes > self->buffer.len - self->offset)
-        nbytes = self->buffer.len - self->offset;
+    Py_RETURN_FALSE;
+}
 
-    memcpy(buffer->buf, &((char*) self->buffer.buf)[self->offset], nbytes);
-    self->offset += nbytes;
-    return PyLong_FromSsize_t(nbytes);
+static PyObject*
+iocursor_cursor_Checkpoint_active_get(checkpoint* self, void* closure)
+{
+    return PyBool_FromLong(_checkpoint_active(self));
+}
+
+static PyObject*
+iocursor_cursor_Checkpoint___repr___impl(checkpoint* self)
+{
+    return PyUnicode_FromFormat("<Checkpoint of %R>", self->cursor);
+}
+
+static int
+checkpoint_clear(checkpoint* self)
+{
+    Py_CLEAR(self->cursor);
+    return 0;
+}
+
+static void
+checkpoint_dealloc(checkpoint* self)
+{
+    PyObject_GC_UnTrack(self);
+    Py_CLEAR(self->cursor);
+    PyObject_GC_Del(self);
+}
+
+static int
+checkpoint_traverse(checkpoint* self, visitproc visit, void* arg)
+{
+    Py_VISIT(self->cursor);
+    return 0;
+}
+
+static PyMethodDef checkpoint_methods[] = {
+    {"__enter__", (PyCFunction) iocursor_cursor_Checkpoint___enter___impl, METH_NOARGS,  NULL},
+    {"__exit__",  (PyCFunction) iocursor_cursor_Checkpoint___exit__,       METH_VARARGS, NULL},
+    {"commit",    (PyCFunction) iocursor_cursor_Checkpoint_commit_impl,    METH_NOARGS,  iocursor_cursor_Checkpoint_commit___doc__},
+    {"rollback",  (PyCFunction) iocursor_cursor_Checkpoint_rollback_impl,  METH_NOARGS,  iocursor_cursor_Checkpoint_rollback___doc__},
+    {NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+static struct PyMemberDef checkpoint_members[] = {
+    {"cursor", T_OBJECT, offsetof(checkpoint, cursor), READONLY, "The `Cursor` the checkpoint was made on."},
+    {NULL}  /* Sentinel */
+};
+
+static PyGetSetDef checkpoint_getset[] = {
+    {"active", (getter) iocursor_cursor_Checkpoint_active_get, NULL, "Whether the checkpoint is the innermost active checkpoint.", NULL},
+    {NULL}  /* Sentinel */
+};
+
+PyTypeObject PyCheckpoint_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "iocursor.cursor.Checkpoint",
+    .tp_basicsize = sizeof(checkpoint),
+    .tp_dealloc   = (destructor) checkpoint_dealloc,
+    .tp_repr      = (reprfunc) iocursor_cursor_Checkpoint___repr___impl,
+    .tp_flags     = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    .tp_doc       = iocursor_cursor_Checkpoint___doc__,
+    .tp_traverse  = (traverseproc) checkpoint_traverse,
+    .tp_clear     = (inquiry) checkpoint_clear,
+    .tp_methods   = checkpoint_methods,
+    .tp_members   = checkpoint_members,
+    .tp_getset    = checkpoint_getset,
+};
+
+// --- FrameIterator ---------------------------------------------------------
+
+/* Decode the length prefix of the next frame at `start`, returning the
+   number of bytes used by the prefix, 0 if truncated, or -1 on error */
+static Py_ssize_t
+_frame_decode_prefix(frame_prefix prefix, const unsigned char* start, Py_ssize_t available, unsigned long long* length)
+{
+    Py_ssize_t i;
+    int        shift;
+
+    switch (prefix) {
+        case FRAME_PREFIX_U16LE:
+            if (available < 2)
+                return 0;
+            *length = (unsigned long long) start[0] | ((unsigned long long) start[1] << 8);
+            return 2;
+        case FRAME_PREFIX_U16BE:
+            if (available < 2)
+                return 0;
+            *length = (unsigned long long) start[1] | ((unsigned long long) start[0] << 8);
+            return 2;
+        case FRAME_PREFIX_U32LE:
+            if (available < 4)
+                return 0;
+            *length = (unsigned long long) start[0]
+                    | ((unsigned long long) start[1] << 8)
+                    | ((unsigned long long) start[2] << 16)
+                    | ((unsigned long long) start[3] << 24);
+            return 4;
+        case FRAME_PREFIX_U32BE:
+            if (available < 4)
+                return 0;
+            *length = (unsigned long long) start[3]
+                    | ((unsigned long long) start[2] << 8)
+                    | ((unsigned long long) start[1] << 16)
+                    | ((unsigned long long) start[0] << 24);
+            return 4;
+        case FRAME_PREFIX_VARINT:
+            *length = 0;
+            for (i = 0, shift = 0; i < available; i++, shift += 7) {
+                if (shift > 63 || (shift == 63 && (start[i] & 0x7E))) {
+                    PyErr_SetString(PyExc_ValueError, "varint frame length overflow");
+                    return -1;
+                }
+                *length |= (unsigned long long) (start[i] & 0x7F) << shift;
+                if ((start[i] & 0x80) == 0)
+                    return i + 1;
+            }
+            return 0;
+    }
+
+    assert(0);
+    return -1;
+}
+
+static PyObject*
+iocursor_cursor_FrameIterator___next___impl(frame_iterator* self)
+{
+    Py_ssize_t          available;
+    Py_ssize_t          header;
+    unsigned long long  length;
+    PyObject*           frame;
+    const unsigned char* start;
+    cursor*             crs = self->cursor;
+
+    if (check_closed(crs))
+        return NULL;
+    if (crs->offset >= crs->buffer.len)
+        return NULL;
+
+    start = &((const unsigned char*) crs->buffer.buf)[crs->offset];
+    available = crs->buffer.len - crs->offset;
+
+    header = _frame_decode_prefix(self->prefix, start, available, &length);
+    if (header < 0)
+        return NULL;
+    if ((self->max_size >= 0) && (header > 0) && (length > (unsigned long long) self->max_size)) {
+        PyErr_Format(PyExc_ValueError, "frame of size %llu exceeds maximum size %zd", length, self->max_size);
+        return NULL;
+    }
+    if ((header == 0) || (length > (unsigned long long) (available - header))) {
+        if (self->strict)
+            PyErr_Format(PyExc_ValueError, "truncated frame at position %zd", crs->offset);
+        return NULL;
+    }
+
+    if (self->copy)
+        frame = PyBytes_FromStringAndSize((const char*) &start[header], (Py_ssize_t) length);
+    else
+        frame = cursor_getview(crs, crs->offset + header, (Py_ssize_t) length);
+    if (frame == NULL)
+        return NULL;
+
+    cursor_record(crs, CURSOR_OP_READ, crs->offset, header + (Py_ssize_t) length);
+    crs->offset += header + (Py_ssize_t) length;
+    return frame;
+}
+
+static int
+frame_iterator_clear(frame_iterator* self)
+{
+    Py_CLEAR(self->cursor);
+    return 0;
+}
+
+static void
+frame_iterator_dealloc(frame_iterator* self)
+{
+    PyObject_GC_UnTrack(self);
+    Py_CLEAR(self->cursor);
+    PyObject_GC_Del(self);
+}
+
+static int
+frame_iterator_traverse(frame_iterator* self, visitproc visit, void* arg)
+{
+    Py_VISIT(self->cursor);
+    return 0;
+}
+
+PyTypeObject PyFrameIterator_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "iocursor.cursor.FrameIterator",
+    .tp_basicsize = sizeof(frame_iterator),
+    .tp_dealloc   = (destructor) frame_iterator_dealloc,
+    .tp_flags     = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    .tp_traverse  = (traverseproc) frame_iterator_traverse,
+    .tp_clear     = (inquiry) frame_iterator_clear,
+    .tp_iter      = PyObject_SelfIter,
+    .tp_iternext  = (iternextfunc) iocursor_cursor_FrameIterator___next___impl,
+};
+
+// --- RecordIterator --------------------------------------------------------
+
+static PyObject*
+iocursor_cursor_RecordIterator___next___impl(record_iterator* self)
+{
+    Py_ssize_t length;
+    PyObject*  record;
+    cursor*    crs = self->cursor;
+
+    if (check_closed(crs))
+        return NULL;
+    if (crs->offset >= crs->buffer.len)
+        return NULL;
+
+    length = cursor_line_length(crs, crs->buffer.len - crs->offset, self->line_sep);
+    record = cursor_split_fields(
+        crs,
+        crs->offset,
+        ((char*) crs->buffer.buf)[crs->offset + length - 1] == self->line_sep ? length - 1 : length,
+        self->sep,
+        -1,
+        self->copy,
+        true
+    );
+    if (record == NULL)
+        return NULL;
+
+    cursor_record(crs, CURSOR_OP_READLINE, crs->offset, length);
+    crs->offset += length;
+    return record;
+}
+
+static int
+record_iterator_clear(record_iterator* self)
+{
+    Py_CLEAR(self->cursor);
+    return 0;
+}
+
+static void
+record_iterator_dealloc(record_iterator* self)
+{
+    PyObject_GC_UnTrack(self);
+    Py_CLEAR(self->cursor);
+    PyObject_GC_Del(self);
+}
+
+static int
+record_iterator_traverse(record_iterator* self, visitproc visit, void* arg)
+{
+    Py_VISIT(self->cursor);
+    return 0;
+}
+
+PyTypeObject PyRecordIterator_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "iocursor.cursor.RecordIterator",
+    .tp_basicsize = sizeof(record_iterator),
+    .tp_dealloc   = (destructor) record_iterator_dealloc,
+    .tp_flags     = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    .tp_traverse  = (traverseproc) record_iterator_traverse,
+    .tp_clear     = (inquiry) record_iterator_clear,
+    .tp_iter      = PyObject_SelfIter,
+    .tp_iternext  = (iternextfunc) iocursor_cursor_RecordIterator___next___impl,
+};
+
+// --- TextCursor ------------------------------------------------------------
+
+/* Check whether `len` bytes are all ASCII, testing 8 bytes at a time in a
+   loop simple enough to be vectorized by the compiler */
+static inline bool
+_is_ascii(const unsigned char* data, Py_ssize_t len)
+{
+    Py_ssize_t i;
+    uint64_t   word;
+    uint64_t   acc = 0;
+
+    for (i = 0; i + 8 <= len; i += 8) {
+        memcpy(&word, &data[i], sizeof(word));
+        acc |= word;
+    }
+    for (; i < len; i++)
+        acc |= data[i];
+
+    return (acc & 0x8080808080808080ULL) == 0;
+}
+
+/* Decode the UTF-8 sequence at `data[i]` into `cp`, returning its length,
+   or 0 if it is invalid. The first continuation byte has a narrower range
+   for some lead bytes, to reject overlong encodings and surrogates. */
+static inline Py_ssize_t
+_utf8_next(const unsigned char* data, Py_ssize_t len, Py_ssize_t i, Py_UCS4* cp)
+{
+    Py_ssize_t    k;
+    Py_ssize_t    n;
+    unsigned char c  = data[i];
+    unsigned char lo = 0x80;
+    unsigned char hi = 0xBF;
+
+    if (c < 0x80) {
+        *cp = c;
+        return 1;
+    } else if (c >= 0xC2 && c <= 0xDF) {
+        n = 1;
+    } else if (c == 0xE0) {
+        n = 2;
+        lo = 0xA0;
+    } else if (c == 0xED) {
+        n = 2;
+        hi = 0x9F;
+    } else if (c >= 0xE1 && c <= 0xEF) {
+        n = 2;
+    } else if (c == 0xF0) {
+        n = 3;
+        lo = 0x90;
+    } else if (c >= 0xF1 && c <= 0xF3) {
+        n = 3;
+    } else if (c == 0xF4) {
+        n = 3;
+        hi = 0x8F;
+    } else {
+        return 0;
+    }
+
+    if (len - i - 1 < n || data[i + 1] < lo || data[i + 1] > hi)
+        return 0;
+    *cp = c & (0x3F >> n);
+    for (k = 1; k <= n; k++) {
+        if ((data[i + k] & 0xC0) != 0x80)
+            return 0;
+        *cp = (*cp << 6) | (data[i + k] & 0x3F);
+    }
+
+    return n + 1;
 }
 
-static PyObject*
-iocursor_cursor_Cursor_readinto(PyObject *self, PyObject *args, PyObject *kwargs)
+/* Get the position of the first invalid UTF-8 sequence in `data`, or -1
+   if it is valid. Runs of ASCII are skipped 16 bytes at a time. */
+static Py_ssize_t
+_utf8_validate(const unsigned char* data, Py_ssize_t len)
 {
-    assert(Py_TYPE(self) == &PyCursor_Type);
-
-    Py_buffer buffer;
-    PyObject* return_value = NULL;
-    cursor*   crs            = (cursor*) self;
-
-    static char* keywords[] = {"buffer", NULL};
-    if (PyArg_ParseTupleAndKeywords(args, kwargs, "w*", keywords, &buffer)) {
-        return_value = iocursor_cursor_Cursor_readinto_impl(crs, &buffer);
-        PyBuffer_Release(&buffer);
+    Py_ssize_t i = 0;
+    Py_ssize_t n;
+    Py_UCS4    cp;
+
+    while (i < len) {
+        if (len - i >= 16 && _is_ascii(&data[i], 16)) {
+            i += 16;
+        } else if ((n = _utf8_next(data, len, i, &cp)) > 0) {
+            i += n;
+        } else {
+            return i;
+        }
     }
 
-    return return_value;
+    return -1;
 }
 
-// --------------------------------------------------------------------------
+/* Get the number of bytes used by the first `nchars` characters of the
+   UTF-8 data, skipping runs of ASCII 8 bytes at a time */
+static Py_ssize_t
+_utf8_span(const unsigned char* data, Py_ssize_t len, Py_ssize_t nchars)
+{
+    Py_ssize_t i = 0;
 
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor_readline___doc__,
-  "readline(self, size=-1)\n"
-  "--\n"
-  "\n"
-  "Return the next line from the file, as a bytes object.\n"
-  "\n"
-);
+    while (nchars > 0 && i < len) {
+        if (nchars >= 8 && len - i >= 8 && _is_ascii(&data[i], 8)) {
+            i += 8;
+            nchars -= 8;
+            continue;
+        }
+        i++;
+        while (i < len && (data[i] & 0xC0) == 0x80)
+            i++;
+        nchars--;
+    }
 
-static inline PyObject*
-iocursor_cursor_Cursor_readline_impl(cursor* self, Py_ssize_t size) {
-    if (check_closed(self))
-        return NULL;
+    return i;
+}
 
-    if ((size < 0) || (size >= self->buffer.len - self->offset))
-        size = (self->offset > self->buffer.len) ? 0 : self->buffer.len - self->offset;
-    if (size == 0)
-        return PyBytes_FromStringAndSize(NULL, 0);
+/* Create a `str` from UTF-8 data. Since the buffer was validated when
+   the `TextCursor` was created, the length and kind of the string are
+   obtained from a simple count of the lead bytes, and pure-ASCII data is
+   copied directly. The buffer may have been modified since, so invalid
+   data is still handed to the generic decoder to raise an error. */
+static PyObject*
+_text_decode(const char* data, Py_ssize_t len)
+{
+#ifdef CPYTHON
+    const unsigned char* bytes   = (const unsigned char*) data;
+    Py_ssize_t           i;
+    Py_ssize_t           j;
+    Py_ssize_t           n;
+    Py_ssize_t           nchars  = 0;
+    Py_UCS4              cp;
+    Py_UCS4              maxchar;
+    unsigned char        maxlead = 0;
+    PyObject*            text;
+    int                  kind;
+    void*                out;
+
+    if (_is_ascii(bytes, len)) {
+        if ((text = PyUnicode_New(len, 127)) != NULL)
+            memcpy(PyUnicode_1BYTE_DATA(text), data, len);
+        return text;
+    }
 
-    char* start = &((char*) self->buffer.buf)[self->offset];
-    char* end   = (char*) memchr(start, '\n', size);
+    for (i = 0; i < len; i++) {
+        nchars += (bytes[i] & 0xC0) != 0x80;
+        maxlead = bytes[i] > maxlead ? bytes[i] : maxlead;
+    }
+    if (maxlead < 0xC4)
+        maxchar = 0xFF;
+    else if (maxlead < 0xF0)
+        maxchar = 0xFFFF;
+    else
+        maxchar = 0x10FFFF;
 
-    Py_ssize_t length = (end == NULL) ? size : end - start + 1;
-    PyObject* bytes = PyBytes_FromStringAndSize((char*) start, length);
-    if (bytes == NULL)
-        return PyErr_NoMemory();
+    if ((text = PyUnicode_New(nchars, maxchar)) == NULL)
+        return NULL;
+    kind = PyUnicode_KIND(text);
+    out = PyUnicode_DATA(text);
+    for (i = 0, j = 0; i < len && j < nchars; i += n, j++) {
+        if (kind == PyUnicode_1BYTE_KIND && len - i >= 8 && nchars - j >= 8 && _is_ascii(&bytes[i], 8)) {
+            memcpy((Py_UCS1*) out + j, &bytes[i], 8);
+            n = 8;
+            j += 7;
+            continue;
+        }
+        if ((n = _utf8_next(bytes, len, i, &cp)) == 0)
+            break;
+        PyUnicode_WRITE(kind, out, j, cp);
+    }
+    if (i != len || j != nchars) {
+        Py_DECREF(text);
+        return PyUnicode_DecodeUTF8(data, len, "strict");
+    }
+    return text;
+#else
+    return PyUnicode_DecodeUTF8(data, len, "strict");
+#endif
+}
 
-    self->offset += length;
-    return bytes;
+/* Get the number of bytes remaining after the cursor position */
+static inline Py_ssize_t
+_text_remaining(cursor* crs)
+{
+    return (crs->offset < crs->buffer.len) ? crs->buffer.len - crs->offset : 0;
 }
 
 static PyObject*
-iocursor_cursor_Cursor_readline(PyObject* self, PyObject *args, PyObject *kwargs) {
-    assert(Py_TYPE(self) == &PyCursor_Type);
+iocursor_cursor_TextCursor___new__(PyTypeObject* type, PyObject* args, PyObject* kwds)
+{
+    Py_ssize_t   error;
+    PyObject*    buffer;
+    PyObject*    exc;
+    text_cursor* self;
+    cursor*      crs;
 
-    PyObject* return_value = NULL;
-    cursor* crs            = (cursor*) self;
-    Py_ssize_t size        = -1;
+    static char* keywords[] = {"buffer", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", keywords, &buffer))
+        return NULL;
 
-    static char* keywords[] = {"size", NULL};
-    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &size)) {
-        return_value = iocursor_cursor_Cursor_readline_impl(crs, size);
+    if (PyObject_TypeCheck(buffer, &PyCursor_Type)) {
+        crs = (cursor*) buffer;
+        Py_INCREF(crs);
+    } else {
+        crs = (cursor*) PyObject_CallFunction((PyObject*) &PyCursor_Type, "Oi", buffer, 1);
+        if (crs == NULL)
+            return NULL;
     }
 
-    return return_value;
-}
+    /* Validate the whole buffer once, so that invalid data is reported
+       early rather than in the middle of parsing */
+    if (!crs->closed) {
+        error = _utf8_validate((const unsigned char*) crs->buffer.buf, crs->buffer.len);
+        if (error >= 0) {
+            exc = PyUnicodeDecodeError_Create("utf-8", crs->buffer.buf, crs->buffer.len, error, error + 1, "invalid utf-8 sequence");
+            if (exc != NULL) {
+                PyErr_SetObject(PyExc_UnicodeDecodeError, exc);
+                Py_DECREF(exc);
+            }
+            Py_DECREF(crs);
+            return NULL;
+        }
+    }
 
-// --------------------------------------------------------------------------
+    self = (text_cursor*) type->tp_alloc(type, 0);
+    if (self == NULL) {
+        Py_DECREF(crs);
+        return NULL;
+    }
+    self->cursor = crs;
+
+    return (PyObject*) self;
+}
 
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor_readlines___doc__,
-  "readlines(self, hint=-1)\n"
+  iocursor_cursor_TextCursor___doc__,
+  "TextCursor(buffer)\n"
   "--\n"
   "\n"
-  "Collect all lines from the file into a `list` of `bytes`.\n"
+  "A text reader over a buffer of UTF-8 encoded data.\n"
+  "\n"
+  "Unlike `io.TextIOWrapper`, which decodes the data chunk by chunk,\n"
+  "the whole buffer is validated once on creation, and `str` objects\n"
+  "are then created directly from slices of the buffer, with a fast\n"
+  "path for ASCII data. Positions returned by `tell` and accepted by\n"
+  "`seek` are byte offsets in the buffer. Lines are only terminated\n"
+  "by ``\\n``, like with ``newline='\\n'``.\n"
   "\n"
   "Arguments:\n"
-  "    hint (int, *optional*): An approximate bound on the total\n"
-  "        number of bytes to be read. When positive, `readlines` will\n"
-  "        stop reading lines when the total number of bytes read\n"
-  "        exceeds ``hint``.\n"
+  "    buffer (object): A `Cursor` to read from, sharing its position,\n"
+  "        or an object implementing the buffer protocol.\n"
   "\n"
-  "Example:\n"
-  "    >>> text = b'abc\\ndef\\nghi\\n'\n"
-  "    >>> Cursor(text).readlines()\n"
-  "    [b'abc\\n', b'def\\n', b'ghi\\n']\n"
-  "    >>> Cursor(text).readlines(5)\n"
-  "    [b'abc\\n', b'def\\n']\n"
+  "Raises:\n"
+  "    UnicodeDecodeError: When the buffer is not valid UTF-8.\n"
   "\n"
 );
 
-static inline PyObject*
-iocursor_cursor_Cursor_readlines_impl(cursor* self, Py_ssize_t hint) {
-
-    char*      start;
-    char*      end;
-    PyObject*  bytes;
-    PyObject*  lines;
-    Py_ssize_t length = 0;
-    Py_ssize_t total  = 0;
-    Py_ssize_t size   = (self->offset > self->buffer.len) ? 0 : self->buffer.len - self->offset;
+PyDoc_STRVAR(
+  iocursor_cursor_TextCursor_read___doc__,
+  "read(self, size=-1)\n"
+  "--\n"
+  "\n"
+  "Read at most ``size`` characters, returned as a `str` object.\n"
+  "\n"
+  "Arguments:\n"
+  "    size (int, *optional*): The number of characters to read. If\n"
+  "        negative or `None`, read until EOF is reached.\n"
+  "\n"
+);
 
-    if ((hint <= 0) || hint > size)
-        hint = size;
+static PyObject*
+iocursor_cursor_TextCursor_read_impl(text_cursor* self, Py_ssize_t size)
+{
+    const char* data;
+    Py_ssize_t  length;
+    PyObject*   text;
+    cursor*     crs = self->cursor;
 
-    if (check_closed(self))
+    if (check_closed(crs))
         return NULL;
 
-    if ((lines = PyList_New(0)) == NULL)
-        return PyErr_NoMemory();
-
-    while (total < hint) {
-        start = &((char*) self->buffer.buf)[self->offset];
-        end   = memchr(start, '\n', size);
-
-        length = (end == NULL) ? size : end - start + 1;
-        if ((bytes = PyBytes_FromStringAndSize((char*) start, length)) == NULL) {
-            Py_DECREF(lines);
-            return PyErr_NoMemory();
-        } else {
-            PyList_Append(lines, bytes);
-            Py_DECREF(bytes);
-        }
+    data = &((const char*) crs->buffer.buf)[crs->offset];
+    length = _text_remaining(crs);
+    if (size >= 0)
+        length = _utf8_span((const unsigned char*) data, length, size);
 
-        self->offset += length;
-        size -= length;
-        total += length;
-    }
+    if ((text = _text_decode(data, length)) == NULL)
+        return NULL;
 
-    return lines;
+    cursor_record(crs, CURSOR_OP_READ, crs->offset, length);
+    crs->offset += length;
+    return text;
 }
 
 static PyObject*
-iocursor_cursor_Cursor_readlines(PyObject* self, PyObject *args, PyObject *kwargs) {
-    assert(Py_TYPE(self) == &PyCursor_Type);
-
-    PyObject* return_value = NULL;
-    cursor* crs            = (cursor*) self;
-    Py_ssize_t hint        = -1;
+iocursor_cursor_TextCursor_read(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject*  return_value = NULL;
+    Py_ssize_t size         = -1;
 
-    static char* keywords[] = {"hint", NULL};
-    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &hint)) {
-        return_value = iocursor_cursor_Cursor_readlines_impl(crs, hint);
+    static char* keywords[] = {"size", NULL};
+    if (_fast_optional_size(args, kwargs, &size)) {
+        return_value = iocursor_cursor_TextCursor_read_impl((text_cursor*) self, size);
+    } else if (PyErr_Occurred()) {
+        return NULL;
+    } else if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &size)) {
+        return_value = iocursor_cursor_TextCursor_read_impl((text_cursor*) self, size);
     }
 
     return return_value;
 }
 
-
-// --------------------------------------------------------------------------
-
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor_seek___doc__,
-  "seek(self, pos, whence=0)\n"
+  iocursor_cursor_TextCursor_readline___doc__,
+  "readline(self, size=-1)\n"
   "--\n"
   "\n"
-  "Change the stream position.\n"
-  "\n"
-  "Seek to byte offset pos relative to position indicated by whence:\n"
-  "    - 0  Start of stream (the default) - pos should be >= 0.\n"
-  "    - 1  Current position - pos may be negative.\n"
-  "    - 2  End of stream - pos usually negative.\n"
+  "Read and return one line, including the trailing newline.\n"
   "\n"
-  "Returns\n"
-  "    int: The new absolute position.\n"
+  "Arguments:\n"
+  "    size (int, *optional*): The maximum number of characters to\n"
+  "        read. If negative or `None`, read until the end of line.\n"
   "\n"
 );
 
-static inline PyObject*
-iocursor_cursor_Cursor_seek_impl(cursor* self, Py_ssize_t pos, int whence)
+static PyObject*
+iocursor_cursor_TextCursor_readline_impl(text_cursor* self, Py_ssize_t size)
 {
-    Py_ssize_t new_pos;
+    const char* data;
+    Py_ssize_t  length;
+    PyObject*   line;
+    cursor*     crs = self->cursor;
 
-    if (check_closed(self))
+    if (check_closed(crs))
         return NULL;
 
-    switch (whence) {
-        case SEEK_SET:
-            new_pos = pos;
-            break;
-        case SEEK_CUR:
-            if (pos > PY_SSIZE_T_MAX - self->offset) {
-                PyErr_SetString(PyExc_OverflowError, "new position too large");
-                return NULL;
-            }
-            new_pos = self->offset + pos;
-            break;
-        case SEEK_END:
-            if (pos > PY_SSIZE_T_MAX - self->buffer.len) {
-                PyErr_SetString(PyExc_OverflowError, "new position too large");
-                return NULL;
-            }
-            new_pos = self->buffer.len + pos;
-            break;
-        default:
-            return PyErr_Format(
-                PyExc_ValueError,
-                "invalid whence (%i, should be %i, %i or %i)",
-                whence,
-                SEEK_SET,
-                SEEK_CUR,
-                SEEK_END
-            );
-    }
+    data = &((const char*) crs->buffer.buf)[crs->offset];
+    length = _text_remaining(crs);
+    if (size >= 0)
+        length = _utf8_span((const unsigned char*) data, length, size);
+    if (length > 0)
+        length = cursor_line_length(crs, length, '\n');
 
-    if (new_pos < 0) {
-        if (whence == SEEK_SET) {
-            PyErr_Format(PyExc_ValueError, "negative seek value %zd", pos);
-            return NULL;
-        } else {
-            new_pos = 0;
-        }
-    }
+    if ((line = _text_decode(data, length)) == NULL)
+        return NULL;
 
-    self->offset = new_pos;
-    return PyLong_FromSsize_t(new_pos);
+    cursor_record(crs, CURSOR_OP_READLINE, crs->offset, length);
+    crs->offset += length;
+    return line;
 }
 
 static PyObject*
-iocursor_cursor_Cursor_seek(PyObject *self, PyObject *args, PyObject *kwargs)
+iocursor_cursor_TextCursor_readline(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    assert(Py_TYPE(self) == &PyCursor_Type);
+    PyObject*  return_value = NULL;
+    Py_ssize_t size         = -1;
 
-    PyObject* return_value = NULL;
-    cursor* crs            = (cursor*) self;
-    Py_ssize_t pos         = 0;
-    int whence             = SEEK_SET;
-
-    static char* keywords[] = {"pos", "whence", NULL};
-    if (PyArg_ParseTupleAndKeywords(args, kwargs, "n|i", keywords, &pos, &whence)) {
-        return_value = iocursor_cursor_Cursor_seek_impl(crs, pos, whence);
+    static char* keywords[] = {"size", NULL};
+    if (_fast_optional_size(args, kwargs, &size)) {
+        return_value = iocursor_cursor_TextCursor_readline_impl((text_cursor*) self, size);
+    } else if (PyErr_Occurred()) {
+        return NULL;
+    } else if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &size)) {
+        return_value = iocursor_cursor_TextCursor_readline_impl((text_cursor*) self, size);
     }
 
     return return_value;
 }
 
-// --------------------------------------------------------------------------
-
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor_seekable___doc__,
-  "seekable(self)\n"
+  iocursor_cursor_TextCursor_readlines___doc__,
+  "readlines(self, hint=-1)\n"
   "--\n"
   "\n"
-  "Return `True` if the stream supports random access.\n"
+  "Read and return a list of lines from the stream.\n"
   "\n"
-  "Always `True` for `Cursor` instances.\n"
+  "Arguments:\n"
+  "    hint (int, *optional*): A number of bytes after which to stop\n"
+  "        reading lines. If negative or `None`, read until EOF.\n"
   "\n"
 );
 
 static PyObject*
-iocursor_cursor_Cursor_seekable_impl(cursor* self)
+iocursor_cursor_TextCursor_readlines_impl(text_cursor* self, Py_ssize_t hint)
 {
-    if (check_closed(self))
+    Py_ssize_t start;
+    PyObject*  line;
+    PyObject*  lines;
+    cursor*    crs = self->cursor;
+
+    if (check_closed(crs))
+        return NULL;
+    if ((lines = PyList_New(0)) == NULL)
         return NULL;
-    Py_RETURN_TRUE;
-}
 
-// --------------------------------------------------------------------------
+    start = crs->offset;
+    while (_text_remaining(crs) > 0 && (hint <= 0 || crs->offset - start < hint)) {
+        line = iocursor_cursor_TextCursor_readline_impl(self, -1);
+        if (line == NULL || PyList_Append(lines, line) < 0) {
+            Py_XDECREF(line);
+            Py_DECREF(lines);
+            return NULL;
+        }
+        Py_DECREF(line);
+    }
 
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor_tell___doc__,
-  "tell(self)\n"
-  "--\n"
-  "\n"
-  "Get the current file position as an integer.\n"
-  "\n"
-);
+    return lines;
+}
 
 static PyObject*
-iocursor_cursor_Cursor_tell_impl(cursor* self)
+iocursor_cursor_TextCursor_readlines(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    if (check_closed(self))
-        return NULL;
-    return PyLong_FromSsize_t(self->offset);
-}
+    PyObject*  return_value = NULL;
+    Py_ssize_t hint         = -1;
+
+    static char* keywords[] = {"hint", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &hint)) {
+        return_value = iocursor_cursor_TextCursor_readlines_impl((text_cursor*) self, hint);
+    }
 
-// --------------------------------------------------------------------------
+    return return_value;
+}
 
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor_truncate___doc__,
-  "truncate(self, size=None, /)\n"
+  iocursor_cursor_TextCursor_seek___doc__,
+  "seek(self, offset, whence=os.SEEK_SET)\n"
   "--\n"
   "\n"
-  "Truncate the file to at most size bytes.\n"
+  "Change the stream position to the given byte offset.\n"
   "\n"
-  "This is not supported by `Cursor` instances, and calling this\n"
-  "method will effectively raise the `io.UnsupportedOperation`\n"
-  "exception.\n"
+  "See `Cursor.seek` for the semantics of the arguments. Seeking in\n"
+  "the middle of a character makes the next read fail.\n"
   "\n"
 );
 
 static PyObject*
-iocursor_cursor_Cursor_truncate_impl(cursor* self, Py_ssize_t size)
-{
-    if (check_closed(self))
-        return NULL;
-
-    PyObject* err = PyCursor_getunsupportedoperation();
-    if (err != NULL)
-        PyErr_SetString(err, "truncate");
-
-    return NULL;
-}
-
-static PyObject*
-iocursor_cursor_Cursor_truncate(PyObject *self, PyObject *args, PyObject *kwargs)
+iocursor_cursor_TextCursor_seek(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    assert(Py_TYPE(self) == &PyCursor_Type);
-
-    PyObject*  return_value   = NULL;
-    cursor*    crs            = (cursor*) self;
-    Py_ssize_t size           = crs->offset;
+    PyObject*  return_value = NULL;
+    Py_ssize_t offset;
+    int        whence       = SEEK_SET;
 
-    static char* keywords[] = {"b", NULL};
-    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", keywords, &_convert_optional_size, &size)) {
-        return_value = iocursor_cursor_Cursor_truncate_impl(crs, size);
+    static char* keywords[] = {"offset", "whence", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "n|i", keywords, &offset, &whence)) {
+        return_value = iocursor_cursor_Cursor_seek_impl(((text_cursor*) self)->cursor, offset, whence);
     }
 
     return return_value;
 }
 
-// --------------------------------------------------------------------------
-
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor_writable___doc__,
-  "writable(self)\n"
+  iocursor_cursor_TextCursor_tell___doc__,
+  "tell(self)\n"
   "--\n"
   "\n"
-  "Return ``True`` if the stream supports writing to it."
+  "Return the current stream position, as a byte offset.\n"
+  "\n"
 );
 
 static PyObject*
-iocursor_cursor_Cursor_writable_impl(cursor* self)
+iocursor_cursor_TextCursor_tell_impl(text_cursor* self)
 {
-    if (check_closed(self))
-        return NULL;
-    return PyBool_FromLong(!(self->readonly || self->buffer.readonly));
+    return iocursor_cursor_Cursor_tell_impl(self->cursor);
 }
 
-// --------------------------------------------------------------------------
-
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor_write___doc__,
-  "write(self, b, /)\n"
+  iocursor_cursor_TextCursor_close___doc__,
+  "close(self)\n"
   "--\n"
   "\n"
-  "Write the given bytes to the buffer.\n"
-  "\n"
-  "Returns:\n"
-  "    int: The number of bytes written.\n"
+  "Close the underlying cursor.\n"
   "\n"
 );
 
-static inline PyObject*
-iocursor_cursor_Cursor_write_impl(cursor* self, Py_buffer* bytes)
+static PyObject*
+iocursor_cursor_TextCursor_close_impl(text_cursor* self)
 {
-    /* Check the cursor is still writable */
-    if (check_closed(self))
+    return iocursor_cursor_Cursor_close_impl(self->cursor);
+}
+
+static PyObject*
+iocursor_cursor_TextCursor_closed_get(text_cursor* self, void* closure)
+{
+    return PyBool_FromLong(self->cursor->closed);
+}
+
+static PyObject*
+iocursor_cursor_TextCursor___next___impl(text_cursor* self)
+{
+    if (check_closed(self->cursor))
         return NULL;
-    if (check_writable(self))
+    if (_text_remaining(self->cursor) == 0)
         return NULL;
+    return iocursor_cursor_TextCursor_readline_impl(self, -1);
+}
 
-    /* No-op if there are no bytes to write */
-    if (bytes->len > 0) {
-        /* Check the buffer is large enough to hold the data */
-        if ((self->offset >= self->buffer.len) || (bytes->len > self->buffer.len - self->offset)) {
-            PyErr_Format(
-                PyExc_BufferError,
-                "cannot write %zd bytes to buffer of size %zd at position %zd",
-                bytes->len,
-                self->buffer.len,
-                self->offset
-            );
-            return NULL;
-        }
-        /* Copy data from `bytes` to the buffer */
-        memcpy(&((char*) self->buffer.buf)[self->offset], bytes->buf, bytes->len);
-        self->offset += bytes->len;
-    }
+static PyObject*
+iocursor_cursor_TextCursor___repr___impl(text_cursor* self)
+{
+    return PyUnicode_FromFormat("TextCursor(%R)", self->cursor);
+}
 
-    return PyLong_FromSsize_t(bytes->len);
+static int
+text_cursor_clear(text_cursor* self)
+{
+    Py_CLEAR(self->cursor);
+    return 0;
 }
 
-static PyObject*
-iocursor_cursor_Cursor_write(PyObject *self, PyObject *args, PyObject *kwargs)
+static void
+text_cursor_dealloc(text_cursor* self)
 {
-    assert(Py_TYPE(self) == &PyCursor_Type);
+    PyObject_GC_UnTrack(self);
+    Py_CLEAR(self->cursor);
+    Py_TYPE(self)->tp_free(self);
+}
 
-    Py_buffer bytes;
-    PyObject *return_value = NULL;
-    cursor* crs            = (cursor*) self;
+static int
+text_cursor_traverse(text_cursor* self, visitproc visit, void* arg)
+{
+    Py_VISIT(self->cursor);
+    return 0;
+}
 
-    static char* keywords[] = {"b", NULL};
-    if (PyArg_ParseTupleAndKeywords(args, kwargs, "y*", keywords, &bytes)) {
-        return_value = iocursor_cursor_Cursor_write_impl(crs, &bytes);
-        PyBuffer_Release(&bytes);
-    }
+static PyMethodDef text_cursor_methods[] = {
+    {"close",     (PyCFunction)                          iocursor_cursor_TextCursor_close_impl, METH_NOARGS,                  iocursor_cursor_TextCursor_close___doc__},
+    {"read",      (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_TextCursor_read,       METH_VARARGS | METH_KEYWORDS, iocursor_cursor_TextCursor_read___doc__},
+    {"readline",  (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_TextCursor_readline,   METH_VARARGS | METH_KEYWORDS, iocursor_cursor_TextCursor_readline___doc__},
+    {"readlines", (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_TextCursor_readlines,  METH_VARARGS | METH_KEYWORDS, iocursor_cursor_TextCursor_readlines___doc__},
+    {"seek",      (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_TextCursor_seek,       METH_VARARGS | METH_KEYWORDS, iocursor_cursor_TextCursor_seek___doc__},
+    {"tell",      (PyCFunction)                          iocursor_cursor_TextCursor_tell_impl,  METH_NOARGS,                  iocursor_cursor_TextCursor_tell___doc__},
+    {NULL, NULL, 0, NULL}  /* Sentinel */
+};
 
-    return return_value;
+static struct PyMemberDef text_cursor_members[] = {
+    {"buffer", T_OBJECT, offsetof(text_cursor, cursor), READONLY, "The `Cursor` the text is read from."},
+    {NULL}  /* Sentinel */
+};
+
+static PyGetSetDef text_cursor_getset[] = {
+    {"closed", (getter) iocursor_cursor_TextCursor_closed_get, NULL, "Whether the underlying cursor is closed.", NULL},
+    {NULL}  /* Sentinel */
+};
+
+PyTypeObject PyTextCursor_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "iocursor.cursor.TextCursor",
+    .tp_basicsize = sizeof(text_cursor),
+    .tp_dealloc   = (destructor) text_cursor_dealloc,
+    .tp_repr      = (reprfunc) iocursor_cursor_TextCursor___repr___impl,
+    .tp_flags     = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    .tp_doc       = iocursor_cursor_TextCursor___doc__,
+    .tp_traverse  = (traverseproc) text_cursor_traverse,
+    .tp_clear     = (inquiry) text_cursor_clear,
+    .tp_iter      = PyObject_SelfIter,
+    .tp_iternext  = (iternextfunc) iocursor_cursor_TextCursor___next___impl,
+    .tp_methods   = text_cursor_methods,
+    .tp_members   = text_cursor_members,
+    .tp_getset    = text_cursor_getset,
+    .tp_new       = iocursor_cursor_TextCursor___new__,
+};
+
+// --- cursor module ---------------------------------------------------------
+
+static inline PyCursor_State*
+cursormodule_getstate(PyObject *module) {
+    void *state = PyModule_GetState(module);
+    assert(state != NULL);
+    return (PyCursor_State *)state;
 }
 
-// --------------------------------------------------------------------------
+static int
+cursormodule_traverse(PyObject *mod, visitproc visit, void *arg) {
+    PyCursor_State* state = cursormodule_getstate(mod);
+    if (!state->initialized)
+        return 0;
+    Py_VISIT(state->unsupported_operation);
+    Py_VISIT(state->array_type);
+    return 0;
+}
+
+static int
+cursormodule_clear(PyObject *mod) {
+    PyCursor_State* state = cursormodule_getstate(mod);
+    if (!state->initialized)
+        return 0;
+    Py_CLEAR(state->unsupported_operation);
+    Py_CLEAR(state->array_type);
+    return 0;
+}
+
+static void
+cursormodule_free(PyObject *mod) {
+    cursormodule_clear(mod);
+    cursor_freelist_clear();
+    registry_clear();
+}
 
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor_writelines___doc__,
-  "writelines(self, lines, /)\n"
+  iocursor_cursor_copy_engine___doc__,
+  "copy_engine(stream_size=None, parallel_size=None, threads=None)\n"
   "--\n"
   "\n"
-  "Write a list of lines to the buffer.\n"
+  "Get or configure the copy engine used for large reads and writes.\n"
+  "\n"
+  "`Cursor.readinto`, `Cursor.write` and `Cursor.write_at` copy data\n"
+  "larger than ``stream_size`` with the GIL released, using non-temporal\n"
+  "stores where the CPU supports them so that the copied data does not\n"
+  "evict the working set of the program from the cache. Copies larger\n"
+  "than ``parallel_size`` are further split across ``threads`` threads.\n"
+  "Both are disabled by default, with ``stream_size`` set to the\n"
+  "largest buffer size, since they only pay off on some hosts: use\n"
+  "``benches/copy.py`` to check before enabling them. The default\n"
+  "number of threads is derived from the number of cores of the host.\n"
+  "\n"
+  "Arguments:\n"
+  "    stream_size (int, *optional*): The size above which copies\n"
+  "        bypass the cache, or `None` to keep the current value.\n"
+  "    parallel_size (int, *optional*): The size above which copies\n"
+  "        are split across threads, or `None` to keep the current value.\n"
+  "    threads (int, *optional*): The number of threads used for\n"
+  "        parallel copies, or `None` to keep the current value.\n"
+  "\n"
+  "Returns:\n"
+  "    `dict`: The configuration of the copy engine after the update,\n"
+  "    with an additional ``streaming`` key telling whether non-temporal\n"
+  "    stores are supported on this platform.\n"
   "\n"
 );
 
-static inline PyObject*
-iocursor_cursor_Cursor_writelines_impl(cursor* self, PyObject* it)
+static PyObject*
+iocursor_cursor_copy_engine_impl(PyObject* module, Py_ssize_t stream_size, Py_ssize_t parallel_size, int threads)
 {
-    PyObject* item;
-    Py_buffer line;
+#ifdef CURSOR_COPY_STREAM
+    bool streaming = true;
+#else
+    bool streaming = false;
+#endif
 
-    /* Check the cursor is still writable */
-    if (check_closed(self))
-        return NULL;
-    if (check_writable(self))
+    if (threads > CURSOR_COPY_THREADS_MAX) {
+        PyErr_Format(PyExc_ValueError, "threads must be at most %i, not %i", CURSOR_COPY_THREADS_MAX, threads);
         return NULL;
-
-    while ((item = PyIter_Next(it))) {
-        /* Extract the item to a buffer */
-        if (PyObject_GetBuffer(item, &line, PyBUF_SIMPLE) < 0) {
-            Py_DECREF(item);
-            return NULL;
-        }
-
-        /* Check we can write the entirety of the line to the buffer */
-        if ((self->offset >= self->buffer.len) || (line.len > self->buffer.len - self->offset)) {
-            PyErr_Format(
-                PyExc_BufferError,
-                "cannot write %zd bytes to buffer of size %zd at position %zd",
-                line.len,
-                self->buffer.len,
-                self->offset
-            );
-            PyBuffer_Release(&line);
-            Py_DECREF(item);
-            return NULL;
-        }
-
-        /* Write the line to the buffer */
-        memcpy(&((char*) self->buffer.buf)[self->offset], line.buf, line.len);
-        self->offset += line.len;
-
-        /* release buffer and reference when done */
-        PyBuffer_Release(&line);
-        Py_DECREF(item);
     }
 
-    if (PyErr_Occurred())
-        return NULL;
-
-    Py_RETURN_NONE;
+    if (stream_size >= 0)
+        cursor_copy_stream_size = stream_size;
+    if (parallel_size >= 0)
+        cursor_copy_parallel_size = parallel_size;
+    if (threads >= 1)
+        cursor_copy_threads = threads;
+
+    return Py_BuildValue(
+        "{s:O,s:n,s:n,s:i}",
+        "streaming", streaming ? Py_True : Py_False,
+        "stream_size", cursor_copy_stream_size,
+        "parallel_size", cursor_copy_parallel_size,
+        "threads", cursor_copy_threads
+    );
 }
 
-static PyObject*
-iocursor_cursor_Cursor_writelines(PyObject *self, PyObject *args, PyObject *kwargs)
+/* Convert an optional non-negative integer, leaving -1 for `None` */
+static int
+_optional_size(PyObject* obj, const char* name, Py_ssize_t minimum, Py_ssize_t* value)
 {
-    assert(Py_TYPE(self) == &PyCursor_Type);
-
-    PyObject* it;
-    PyObject* return_value = NULL;
-    cursor*   crs          = (cursor*) self;
-
-    static char* keywords[] = {"b", NULL};
-    if (PyArg_ParseTupleAndKeywords(args, kwargs, "O&", keywords, &_convert_iter, &it)) {
-        return_value = iocursor_cursor_Cursor_writelines_impl(crs, it);
-        Py_DECREF(it);
+    if (obj == Py_None)
+        return 0;
+    if ((*value = PyLong_AsSsize_t(obj)) == -1 && PyErr_Occurred())
+        return -1;
+    if (*value < minimum) {
+        PyErr_Format(PyExc_ValueError, "%s must be at least %zd, not %zd", name, minimum, *value);
+        return -1;
     }
-
-    return return_value;
+    return 0;
 }
 
-// --------------------------------------------------------------------------
-
-static PyObject *
-iocursor_cursor_Cursor___new__(PyTypeObject* type, PyObject* args, PyObject* kwds)
+static PyObject*
+iocursor_cursor_copy_engine(PyObject* module, PyObject* args, PyObject* kwargs)
 {
-    cursor *self;
-
-    assert(type != NULL && type->tp_alloc != NULL);
-    self = (cursor*) type->tp_alloc(type, 0);
-    if (self == NULL)
+    PyObject*  stream_size_obj   = Py_None;
+    PyObject*  parallel_size_obj = Py_None;
+    PyObject*  threads_obj       = Py_None;
+    Py_ssize_t stream_size       = -1;
+    Py_ssize_t parallel_size     = -1;
+    Py_ssize_t threads           = -1;
+
+    static char* keywords[] = {"stream_size", "parallel_size", "threads", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OOO", keywords, &stream_size_obj, &parallel_size_obj, &threads_obj))
+        return NULL;
+    if (_optional_size(stream_size_obj, "stream_size", 0, &stream_size) < 0)
+        return NULL;
+    if (_optional_size(parallel_size_obj, "parallel_size", 0, &parallel_size) < 0)
+        return NULL;
+    if (_optional_size(threads_obj, "threads", 1, &threads) < 0)
         return NULL;
 
-    self->buffer.obj = NULL;
-    self->readonly = false;
-    self->closed = false;
-    self->offset = 0;
-    self->source = NULL;
-
-    return (PyObject *)self;
+    return iocursor_cursor_copy_engine_impl(module, stream_size, parallel_size, (int) Py_MIN(threads, INT_MAX));
 }
 
-// --------------------------------------------------------------------------
-
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor___init____doc__,
+  iocursor_cursor_track_exports___doc__,
+  "track_exports(enable=True, frames=16)\n"
+  "--\n"
+  "\n"
+  "Start or stop recording the cursors holding a buffer export.\n"
+  "\n"
+  "A `Cursor` keeps a buffer export of its source until it is closed\n"
+  "or deallocated, which keeps large `bytes` objects alive and prevents\n"
+  "`bytearray` objects from being resized. While tracking is enabled,\n"
+  "cursors are recorded when they export a buffer, and can be listed\n"
+  "with `live_cursors`. The exported sizes are also reported to\n"
+  "`tracemalloc`, if it is tracing, in the `TRACEMALLOC_DOMAIN` domain.\n"
+  "Only cursors created or rebound while tracking are recorded, and\n"
+  "disabling tracking forgets all of them.\n"
+  "\n"
+  "Arguments:\n"
+  "    enable (bool): Whether to enable or disable tracking.\n"
+  "    frames (int): The number of stack frames to record when a cursor\n"
+  "        exports a buffer. Pass 0 to avoid the cost of recording the\n"
+  "        traceback.\n"
   "\n"
-  "A buffered I/O implementation wrapping a bytes buffer."
+  "Example:\n"
+  "    >>> track_exports()\n"
+  "    >>> cursor = Cursor(bytes(1024))\n"
+  "    >>> [info['size'] for info in live_cursors()]\n"
+  "    [1024]\n"
+  "    >>> track_exports(False)\n"
   "\n"
 );
 
-static inline int
-iocursor_cursor_Cursor___init___impl(cursor* self, PyObject* source, bool readonly)
+static PyObject*
+iocursor_cursor_track_exports_impl(PyObject* module, bool enable, int frames)
 {
-    int return_value = 0;
-
-    /* Allow calling __init__ more than once, in that case make sure to
-       release any previous object reference */
-    self->offset = 0;
-    if (self->buffer.buf != NULL)
-        PyBuffer_Release(&self->buffer);
-    self->buffer.buf = NULL;
-    Py_XDECREF(self->source);
-
-    /* Register the source object */
-    self->source = source;
-    Py_INCREF(source);
+    PyObject* traceback;
 
-    /* Mark the cursor as 'open' */
-    self->closed = false;
-    self->readonly = false;
+    if (frames < 0) {
+        PyErr_Format(PyExc_ValueError, "negative frames value %i", frames);
+        return NULL;
+    }
 
-    /* Get a buffer for the source object */
-    if (!readonly) {
-        return_value = PyObject_GetBuffer(source, &self->buffer, PyBUF_SIMPLE | PyBUF_WRITABLE);
-        if (return_value < 0) {
-            PyErr_Clear();
-            readonly = true;
-            return_value = 0;
-        }
+    if (!enable) {
+        registry_clear();
+        Py_RETURN_NONE;
     }
 
-    if (self->buffer.buf == NULL) {
-        return_value = PyObject_GetBuffer(source, &self->buffer, PyBUF_SIMPLE);
-        self->readonly = true;
+    if (frames > 0 && cursor_registry_extract_stack == NULL) {
+        if ((traceback = PyImport_ImportModule("traceback")) == NULL)
+            return NULL;
+        cursor_registry_extract_stack = PyObject_GetAttrString(traceback, "extract_stack");
+        Py_DECREF(traceback);
+        if (cursor_registry_extract_stack == NULL)
+            return NULL;
     }
+    cursor_registry_frames = frames;
+    cursor_registry_enabled = true;
 
-    return return_value;
+    Py_RETURN_NONE;
 }
 
-static int
-iocursor_cursor_Cursor___init__(PyObject *self, PyObject *args, PyObject *kwargs)
+static PyObject*
+iocursor_cursor_track_exports(PyObject* module, PyObject* args, PyObject* kwargs)
 {
-    int return_value = -1;
-    static char* keywords[] = {"buffer", "readonly", NULL};
-
-    PyObject* source   = NULL;
-    int       readonly = false;
+    PyObject* return_value = NULL;
+    int       enable       = true;
+    int       frames       = 16;
 
-    if (PyArg_ParseTupleAndKeywords(args, kwargs, "O|p", keywords, &source, &readonly)) {
-        return_value = iocursor_cursor_Cursor___init___impl(
-            (cursor*) self,
-            source,
-            (bool) readonly
-        );
+    static char* keywords[] = {"enable", "frames", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|pi", keywords, &enable, &frames)) {
+        return_value = iocursor_cursor_track_exports_impl(module, (bool) enable, frames);
     }
 
     return return_value;
 }
 
-// --------------------------------------------------------------------------
-
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor___enter_____doc__,
-  "__enter__(self)\n"
+  iocursor_cursor_live_cursors___doc__,
+  "live_cursors()\n"
   "--\n"
   "\n"
-  ""
+  "Get the cursors recorded while `track_exports` was enabled.\n"
+  "\n"
+  "Returns:\n"
+  "    `list` of `dict`: The recorded cursors still holding a buffer\n"
+  "    export, from the oldest to the most recent. Each dictionary\n"
+  "    contains the ``cursor`` itself, the ``source_type`` name of the\n"
+  "    wrapped object, the ``size`` of the exported buffer, the current\n"
+  "    ``offset`` of the cursor, and the ``traceback`` of the export as\n"
+  "    a `traceback.StackSummary`, or `None` if it was not recorded.\n"
+  "\n"
 );
 
 static PyObject*
-iocursor_cursor_Cursor___enter___impl(cursor* self)
+iocursor_cursor_live_cursors_impl(PyObject* module)
 {
-    Py_INCREF(self);
-    return (PyObject*) self;
-}
+    PyObject* list;
+    PyObject* info;
+    cursor*   crs;
 
-// --------------------------------------------------------------------------
+    if ((list = PyList_New(0)) == NULL)
+        return NULL;
 
-PyDoc_STRVAR(
-  iocursor_cursor_Cursor___exit_____doc__,
-  "__exit__(self, exc_type, exc_value, traceback)\n"
-  "--\n"
-  "\n"
-  ""
-);
+    for (crs = cursor_registry; crs != NULL; crs = crs->registry_next) {
+        info = Py_BuildValue(
+            "{s:O,s:s,s:n,s:n,s:O}",
+            "cursor", (PyObject*) crs,
+            "source_type", Py_TYPE(crs->source)->tp_name,
+            "size", crs->buffer.len,
+            "offset", crs->offset,
+            "traceback", crs->registry_traceback != NULL ? crs->registry_traceback : Py_None
+        );
+        if (info == NULL || PyList_Append(list, info) < 0) {
+            Py_XDECREF(info);
+            Py_DECREF(list);
+            return NULL;
+        }
+        Py_DECREF(info);
+    }
 
-static PyObject*
-iocursor_cursor_Cursor___exit___impl(cursor* self, PyObject* exc_type, PyObject* exc_value, PyObject* traceback)
-{
-    if (iocursor_cursor_Cursor_close_impl(self) == NULL)
+    if (PyList_Reverse(list) < 0) {
+        Py_DECREF(list);
         return NULL;
-    Py_RETURN_FALSE;
+    }
+    return list;
 }
 
-static PyObject*
-iocursor_cursor_Cursor___exit__(PyObject *self, PyObject *args, PyObject *kwargs)
+#ifdef CURSOR_URING
+
+/* The maximum number of reads submitted at once by `uring_load` */
+#define CURSOR_URING_DEPTH_MAX 4096
+
+/* An io_uring instance driven with raw system calls, so that no library
+   is needed at build time. Only reads are submitted, by a single thread
+   holding the GIL, so the submission tail is never read back. */
+typedef struct {
+    int                  fd;
+    unsigned             to_submit;
+    unsigned*            sq_tail;
+    unsigned*            sq_mask;
+    unsigned*            sq_array;
+    unsigned*            cq_head;
+    unsigned*            cq_tail;
+    unsigned*            cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    void*                sq_ring;
+    void*                cq_ring;
+    size_t               sq_size;
+    size_t               cq_size;
+    size_t               sqes_size;
+} uring;
+
+static void
+uring_close(uring* ring)
 {
+    if (ring->sqes != NULL)
+        munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != NULL && ring->cq_ring != ring->sq_ring)
+        munmap(ring->cq_ring, ring->cq_size);
+    if (ring->sq_ring != NULL)
+        munmap(ring->sq_ring, ring->sq_size);
+    close(ring->fd);
+}
 
-    PyObject*    return_value = NULL;
-    static char* keywords[]   = {"exc_type", "exc_value", "traceback", NULL};
+/* Create a ring with at least `entries` submission slots, setting `errno`
+   on failure. Kernels that cannot read from the current file position
+   (before Linux 5.6) are reported as not supporting io_uring. */
+static int
+uring_setup(uring* ring, unsigned entries)
+{
+    struct io_uring_params params;
+    char*                  sq;
+    char*                  cq;
+    int                    err;
+
+    memset(ring, 0, sizeof(uring));
+    memset(&params, 0, sizeof(params));
+
+    if ((ring->fd = (int) syscall(__NR_io_uring_setup, entries, &params)) < 0)
+        return -1;
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+        close(ring->fd);
+        errno = ENOSYS;
+        return -1;
+    }
 
-    PyObject* exc_type  = Py_None;
-    PyObject* exc_value = Py_None;
-    PyObject* traceback = Py_None;
+    ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        ring->sq_size = ring->cq_size = Py_MAX(ring->sq_size, ring->cq_size);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
 
-    if (PyArg_ParseTupleAndKeywords(args, kwargs, "|OOO", keywords, &exc_type, &exc_value, &traceback)) {
-        return_value = iocursor_cursor_Cursor___exit___impl(
-            (cursor*) self,
-            exc_type,
-            exc_value,
-            traceback
-        );
+    ring->sq_ring = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        ring->sq_ring = NULL;
+        goto fail;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            ring->cq_ring = NULL;
+            goto fail;
+        }
+    }
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        goto fail;
     }
 
-    return return_value;
-}
+    sq = (char*) ring->sq_ring;
+    cq = (char*) ring->cq_ring;
+    ring->sq_tail  = (unsigned*) &sq[params.sq_off.tail];
+    ring->sq_mask  = (unsigned*) &sq[params.sq_off.ring_mask];
+    ring->sq_array = (unsigned*) &sq[params.sq_off.array];
+    ring->cq_head  = (unsigned*) &cq[params.cq_off.head];
+    ring->cq_tail  = (unsigned*) &cq[params.cq_off.tail];
+    ring->cq_mask  = (unsigned*) &cq[params.cq_off.ring_mask];
+    ring->cqes     = (struct io_uring_cqe*) &cq[params.cq_off.cqes];
+    return 0;
 
-// --------------------------------------------------------------------------
+fail:
+    err = errno;
+    uring_close(ring);
+    errno = err;
+    return -1;
+}
 
-static PyObject*
-iocursor_cursor_Cursor___next___impl(cursor* self)
+/* Queue a read of `n` bytes from the current position of `fd` */
+static void
+uring_prep_read(uring* ring, int fd, char* data, Py_ssize_t n, Py_ssize_t user_data)
 {
-    if (self->offset >= self->buffer.len)
-        return NULL;
-    return iocursor_cursor_Cursor_readline_impl(self, -1);
+    unsigned             tail  = *ring->sq_tail;
+    unsigned             index = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe   = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode    = IORING_OP_READ;
+    sqe->fd        = fd;
+    sqe->off       = (__u64) -1;
+    sqe->addr      = (__u64) (uintptr_t) data;
+    sqe->len       = (__u32) Py_MIN(n, INT_MAX);
+    sqe->user_data = (__u64) user_data;
+
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->to_submit++;
 }
 
-// --------------------------------------------------------------------------
-
-static PyObject*
-iocursor_cursor_Cursor___repr___impl(cursor* self)
+/* Submit the queued reads and wait for at least one completion */
+static int
+uring_enter(uring* ring)
 {
-    if (self->readonly && !self->buffer.readonly)
-        return PyUnicode_FromFormat("Cursor(\%R, readonly=True)", self->source);
-    else
-        return PyUnicode_FromFormat("Cursor(\%R)", self->source);
+    int submitted = (int) syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+    if (submitted > 0)
+        ring->to_submit -= (unsigned) submitted;
+    return submitted;
 }
 
-// --------------------------------------------------------------------------
+/* Pop a completion from the ring, returning false if there is none */
+static bool
+uring_pop(uring* ring, Py_ssize_t* user_data, int* res)
+{
+    unsigned             head = *ring->cq_head;
+    struct io_uring_cqe* cqe;
 
-static int
-cursor_clear(cursor *self)
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+        return false;
+
+    cqe = &ring->cqes[head & *ring->cq_mask];
+    *user_data = (Py_ssize_t) cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/* The state of a cursor loaded by `uring_load` */
+typedef struct {
+    cursor*    crs;
+    int        fd;
+    bool       pinned;
+    bool       in_flight;
+    Py_ssize_t start;
+    Py_ssize_t size;
+    Py_ssize_t total;
+    PyObject*  result;
+} uring_load_item;
+
+/* Get the exception being raised as an object, clearing it */
+static PyObject*
+_fetch_exception(void)
 {
-    Py_CLEAR(self->source);
-    return 0;
+    PyObject* type;
+    PyObject* value;
+    PyObject* traceback;
+
+    PyErr_Fetch(&type, &value, &traceback);
+    PyErr_NormalizeException(&type, &value, &traceback);
+    if (traceback != NULL)
+        PyException_SetTraceback(value, traceback);
+    Py_XDECREF(type);
+    Py_XDECREF(traceback);
+    return value;
 }
 
+/* Check the cursor of an item and pin its buffer, or set its result */
 static void
-cursor_dealloc(cursor *self)
+uring_load_prepare(uring_load_item* item)
 {
-    if (!self->closed) {
-        self->closed = true;
-        PyBuffer_Release(&self->buffer);
+    cursor* crs = item->crs;
+
+    item->start = crs->offset;
+    if (check_closed(crs) || check_writable(crs) || cursor_make_writable(crs) < 0) {
+        item->result = _fetch_exception();
+        return;
+    }
+
+    item->size = crs->offset < crs->buffer.len ? crs->buffer.len - crs->offset : 0;
+    if (cursor_save(crs, crs->offset, item->size) < 0) {
+        item->result = _fetch_exception();
+    } else if (item->size == 0) {
+        item->result = PyLong_FromLong(0);
+    } else {
+        /* Prevent the buffer from being released while the kernel writes to it */
+        crs->exports++;
+        item->pinned = true;
     }
-    PyObject_GC_UnTrack(self);
-    Py_CLEAR(self->source);
-    Py_TYPE(self)->tp_free(self);
 }
 
-static int
-cursor_traverse(cursor* self, visitproc visit, void* arg)
+/* Create the `OSError` subclass matching an error number */
+static PyObject*
+_errno_exception(int err)
 {
-    Py_VISIT(self->source);
-    return 0;
+    return PyObject_CallFunction(PyExc_OSError, "is", err, strerror(err));
 }
 
-// --------------------------------------------------------------------------
+/* Unpin the buffer of an item, record the read and set its result. If the
+   result cannot be created, its exception is stored in `error`. */
+static void
+uring_load_finish(uring_load_item* item, int err, PyObject** error)
+{
+    item->crs->exports--;
+    item->pinned = false;
+    cursor_record(item->crs, CURSOR_OP_WRITE, item->start, item->total);
+
+    item->result = (err != 0) ? _errno_exception(err) : PyLong_FromSsize_t(item->total);
+    if (item->result == NULL && *error == NULL)
+        *error = _fetch_exception();
+    else if (item->result == NULL)
+        PyErr_Clear();
+}
+
+#endif
 
 PyDoc_STRVAR(
-  iocursor_cursor_Cursor_closed___doc__,
-  "closed: `True` if the stream has been closed.\n"
+  iocursor_cursor_uring_load___doc__,
+  "uring_load(items, queue_depth=32)\n"
+  "--\n"
+  "\n"
+  "Read many file descriptors into the buffers of many cursors with io_uring.\n"
+  "\n"
+  "This is the Linux backend of `iocursor.load_many`: each file is read\n"
+  "from its current position into the buffer of its cursor, at the\n"
+  "cursor position, until EOF or until the buffer is full, with up to\n"
+  "``queue_depth`` reads submitted to the kernel at the same time. The\n"
+  "GIL is released while waiting for the reads to complete.\n"
+  "\n"
+  "Arguments:\n"
+  "    items (sequence of tuple): Pairs of open file descriptors and of\n"
+  "        writable cursors to read them into.\n"
+  "    queue_depth (int): The maximum number of reads in flight.\n"
+  "\n"
+  "Returns:\n"
+  "    `list`: The result of each read, in the same order as ``items``:\n"
+  "    either the number of bytes read into the cursor, or the exception\n"
+  "    raised while reading the file.\n"
+  "\n"
+  "Raises:\n"
+  "    OSError: When io_uring is not available on this platform, before\n"
+  "        any file is read.\n"
   "\n"
 );
 
-static struct PyMemberDef cursor_members[] = {
-    {"closed",   T_BOOL, offsetof(cursor, closed), READONLY, iocursor_cursor_Cursor_closed___doc__},
-    {NULL}  /* Sentinel */
-};
+static PyObject*
+iocursor_cursor_uring_load_impl(PyObject* module, PyObject* items, int queue_depth)
+{
+#ifndef CURSOR_URING
+    errno = ENOSYS;
+    return PyErr_SetFromErrno(PyExc_OSError);
+#else
+    uring            ring;
+    uring_load_item* loads;
+    uring_load_item* item;
+    PyObject*        seq;
+    PyObject*        pair;
+    PyObject*        results   = NULL;
+    PyObject*        error     = NULL;
+    Py_ssize_t       length;
+    Py_ssize_t       next      = 0;
+    Py_ssize_t       in_flight = 0;
+    Py_ssize_t       i;
+    int              res;
+    int              err;
+
+    if (queue_depth < 1) {
+        PyErr_Format(PyExc_ValueError, "queue_depth must be at least 1, not %i", queue_depth);
+        return NULL;
+    }
+    if ((seq = PySequence_Fast(items, "items must be iterable")) == NULL)
+        return NULL;
+    length = PySequence_Fast_GET_SIZE(seq);
+    if ((loads = PyMem_Calloc(Py_MAX(length, 1), sizeof(uring_load_item))) == NULL) {
+        Py_DECREF(seq);
+        return PyErr_NoMemory();
+    }
 
-static struct PyMethodDef cursor_methods[] = {
-    {"__enter__",  (PyCFunction)                          iocursor_cursor_Cursor___enter___impl, METH_NOARGS,                  iocursor_cursor_Cursor___enter_____doc__},
-    {"__exit__",   (PyCFunction)                          iocursor_cursor_Cursor___exit__,       METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor___exit_____doc__},
-    {"close",      (PyCFunction)                          iocursor_cursor_Cursor_close_impl,     METH_NOARGS,                  iocursor_cursor_Cursor_close___doc__},
-    {"detach",     (PyCFunction)                          iocursor_cursor_Cursor_detach_impl,    METH_NOARGS,                  iocursor_cursor_Cursor_detach___doc__},
-    {"fileno",     (PyCFunction)                          iocursor_cursor_Cursor_fileno_impl,    METH_NOARGS,                  iocursor_cursor_Cursor_fileno___doc__},
-    {"flush",      (PyCFunction)                          iocursor_cursor_Cursor_flush_impl,     METH_NOARGS,                  iocursor_cursor_Cursor_flush___doc__},
-    {"getvalue",   (PyCFunction)                          iocursor_cursor_Cursor_getvalue_impl,  METH_NOARGS,                  iocursor_cursor_Cursor_getvalue___doc__},
-    {"isatty",     (PyCFunction)                          iocursor_cursor_Cursor_isatty_impl,    METH_NOARGS,                  iocursor_cursor_Cursor_isatty___doc__},
-    {"read",       (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_read,           METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor_read___doc__},
-    {"read1",      (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_read,           METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor_read1___doc__},
-    {"readable",   (PyCFunction)                          iocursor_cursor_Cursor_readable_impl,  METH_NOARGS,                  iocursor_cursor_Cursor_readable___doc__},
-    {"readinto",   (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_readinto,       METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor_readinto___doc__},
-    {"readinto1",  (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_readinto,       METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor_readinto1___doc__},
-    {"readline",   (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_readline,       METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor_readline___doc__},
-    {"readlines",  (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_readlines,      METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor_readlines___doc__},
-    {"seek",       (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_seek,           METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor_seek___doc__},
-    {"seekable",   (PyCFunction)                          iocursor_cursor_Cursor_seekable_impl,  METH_NOARGS,                  iocursor_cursor_Cursor_seekable___doc__},
-    {"tell",       (PyCFunction)                          iocursor_cursor_Cursor_tell_impl,      METH_NOARGS,                  iocursor_cursor_Cursor_tell___doc__},
-    {"truncate",   (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_truncate,       METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor_truncate___doc__},
-    {"writable",   (PyCFunction)                          iocursor_cursor_Cursor_writable_impl,  METH_NOARGS,                  iocursor_cursor_Cursor_writable___doc__},
-    {"write",      (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_write,          METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor_write___doc__},
-    {"writelines", (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_Cursor_writelines,     METH_VARARGS | METH_KEYWORDS, iocursor_cursor_Cursor_writelines___doc__},
-    {NULL, NULL}  /* sentinel */
-};
+    for (i = 0; i < length; i++) {
+        pair = PySequence_Fast_GET_ITEM(seq, i);
+        if (!PyTuple_Check(pair) || PyTuple_GET_SIZE(pair) != 2 || !PyObject_TypeCheck(PyTuple_GET_ITEM(pair, 1), &PyCursor_Type)) {
+            PyErr_SetString(PyExc_TypeError, "items must be (fd, Cursor) tuples");
+            goto exit;
+        }
+        loads[i].crs = (cursor*) PyTuple_GET_ITEM(pair, 1);
+        if ((loads[i].fd = PyObject_AsFileDescriptor(PyTuple_GET_ITEM(pair, 0))) < 0)
+            loads[i].result = _fetch_exception();
+    }
 
-PyTypeObject PyCursor_Type = {
-    PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name      = "iocursor.cursor.Cursor",
-    .tp_basicsize = sizeof(cursor),
-    .tp_dealloc   = (destructor) cursor_dealloc,
-    .tp_repr      = (reprfunc) iocursor_cursor_Cursor___repr___impl,
-    .tp_flags     = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,
-    .tp_doc       = iocursor_cursor_Cursor___init____doc__,
-    .tp_traverse  = (traverseproc) cursor_traverse,
-    .tp_clear     = (inquiry) cursor_clear,
-    .tp_iter      = PyObject_SelfIter,
-    .tp_iternext  = (iternextfunc) iocursor_cursor_Cursor___next___impl,
-    .tp_methods   = cursor_methods,
-    .tp_members   = cursor_members,
-    .tp_init      = iocursor_cursor_Cursor___init__,
-    .tp_new       = iocursor_cursor_Cursor___new__,
-};
+    if ((results = PyList_New(length)) == NULL || length == 0)
+        goto exit;
 
-// --- cursor module ---------------------------------------------------------
+    queue_depth = (int) Py_MIN(Py_MIN(queue_depth, length), CURSOR_URING_DEPTH_MAX);
+    if (uring_setup(&ring, (unsigned) queue_depth) < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        Py_CLEAR(results);
+        goto exit;
+    }
 
-static inline PyCursor_State*
-cursormodule_getstate(PyObject *module) {
-    void *state = PyModule_GetState(module);
-    assert(state != NULL);
-    return (PyCursor_State *)state;
-}
+    for (i = 0; i < length; i++)
+        if (loads[i].result == NULL)
+            uring_load_prepare(&loads[i]);
+
+    while (true) {
+        /* Keep the queue full, unless an exception is being raised */
+        for (; error == NULL && in_flight < queue_depth && next < length; next++) {
+            item = &loads[next];
+            if (item->pinned) {
+                uring_prep_read(&ring, item->fd, &((char*) item->crs->buffer.buf)[item->start], item->size, next);
+                item->in_flight = true;
+                in_flight++;
+            }
+        }
+        if (in_flight == 0)
+            break;
 
-static int
-cursormodule_traverse(PyObject *mod, visitproc visit, void *arg) {
-    PyCursor_State* state = cursormodule_getstate(mod);
-    if (!state->initialized)
-        return 0;
-    Py_VISIT(state->unsupported_operation);
-    return 0;
-}
+        Py_BEGIN_ALLOW_THREADS
+        res = uring_enter(&ring);
+        err = errno;
+        Py_END_ALLOW_THREADS
+
+        if (res < 0 && err == EINTR) {
+            if (error == NULL && PyErr_CheckSignals() < 0)
+                error = _fetch_exception();
+        } else if (res < 0 && err != EAGAIN && err != EBUSY) {
+            /* The kernel may still write to the buffers of the reads in
+               flight, so they are left pinned instead of being released */
+            for (i = 0; i < length; i++) {
+                item = &loads[i];
+                if (item->in_flight) {
+                    item->result = _errno_exception(err);
+                    if (item->result == NULL && error == NULL)
+                        error = _fetch_exception();
+                    else if (item->result == NULL)
+                        PyErr_Clear();
+                } else if (item->pinned) {
+                    uring_load_finish(item, err, &error);
+                }
+            }
+            break;
+        }
 
-static int
-cursormodule_clear(PyObject *mod) {
-    PyCursor_State* state = cursormodule_getstate(mod);
-    if (!state->initialized)
-        return 0;
-    Py_CLEAR(state->unsupported_operation);
-    return 0;
+        while (uring_pop(&ring, &i, &res)) {
+            item = &loads[i];
+            item->in_flight = false;
+            in_flight--;
+            if (res > 0) {
+                item->total += res;
+                item->crs->offset += res;
+            }
+            if (error == NULL && (res == -EINTR || (res > 0 && item->total < item->size))) {
+                uring_prep_read(&ring, item->fd, &((char*) item->crs->buffer.buf)[item->start + item->total], item->size - item->total, i);
+                item->in_flight = true;
+                in_flight++;
+            } else if (res < 0 && res != -EINTR && !(res == -EAGAIN && item->total > 0)) {
+                uring_load_finish(item, -res, &error);
+            } else {
+                uring_load_finish(item, 0, &error);
+            }
+        }
+    }
+
+    /* Release the buffers of the reads that were never submitted */
+    for (i = 0; i < length; i++)
+        if (loads[i].pinned && !loads[i].in_flight)
+            uring_load_finish(&loads[i], 0, &error);
+    uring_close(&ring);
+
+    if (error != NULL) {
+        Py_INCREF(Py_TYPE(error));
+        PyErr_Restore((PyObject*) Py_TYPE(error), error, PyException_GetTraceback(error));
+        Py_CLEAR(results);
+    }
+
+exit:
+    for (i = 0; i < length; i++) {
+        if (results != NULL)
+            PyList_SET_ITEM(results, i, loads[i].result);
+        else
+            Py_XDECREF(loads[i].result);
+    }
+    PyMem_Free(loads);
+    Py_DECREF(seq);
+    return results;
+#endif
 }
 
-static void
-cursormodule_free(PyObject *mod) {
-    cursormodule_clear(mod);
+static PyObject*
+iocursor_cursor_uring_load(PyObject* module, PyObject* args, PyObject* kwargs)
+{
+    PyObject* return_value = NULL;
+    PyObject* items;
+    int       queue_depth  = 32;
+
+    static char* keywords[] = {"items", "queue_depth", NULL};
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", keywords, &items, &queue_depth)) {
+        return_value = iocursor_cursor_uring_load_impl(module, items, queue_depth);
+    }
+
+    return return_value;
 }
 
 static struct PyMethodDef cursormodule_methods[] = {
+    {"copy_engine",   (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_copy_engine,       METH_VARARGS | METH_KEYWORDS, iocursor_cursor_copy_engine___doc__},
+    {"live_cursors",  (PyCFunction)                          iocursor_cursor_live_cursors_impl, METH_NOARGS,                  iocursor_cursor_live_cursors___doc__},
+    {"track_exports", (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_track_exports,     METH_VARARGS | METH_KEYWORDS, iocursor_cursor_track_exports___doc__},
+    {"uring_load",    (PyCFunction)(PyCFunctionWithKeywords) iocursor_cursor_uring_load,        METH_VARARGS | METH_KEYWORDS, iocursor_cursor_uring_load___doc__},
     {NULL, NULL}  /* sentinel */
 };
 
@@ -1120,6 +8124,7 @@ PyInit_cursor(void)
 {
     PyObject* m           = NULL;
     PyObject* _io         = NULL;
+    PyObject* array       = NULL;
     PyCursor_State* state = NULL;
 
     /* Create the module and initialize state */
@@ -1129,12 +8134,34 @@ PyInit_cursor(void)
     state = cursormodule_getstate(m);
     state->initialized = 0;
     state->unsupported_operation = NULL;
+    state->array_type = NULL;
+
+    /* Tune the copy engine for the host */
+    copy_engine_init();
 
     /* Add the `Cursor` class to the module */
     if (PyType_Ready(&PyCursor_Type) < 0)
         goto fail;
     if (PyModule_AddObject(m, "Cursor", (PyObject*) &PyCursor_Type) < 0)
         goto fail;
+    if (PyType_Ready(&PyBitCursor_Type) < 0)
+        goto fail;
+    Py_INCREF(&PyBitCursor_Type);
+    if (PyModule_AddObject(m, "BitCursor", (PyObject*) &PyBitCursor_Type) < 0)
+        goto fail;
+    if (PyType_Ready(&PyCheckpoint_Type) < 0)
+        goto fail;
+    if (PyType_Ready(&PyFrameIterator_Type) < 0)
+        goto fail;
+    if (PyType_Ready(&PyRecordIterator_Type) < 0)
+        goto fail;
+    if (PyType_Ready(&PyTextCursor_Type) < 0)
+        goto fail;
+    Py_INCREF(&PyTextCursor_Type);
+    if (PyModule_AddObject(m, "TextCursor", (PyObject*) &PyTextCursor_Type) < 0)
+        goto fail;
+    if (PyModule_AddIntConstant(m, "TRACEMALLOC_DOMAIN", CURSOR_TRACEMALLOC_DOMAIN) < 0)
+        goto fail;
 
     /* Import the _io module and get the `UnsupportedOperation` exception */
     _io = PyImport_ImportModule("_io");
@@ -1146,6 +8173,15 @@ PyInit_cursor(void)
     if (PyModule_AddObject(m, "UnsupportedOperation", state->unsupported_operation) < 0)
         goto fail;
 
+    /* Import the array module and get the `array` type */
+    array = PyImport_ImportModule("array");
+    if (array == NULL)
+        goto fail;
+    state->array_type = PyObject_GetAttrString(array, "array");
+    Py_DECREF(array);
+    if (state->array_type == NULL)
+        goto fail;
+
     /* Increate the reference count for classes stored in the module */
     Py_INCREF(&PyCursor_Type);
     Py_INCREF(state->unsupported_operation);
@@ -1157,6 +8193,7 @@ fail:
     Py_DECREF(m);
     Py_XDECREF(&PyCursor_Type);
     Py_XDECREF(state->unsupported_operation);
+    Py_XDECREF(state->array_type);
     return NULL;
 }
 
@@ -1185,6 +8222,13 @@ PyCursor_getunsupportedoperation(void)
     return (state == NULL) ? NULL : state->unsupported_operation;
 }
 
+static PyObject*
+PyCursor_getarraytype(void)
+{
+    PyCursor_State* state = PyCursor_getstate();
+    return (state == NULL) ? NULL : state->array_type;
+}
+
 #else
 
 static PyObject*
@@ -1199,4 +8243,18 @@ PyCursor_getunsupportedoperation(void)
     return err;
 }
 
+static PyObject*
+PyCursor_getarraytype(void)
+{
+    PyObject* type  = NULL;
+    PyObject* array = PyImport_ImportModule("array");
+
+    if (array != NULL) {
+        type = PyObject_GetAttrString(array, "array");
+        Py_DECREF(array);
+    }
+
+    return type;
+}
+
 #endif
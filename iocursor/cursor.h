@@ -4,23 +4,176 @@
 #include <stdbool.h>
 #include <Python.h>
 
+/* The operations recorded in the I/O statistics of a cursor */
+typedef enum {
+    CURSOR_OP_READ,
+    CURSOR_OP_READINTO,
+    CURSOR_OP_READLINE,
+    CURSOR_OP_READLINES,
+    CURSOR_OP_SEEK,
+    CURSOR_OP_WRITE,
+    CURSOR_OP_WRITELINES,
+    CURSOR_OP_MAX,
+} cursor_op;
+
+/* The number of buckets in the log2 histogram of request sizes */
+#define CURSOR_HISTOGRAM_SIZE 64
+
+typedef struct {
+    unsigned long long calls[CURSOR_OP_MAX];
+    unsigned long long bytes_read;
+    unsigned long long bytes_written;
+    unsigned long long seek_distance;
+    unsigned long long backward_seeks;
+    unsigned long long histogram[CURSOR_HISTOGRAM_SIZE];
+} cursor_stats;
+
+/* A single operation recorded in the access trace of a cursor */
+typedef struct {
+    unsigned char      op;
+    unsigned long long offset;
+    unsigned long long size;
+} cursor_trace_record;
+
+typedef struct {
+    size_t               length;
+    size_t               capacity;
+    size_t               dropped;  /* records lost because of allocation failures */
+    cursor_trace_record* records;
+} cursor_trace;
+
+/* A range of the buffer saved to the undo log before being overwritten */
 typedef struct {
+    Py_ssize_t offset;  /* the position of the range in the buffer */
+    Py_ssize_t length;  /* the length of the range */
+    size_t     data;    /* the position of the saved bytes in the log data */
+} cursor_undo_record;
+
+/* The state of the undo log when a checkpoint was made */
+typedef struct {
+    unsigned long long id;      /* a unique identifier for the checkpoint */
+    Py_ssize_t         offset;  /* the cursor position to restore */
+    size_t             records; /* the number of records to keep */
+    size_t             size;    /* the size of the log data to keep */
+} cursor_undo_mark;
+
+typedef struct {
+    size_t              depth;          /* the number of active checkpoints */
+    size_t              marks_capacity;
+    cursor_undo_mark*   marks;
+    size_t              length;         /* the number of records */
+    size_t              capacity;
+    cursor_undo_record* records;
+    size_t              size;           /* the number of saved bytes */
+    size_t              allocated;
+    char*               data;
+    unsigned long long  next_id;
+} cursor_undo;
+
+typedef struct cursor {
     PyObject_HEAD
-    bool        closed;
-    bool        readonly; /* whether the cursor is in read-only mode or not */
-    Py_ssize_t  offset;   /* the current position of the cursor in the file */
-    PyObject*   source;   /* the object the cursor was created to wrap */
-    Py_buffer   buffer;   /* an exported buffer view of the source object */
+    bool          closed;
+    bool          readonly; /* whether the cursor is in read-only mode or not */
+    bool          copy_on_write; /* whether to copy the buffer on the first write */
+    Py_ssize_t    offset;   /* the current position of the cursor in the file */
+    PyObject*     source;   /* the object the cursor was created to wrap */
+    Py_buffer     buffer;   /* an exported buffer view of the source object */
+    cursor_stats* stats;    /* the I/O statistics, or NULL when disabled */
+    cursor_trace* trace;    /* the access trace, or NULL when disabled */
+    cursor_undo*  undo;     /* the undo log, or NULL until a checkpoint is made */
+    Py_ssize_t    exports;  /* the number of buffer views exported by the cursor */
+    Py_ssize_t    view_start;  /* the start of the next exported view */
+    Py_ssize_t    view_length; /* the length of the next exported view, or -1 */
+    bool          reserved;       /* whether a reservation is waiting for a commit */
+    Py_ssize_t    reserve_offset; /* the start of the pending reservation */
+    Py_ssize_t    reserve_size;   /* the size of the pending reservation */
+    void*         memory;      /* aligned memory owned by the cursor, or NULL */
+    size_t        memory_size; /* the size of `memory` if it was mapped, or 0 */
+    bool          registered;  /* whether the cursor is in the export registry */
+    PyObject*     registry_traceback;  /* the stack when the buffer was exported */
+    struct cursor* registry_prev;
+    struct cursor* registry_next;
 } cursor;
 
+/* The layout of the sorted records searched by `Cursor.bisect` */
+typedef struct {
+    Py_ssize_t record_size; /* the size of each record */
+    Py_ssize_t key_offset;  /* the offset of the key in each record */
+    Py_ssize_t key_size;    /* the size of the key, or -1 for the rest of the record */
+    bool       integer;     /* whether the key is an integer instead of raw bytes */
+    bool       is_signed;   /* whether the integer key is signed */
+    bool       big_endian;  /* whether the integer key is big-endian */
+} record_layout;
+
+/* The length prefixes supported by `Cursor.iter_frames` */
+typedef enum {
+    FRAME_PREFIX_U16LE,
+    FRAME_PREFIX_U16BE,
+    FRAME_PREFIX_U32LE,
+    FRAME_PREFIX_U32BE,
+    FRAME_PREFIX_VARINT,
+} frame_prefix;
+
+typedef struct {
+    PyObject_HEAD
+    cursor*      cursor;   /* the cursor the frames are read from */
+    frame_prefix prefix;   /* the encoding of the frame lengths */
+    Py_ssize_t   max_size; /* the maximum size of a frame, or -1 */
+    bool         copy;     /* whether to yield `bytes` instead of views */
+    bool         strict;   /* whether to raise on a truncated trailing frame */
+} frame_iterator;
+
+typedef struct {
+    PyObject_HEAD
+    cursor*    cursor;   /* the cursor the records are read from */
+    char       sep;      /* the field separator */
+    char       line_sep; /* the record separator */
+    bool       copy;     /* whether to yield `bytes` instead of views */
+} record_iterator;
+
+/* The use of the bit register of a `BitCursor` */
+typedef enum {
+    BIT_MODE_SYNCED,
+    BIT_MODE_READ,
+    BIT_MODE_WRITE,
+} bit_mode;
+
+typedef struct {
+    PyObject_HEAD
+    cursor*    cursor;   /* the cursor the bits are read from or written to */
+    uint64_t   reg;      /* the bits loaded from or pending for the buffer */
+    int        count;    /* the number of valid bits in `reg` */
+    int        bit;      /* the bit offset in the current byte when synced */
+    bit_mode   mode;     /* whether `reg` is used for reading or writing */
+    bool       lsb;      /* whether bits are ordered least significant first */
+} bit_cursor;
+
+typedef struct {
+    PyObject_HEAD
+    cursor*            cursor;  /* the cursor the checkpoint was made on */
+    unsigned long long id;      /* the identifier of the checkpoint mark */
+} checkpoint;
+
+typedef struct {
+    PyObject_HEAD
+    cursor*    cursor;   /* the cursor the text is read from */
+} text_cursor;
+
 typedef struct {
     int initialized;
     PyObject *unsupported_operation;
+    PyObject *array_type;
 } PyCursor_State;
 
 PyTypeObject PyCursor_Type;
+PyTypeObject PyBitCursor_Type;
+PyTypeObject PyCheckpoint_Type;
+PyTypeObject PyFrameIterator_Type;
+PyTypeObject PyRecordIterator_Type;
+PyTypeObject PyTextCursor_Type;
 
 static PyCursor_State* PyCursor_getstate(void);
 static PyObject* PyCursor_getunsupportedoperation(void);
+static PyObject* PyCursor_getarraytype(void);
 
 #endif
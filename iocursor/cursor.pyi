@@ -1,34 +1,179 @@
+import array
 import io
 import os
+import traceback
 import types
 import typing
 
 Buffer = typing.Union[bytes, bytearray, memoryview]
 B = typing.TypeVar("B", bytes, bytearray, memoryview)
 
+_ByteOrder = typing.Literal["<", ">", "!", "=", "@", "little", "big", "native"]
+_FramePrefix = typing.Literal["u16le", "u16be", "u32le", "u32be", "varint"]
+_BitOrder = typing.Literal["msb", "lsb"]
+_KeyType = typing.Literal[
+    "bytes",
+    "u8", "i8",
+    "u16le", "u16be", "i16le", "i16be",
+    "u32le", "u32be", "i32le", "i32be",
+    "u64le", "u64be", "i64le", "i64be",
+]
+
+TRACEMALLOC_DOMAIN: int
+
+
+class _HasFileno(typing.Protocol):
+    def fileno(self) -> int: ...
+
+
+class _Stats(typing.TypedDict):
+    calls: typing.Dict[str, int]
+    bytes_read: int
+    bytes_written: int
+    seek_distance: int
+    backward_seeks: int
+    histogram: typing.List[int]
+
+
+class _CopyEngine(typing.TypedDict):
+    streaming: bool
+    stream_size: int
+    parallel_size: int
+    threads: int
+
+
+class _CursorInfo(typing.TypedDict):
+    cursor: Cursor[typing.Any]
+    source_type: str
+    size: int
+    offset: int
+    traceback: typing.Optional[traceback.StackSummary]
+
 
 class Cursor(typing.BinaryIO, typing.Generic[B]):
-    def __init__(self, buffer: B) -> None: ...
+    def __init__(self, buffer: B, readonly: bool = False, stats: bool = False, trace: bool = False, copy_on_write: bool = False) -> None: ...
+    @classmethod
+    def allocate(cls, size: int, alignment: int = 4096, hugepages: bool = False) -> Cursor[memoryview]: ...
     def __enter__(self) -> Cursor[B]: ...
     def __exit__(self, exc_type: typing.Optional[typing.Type[BaseException]]=None, exc_value: typing.Optional[BaseException] = None, traceback: typing.Optional[types.TracebackType]=None) -> bool: ...
     def __iter__(self) -> Cursor[B]: ...
     def __next__(self) -> bytes: ...
+    def bisect(self, key: typing.Union[bytes, int], record_size: int, key_offset: int = 0, key_size: typing.Optional[int] = None, key_type: _KeyType = "bytes", seek: bool = False) -> int: ...
+    def bisect_many(self, keys: typing.Iterable[typing.Union[bytes, int]], record_size: int, key_offset: int = 0, key_size: typing.Optional[int] = None, key_type: _KeyType = "bytes") -> typing.List[int]: ...
+    def bits(self, order: _BitOrder = "msb") -> BitCursor: ...
+    def checkpoint(self) -> Checkpoint: ...
     def close(self) -> None: ...
+    def commit(self) -> None: ...
+    def commit_reserved(self, n: int) -> None: ...
+    def copy_within(self, src: int, dst: int, n: int) -> int: ...
+    def count(self, sub: Buffer, start: typing.Optional[int] = None, end: typing.Optional[int] = None) -> int: ...
+    def expect(self, prefix: Buffer) -> None: ...
     def fileno(self) -> int: ...
+    def fill(self, byte: int, n: int) -> int: ...
+    def find(self, sub: Buffer, start: typing.Optional[int] = None, end: typing.Optional[int] = None) -> int: ...
+    def find_any(self, subs: typing.Iterable[Buffer], start: typing.Optional[int] = None, end: typing.Optional[int] = None) -> typing.Tuple[int, int]: ...
     def flush(self) -> None: ...
     def isatty(self) -> bool: ...
+    @typing.overload
+    def iter_frames(self, prefix: _FramePrefix = "u32le", max_size: typing.Optional[int] = None, copy: typing.Literal[False] = False, strict: bool = True) -> typing.Iterator[memoryview]: ...
+    @typing.overload
+    def iter_frames(self, prefix: _FramePrefix = "u32le", max_size: typing.Optional[int] = None, *, copy: typing.Literal[True], strict: bool = True) -> typing.Iterator[bytes]: ...
+    @typing.overload
+    def iter_records(self, sep: bytes = b"\t", line_sep: bytes = b"\n", copy: typing.Literal[False] = False) -> typing.Iterator[typing.Tuple[memoryview, ...]]: ...
+    @typing.overload
+    def iter_records(self, sep: bytes = b"\t", line_sep: bytes = b"\n", *, copy: typing.Literal[True]) -> typing.Iterator[typing.Tuple[bytes, ...]]: ...
+    def mark(self) -> None: ...
+    def peek(self, size: typing.Optional[int] = 0) -> bytes: ...
     def read(self, size: typing.Optional[int] = -1) -> bytes: ...
+    def read_array(self, typecode: str, count: typing.Optional[int] = -1, byteorder: _ByteOrder = "<") -> array.array[typing.Any]: ...
+    def read_b64encode(self, size: typing.Optional[int] = -1) -> bytes: ...
+    @typing.overload
+    def read_fields(self, sep: bytes = b"\t", maxsplit: int = -1, copy: typing.Literal[False] = False) -> typing.List[memoryview]: ...
+    @typing.overload
+    def read_fields(self, sep: bytes = b"\t", maxsplit: int = -1, *, copy: typing.Literal[True]) -> typing.List[bytes]: ...
+    @typing.overload
+    def read_many(self, sizes: typing.Sequence[int], copy: typing.Literal[True] = True) -> typing.List[bytes]: ...
+    @typing.overload
+    def read_many(self, sizes: typing.Sequence[int], copy: typing.Literal[False]) -> typing.List[memoryview]: ...
+    def read_view(self, size: typing.Optional[int] = -1) -> memoryview: ...
     def readable(self) -> bool: ...
     def readline(self, size: typing.Optional[int] = -1) -> bytes: ...
     def readlines(self, hint: typing.Optional[int] = -1) -> typing.List[bytes]: ...
+    def rebind(self, buffer: Buffer, readonly: bool = False, copy_on_write: bool = False) -> None: ...
+    def recv_from(self, source: typing.Union[int, _HasFileno], n: typing.Optional[int] = -1) -> int: ...
+    def reserve(self, n: int) -> memoryview: ...
+    def rfind(self, sub: Buffer, start: typing.Optional[int] = None, end: typing.Optional[int] = None) -> int: ...
+    def rollback(self) -> None: ...
     def seekable(self) -> bool: ...
+    def skip(self, n: int) -> None: ...
+    @typing.overload
+    def split_aligned(self, n_parts: int, sep: bytes = b"\n", ranges: typing.Literal[False] = False) -> typing.List[Cursor[memoryview]]: ...
+    @typing.overload
+    def split_aligned(self, n_parts: int, sep: bytes = b"\n", *, ranges: typing.Literal[True]) -> typing.List[typing.Tuple[int, int]]: ...
+    def send_to(self, target: typing.Union[int, _HasFileno], n: typing.Optional[int] = -1) -> int: ...
     def seek(self, offset: int, whence: int = os.SEEK_SET) -> int: ...
+    def seek_to(self, sub: Buffer, end: typing.Optional[int] = None) -> int: ...
+    def stats(self, reset: bool = False) -> typing.Optional[_Stats]: ...
     def tell(self) -> int: ...
+    def text(self) -> TextCursor: ...
+    def trace(self, reset: bool = False) -> typing.Optional[bytes]: ...
     def truncate(self, size: typing.Optional[int] = None) -> int: ...
     def writable(self) -> bool: ...
+    def write_at(self, offset: int, data: Buffer) -> int: ...
+    def write_b64decode(self, data: typing.Union[str, Buffer]) -> int: ...
+    def write_hexdecode(self, data: typing.Union[str, Buffer]) -> int: ...
     def writelines(self, lines: typing.Iterable[Buffer]) -> None: ...
+    def zero(self, n: int) -> int: ...
     def read1(self, size: typing.Optional[int] = -1) -> bytes: ...
     def readinto(self, b: Buffer) -> int: ...
+    def readinto_array(self, target: typing.Any, byteorder: _ByteOrder = "<") -> int: ...
     def readinto1(self, b: Buffer) -> int: ...
     def write(self, b: Buffer) -> int: ...
+    def getbuffer(self) -> memoryview: ...
     def getvalue(self) -> B: ...
+
+class BitCursor:
+    def __init__(self, buffer: typing.Union[Cursor[typing.Any], Buffer], order: _BitOrder = "msb") -> None: ...
+    def __enter__(self) -> BitCursor: ...
+    def __exit__(self, exc_type: typing.Optional[typing.Type[BaseException]]=None, exc_value: typing.Optional[BaseException] = None, traceback: typing.Optional[types.TracebackType]=None) -> None: ...
+    @property
+    def buffer(self) -> Cursor[typing.Any]: ...
+    @property
+    def order(self) -> _BitOrder: ...
+    def align(self) -> None: ...
+    def flush(self) -> None: ...
+    def peek_bits(self, n: int) -> int: ...
+    def read_bits(self, n: int) -> int: ...
+    def skip_bits(self, n: int) -> None: ...
+    def tell(self) -> int: ...
+    def write_bits(self, value: int, n: int) -> None: ...
+
+class Checkpoint:
+    def __enter__(self) -> Checkpoint: ...
+    def __exit__(self, exc_type: typing.Optional[typing.Type[BaseException]]=None, exc_value: typing.Optional[BaseException] = None, traceback: typing.Optional[types.TracebackType]=None) -> bool: ...
+    @property
+    def active(self) -> bool: ...
+    @property
+    def cursor(self) -> Cursor[typing.Any]: ...
+    def commit(self) -> None: ...
+    def rollback(self) -> None: ...
+
+class TextCursor(typing.Iterator[str]):
+    def __init__(self, buffer: typing.Union[Cursor[typing.Any], Buffer]) -> None: ...
+    def __iter__(self) -> TextCursor: ...
+    def __next__(self) -> str: ...
+    @property
+    def buffer(self) -> Cursor[typing.Any]: ...
+    @property
+    def closed(self) -> bool: ...
+    def close(self) -> None: ...
+    def read(self, size: typing.Optional[int] = -1) -> str: ...
+    def readline(self, size: typing.Optional[int] = -1) -> str: ...
+    def readlines(self, hint: typing.Optional[int] = -1) -> typing.List[str]: ...
+    def seek(self, offset: int, whence: int = os.SEEK_SET) -> int: ...
+    def tell(self) -> int: ...
+
+def copy_engine(stream_size: typing.Optional[int] = None, parallel_size: typing.Optional[int] = None, threads: typing.Optional[int] = None) -> _CopyEngine: ...
+def live_cursors() -> typing.List[_CursorInfo]: ...
+def track_exports(enable: bool = True, frames: int = 16) -> None: ...
+def uring_load(items: typing.Sequence[typing.Tuple[typing.Union[int, typing.IO[bytes]], Cursor]], queue_depth: int = 32) -> typing.List[typing.Union[int, Exception]]: ...
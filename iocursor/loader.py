@@ -0,0 +1,136 @@
+# coding: utf-8
+"""Concurrent loading of many files into preallocated cursors.
+"""
+
+import itertools
+import os
+import threading
+import typing
+
+from .cursor import Cursor, uring_load
+
+__all__ = ["load_many"]
+
+_Source = typing.Union[int, str, bytes, "os.PathLike[str]", "os.PathLike[bytes]"]
+_Result = typing.Union[int, Exception]
+
+# cleared the first time io_uring cannot be set up, since it will not
+# become available later (missing kernel support or blocked by seccomp)
+_uring_available = True
+
+
+def _load(source: _Source, cursor: Cursor) -> int:
+    if isinstance(source, int):
+        return cursor.recv_from(source)
+    fd = os.open(source, os.O_RDONLY | getattr(os, "O_BINARY", 0))
+    try:
+        return cursor.recv_from(fd)
+    finally:
+        os.close(fd)
+
+
+def _load_uring(
+    items: typing.List[typing.Tuple[_Source, Cursor]],
+    queue_depth: int,
+) -> typing.List[_Result]:
+    results = typing.cast(typing.List[_Result], [None] * len(items))
+    indices, batch, opened = [], [], []
+    try:
+        # files are opened sequentially, only their reads are concurrent
+        for index, (source, cursor) in enumerate(items):
+            if isinstance(source, int):
+                fd = source
+            else:
+                try:
+                    fd = os.open(source, os.O_RDONLY | getattr(os, "O_BINARY", 0))
+                except OSError as err:
+                    results[index] = err
+                    continue
+                opened.append(fd)
+            indices.append(index)
+            batch.append((fd, cursor))
+        for index, result in zip(indices, uring_load(batch, queue_depth)):
+            results[index] = result
+    finally:
+        for fd in opened:
+            os.close(fd)
+    return results
+
+
+def _load_threads(
+    items: typing.List[typing.Tuple[_Source, Cursor]],
+    queue_depth: int,
+) -> typing.List[_Result]:
+    results = typing.cast(typing.List[_Result], [None] * len(items))
+    indices = itertools.count()
+
+    def worker() -> None:
+        # `next` on `itertools.count` is atomic, so that each item is
+        # only loaded once without an explicit lock
+        for index in iter(indices.__next__, None):
+            if index >= len(items):
+                break
+            source, cursor = items[index]
+            try:
+                results[index] = _load(source, cursor)
+            except Exception as err:
+                results[index] = err
+
+    threads = [
+        threading.Thread(target=worker, daemon=True)
+        for _ in range(min(queue_depth, len(items)) - 1)
+    ]
+    for thread in threads:
+        thread.start()
+    worker()
+    for thread in threads:
+        thread.join()
+
+    return results
+
+
+def load_many(
+    items: typing.Iterable[typing.Tuple[_Source, Cursor]],
+    queue_depth: int = 32,
+) -> typing.List[_Result]:
+    """Read many files into the buffers of many cursors concurrently.
+
+    Each file is read from its current position, directly into the
+    buffer of its cursor at the cursor position, until EOF or until the
+    buffer is full, with up to ``queue_depth`` files read at the same
+    time. On Linux 5.6 and later, the reads are submitted to the kernel
+    through io_uring. Elsewhere, or when io_uring is not permitted, they
+    are done by `Cursor.recv_from` in a pool of threads, since it does
+    not hold the GIL while waiting for the system.
+
+    Arguments:
+        items (iterable of tuple): Pairs of files to read, given as a
+            path or as an open file descriptor, and of writable cursors
+            to read them into. File descriptors are not closed.
+        queue_depth (int): The maximum number of files read at the
+            same time.
+
+    Returns:
+        `list`: The result of each read, in the same order as ``items``:
+        either the number of bytes read into the cursor, or the
+        exception raised while opening or reading the file.
+
+    Example:
+        >>> cursors = [Cursor(bytearray(size)) for size in sizes]
+        >>> results = load_many(zip(paths, cursors))
+        >>> failed = [r for r in results if isinstance(r, Exception)]
+
+    """
+    items = list(items)
+    if queue_depth < 1:
+        raise ValueError("queue_depth must be at least 1")
+    if len({id(cursor) for _, cursor in items}) != len(items):
+        raise ValueError("cursors must not be loaded more than once")
+
+    global _uring_available
+    if _uring_available and items:
+        try:
+            return _load_uring(items, queue_depth)
+        except OSError:
+            _uring_available = False
+    return _load_threads(items, queue_depth)
@@ -0,0 +1,109 @@
+# coding: utf-8
+
+import asyncio
+import unittest
+
+from iocursor import Cursor
+from iocursor.aio import AsyncCursor
+
+
+def run(coro):
+    # the coroutines of `AsyncCursor` must complete without suspending
+    try:
+        coro.send(None)
+    except StopIteration as stop:
+        return stop.value
+    raise AssertionError("coroutine was suspended")
+
+
+class TestAsyncCursor(unittest.TestCase):
+
+    def test_read(self):
+        reader = AsyncCursor(b"abcdef")
+        self.assertEqual(run(reader.read(0)), b"")
+        self.assertEqual(run(reader.read(2)), b"ab")
+        self.assertEqual(run(reader.read()), b"cdef")
+        self.assertEqual(run(reader.read()), b"")
+        self.assertTrue(reader.at_eof())
+
+    def test_readexactly(self):
+        reader = AsyncCursor(b"abcdef")
+        self.assertEqual(run(reader.readexactly(4)), b"abcd")
+        self.assertRaises(ValueError, run, reader.readexactly(-1))
+        with self.assertRaises(asyncio.IncompleteReadError) as ctx:
+            run(reader.readexactly(4))
+        self.assertEqual(ctx.exception.partial, b"ef")
+        self.assertEqual(ctx.exception.expected, 4)
+        self.assertTrue(reader.at_eof())
+
+    def test_readuntil(self):
+        reader = AsyncCursor(b"a\r\nbc\r\nd")
+        self.assertEqual(run(reader.readuntil(b"\r\n")), b"a\r\n")
+        self.assertEqual(run(reader.readuntil(b"\r\n")), b"bc\r\n")
+        self.assertRaises(ValueError, run, reader.readuntil(b""))
+        with self.assertRaises(asyncio.IncompleteReadError) as ctx:
+            run(reader.readuntil(b"\r\n"))
+        self.assertEqual(ctx.exception.partial, b"d")
+        self.assertIs(ctx.exception.expected, None)
+
+    def test_readuntil_limit(self):
+        reader = AsyncCursor(b"abcd\nefghij", limit=3)
+        with self.assertRaises(asyncio.LimitOverrunError) as ctx:
+            run(reader.readuntil(b"\n"))
+        self.assertEqual(ctx.exception.consumed, 4)
+        self.assertEqual(reader.cursor.tell(), 0)
+        reader.cursor.seek(5)
+        with self.assertRaises(asyncio.LimitOverrunError) as ctx:
+            run(reader.readuntil(b"\n"))
+        self.assertEqual(ctx.exception.consumed, 6)
+
+    def test_readuntil_stats(self):
+        cursor = Cursor(b"abcd\nefghij", stats=True)
+        reader = AsyncCursor(cursor, limit=3)
+        self.assertRaises(asyncio.LimitOverrunError, run, reader.readuntil(b"\r\n"))
+        self.assertEqual(cursor.stats()["calls"]["seek"], 0)
+        self.assertEqual(cursor.tell(), 0)
+
+    def test_readline(self):
+        reader = AsyncCursor(b"ab\ncd")
+        self.assertEqual(run(reader.readline()), b"ab\n")
+        self.assertEqual(run(reader.readline()), b"cd")
+        self.assertEqual(run(reader.readline()), b"")
+
+    def test_readline_limit(self):
+        reader = AsyncCursor(b"abcdef\ngh\nijklmn", limit=4)
+        self.assertRaises(ValueError, run, reader.readline())
+        self.assertEqual(run(reader.readline()), b"gh\n")
+        self.assertRaises(ValueError, run, reader.readline())
+        self.assertTrue(reader.at_eof())
+
+    def test_cursor(self):
+        cursor = Cursor(b"abc\ndef")
+        cursor.seek(4)
+        reader = AsyncCursor(cursor)
+        self.assertIs(reader.cursor, cursor)
+        self.assertEqual(run(reader.readline()), b"def")
+
+    def test_iter(self):
+        async def collect(reader):
+            lines = []
+            iterator = reader.__aiter__()
+            while True:
+                try:
+                    lines.append(await iterator.__anext__())
+                except StopAsyncIteration:
+                    return lines
+        reader = AsyncCursor(b"a\nb\nc")
+        self.assertEqual(run(collect(reader)), [b"a\n", b"b\n", b"c"])
+
+    def test_event_loop(self):
+        async def parse(reader):
+            size = await reader.readuntil(b"\r\n")
+            return await reader.readexactly(int(size))
+        loop = asyncio.new_event_loop()
+        try:
+            data = loop.run_until_complete(parse(AsyncCursor(b"5\r\nhello")))
+        finally:
+            loop.close()
+        self.assertEqual(data, b"hello")
+        self.assertIs(AsyncCursor(b"").exception(), None)
@@ -1,13 +1,29 @@
 # coding: utf-8
 
 import array
+import base64
+import bisect
+import ctypes
 import io
 import os
+import pickle
+import random
+import socket
+import struct
 import sys
+import tempfile
+import threading
+import tracemalloc
 import unittest
 
 # import numpy
-from iocursor import Cursor
+from iocursor import BitCursor, Cursor, TextCursor, live_cursors, track_exports
+from iocursor.cursor import TRACEMALLOC_DOMAIN, copy_engine
+
+try:
+    import _testcapi
+except ImportError:
+    _testcapi = None
 
 
 class TestReadCursorMixin:
@@ -211,3 +227,1811 @@ class TestCursorArray(unittest.TestCase, TestWriteCursorMixin):
 #             self.assertTrue(numpy.all(first == second), *args, **kwargs)
 #         else:
 #             super().assertEqual(first, second, *args, **kwargs)
+
+
+class TestCursorStats(unittest.TestCase):
+
+    def test_failed_init(self):
+        cursor = Cursor(b"abcd", stats=True, trace=True)
+        cursor.read(2)
+        trace = cursor.trace()
+        with cursor.getbuffer():
+            self.assertRaises(BufferError, cursor.__init__, b"efgh", stats=True, trace=True)
+        self.assertEqual(cursor.stats()["bytes_read"], 2)
+        self.assertEqual(cursor.trace(), trace)
+        cursor.__init__(b"efgh", stats=True)
+        self.assertEqual(cursor.stats()["bytes_read"], 0)
+        self.assertIs(cursor.trace(), None)
+
+    def test_disabled(self):
+        cursor = Cursor(b"abcd")
+        cursor.read(2)
+        self.assertIs(cursor.stats(), None)
+
+    def test_read(self):
+        cursor = Cursor(b"abc\ndefgh\nijkl", stats=True)
+        self.assertEqual(cursor.read(2), b"ab")
+        self.assertEqual(cursor.readline(), b"c\n")
+        self.assertEqual(cursor.readinto(bytearray(4)), 4)
+        self.assertEqual(cursor.readlines(), [b"h\n", b"ijkl"])
+        stats = cursor.stats()
+        self.assertEqual(stats["calls"]["read"], 1)
+        self.assertEqual(stats["calls"]["readline"], 1)
+        self.assertEqual(stats["calls"]["readinto"], 1)
+        self.assertEqual(stats["calls"]["readlines"], 1)
+        self.assertEqual(stats["calls"]["write"], 0)
+        self.assertEqual(stats["bytes_read"], 14)
+        self.assertEqual(stats["bytes_written"], 0)
+        self.assertEqual(stats["histogram"][:4], [0, 0, 2, 2])
+
+    def test_write(self):
+        cursor = Cursor(bytearray(8), stats=True)
+        cursor.write(b"abc")
+        cursor.writelines([b"d", b"ef"])
+        stats = cursor.stats()
+        self.assertEqual(stats["calls"]["write"], 1)
+        self.assertEqual(stats["calls"]["writelines"], 1)
+        self.assertEqual(stats["bytes_written"], 6)
+
+    def test_seek(self):
+        cursor = Cursor(b"abcdefgh", stats=True)
+        cursor.seek(6)
+        cursor.seek(-4, os.SEEK_CUR)
+        cursor.seek(0, os.SEEK_END)
+        stats = cursor.stats()
+        self.assertEqual(stats["calls"]["seek"], 3)
+        self.assertEqual(stats["seek_distance"], 16)
+        self.assertEqual(stats["backward_seeks"], 1)
+
+    def test_reset(self):
+        cursor = Cursor(b"abcd", stats=True)
+        cursor.read()
+        self.assertEqual(cursor.stats(reset=True)["bytes_read"], 4)
+        self.assertEqual(cursor.stats()["bytes_read"], 0)
+        self.assertEqual(sum(cursor.stats()["histogram"]), 0)
+
+
+class TestCursorTrace(unittest.TestCase):
+
+    @staticmethod
+    def records(trace):
+        return list(struct.iter_unpack("<BQQ", trace[13:]))
+
+    def test_disabled(self):
+        cursor = Cursor(b"abcd")
+        cursor.read(2)
+        self.assertIs(cursor.trace(), None)
+
+    def test_trace(self):
+        cursor = Cursor(bytearray(b"abc\ndef\n"), trace=True)
+        cursor.readline()
+        cursor.seek(6)
+        cursor.read(10)
+        cursor.seek(0)
+        cursor.write(b"xy")
+        trace = cursor.trace()
+        self.assertEqual(trace[:13], b"IOCT\x01" + bytes(8))
+        self.assertEqual(
+            self.records(trace),
+            [(2, 0, 4), (4, 6, 0), (0, 6, 2), (4, 0, 0), (5, 0, 2)],
+        )
+
+    def test_reset(self):
+        cursor = Cursor(b"abcd", trace=True)
+        cursor.read(1)
+        self.assertEqual(len(self.records(cursor.trace(reset=True))), 1)
+        self.assertEqual(cursor.trace(), b"IOCT\x01" + bytes(8))
+
+    @unittest.skipUnless(hasattr(_testcapi, "set_nomemory"), "requires _testcapi.set_nomemory")
+    def test_dropped(self):
+        cursor = Cursor(b"abcd", trace=True)
+        for _ in range(256):
+            cursor.seek(0)
+        # the next record needs the trace to grow, which fails here
+        _testcapi.set_nomemory(0)
+        try:
+            cursor.seek(0)
+        finally:
+            _testcapi.remove_mem_hooks()
+        cursor.seek(1)
+        trace = cursor.trace()
+        self.assertEqual(struct.unpack_from("<Q", trace, 5), (1,))
+        self.assertEqual(len(self.records(trace)), 257)
+        self.assertEqual(self.records(trace)[-1], (4, 1, 0))
+        cursor.trace(reset=True)
+        self.assertEqual(cursor.trace(), b"IOCT\x01" + bytes(8))
+
+
+class TestCursorCodecs(unittest.TestCase):
+
+    def test_write_b64decode(self):
+        for data in (b"", b"a", b"ab", b"abc", b"abcd", bytes(range(256))):
+            encoded = base64.b64encode(data)
+            cursor = Cursor(bytearray(len(data) + 1))
+            self.assertEqual(cursor.write_b64decode(encoded), len(data))
+            self.assertEqual(cursor.tell(), len(data))
+            self.assertEqual(cursor.getvalue()[:len(data)], data)
+        cursor = Cursor(bytearray(3))
+        self.assertEqual(cursor.write_b64decode("YWJj"), 3)
+        self.assertEqual(cursor.getvalue(), b"abc")
+
+    def test_write_b64decode_invalid(self):
+        cursor = Cursor(bytearray(16))
+        self.assertRaises(ValueError, cursor.write_b64decode, b"YWJ")
+        self.assertRaises(ValueError, cursor.write_b64decode, b"YW=j")
+        self.assertRaises(ValueError, cursor.write_b64decode, b"Y===")
+        self.assertRaises(ValueError, cursor.write_b64decode, b"YW\nj")
+        self.assertEqual(cursor.tell(), 0)
+
+    def test_write_b64decode_overflow(self):
+        cursor = Cursor(bytearray(2))
+        self.assertRaises(BufferError, cursor.write_b64decode, b"YWJj")
+        self.assertEqual(cursor.getvalue(), bytearray(2))
+        cursor = Cursor(b"abc")
+        self.assertRaises(io.UnsupportedOperation, cursor.write_b64decode, b"YWJj")
+
+    def test_write_hexdecode(self):
+        cursor = Cursor(bytearray(4))
+        self.assertEqual(cursor.write_hexdecode("0aFf"), 2)
+        self.assertEqual(cursor.write_hexdecode(b"10"), 1)
+        self.assertEqual(cursor.getvalue(), b"\x0a\xff\x10\x00")
+        self.assertRaises(ValueError, cursor.write_hexdecode, b"1")
+        self.assertRaises(ValueError, cursor.write_hexdecode, b"1g")
+        self.assertRaises(BufferError, cursor.write_hexdecode, b"0000")
+
+    def test_read_b64encode(self):
+        data = bytes(range(256))
+        cursor = Cursor(data)
+        self.assertEqual(cursor.read_b64encode(10), base64.b64encode(data[:10]))
+        self.assertEqual(cursor.read_b64encode(1), base64.b64encode(data[10:11]))
+        self.assertEqual(cursor.read_b64encode(), base64.b64encode(data[11:]))
+        self.assertEqual(cursor.read_b64encode(), b"")
+
+
+class TestCursorGetbuffer(unittest.TestCase):
+
+    def test_getbuffer(self):
+        buffer = bytearray(b"abcd")
+        cursor = Cursor(buffer)
+        view = cursor.getbuffer()
+        self.assertEqual(view, b"abcd")
+        view[0] = ord("x")
+        self.assertEqual(buffer, b"xbcd")
+
+    def test_getbuffer_readonly(self):
+        cursor = Cursor(bytearray(b"abcd"), readonly=True)
+        view = cursor.getbuffer()
+        self.assertTrue(view.readonly)
+
+    def test_close_with_exports(self):
+        cursor = Cursor(b"abcd")
+        view = cursor.getbuffer()
+        self.assertRaises(BufferError, cursor.close)
+        self.assertRaises(BufferError, cursor.__init__, b"efgh")
+        view.release()
+        cursor.close()
+        self.assertTrue(cursor.closed)
+        self.assertRaises(ValueError, cursor.getbuffer)
+
+
+class TestCursorIterFrames(unittest.TestCase):
+
+    def test_u32le(self):
+        data = b"".join(struct.pack("<I", len(x)) + x for x in (b"abc", b"", b"defgh"))
+        cursor = Cursor(data)
+        frames = list(cursor.iter_frames())
+        self.assertTrue(all(isinstance(frame, memoryview) for frame in frames))
+        self.assertEqual([bytes(frame) for frame in frames], [b"abc", b"", b"defgh"])
+        self.assertEqual(cursor.tell(), len(data))
+
+    def test_prefixes(self):
+        for prefix, fmt in [("u16le", "<H"), ("u16be", ">H"), ("u32be", ">I")]:
+            data = struct.pack(fmt, 3) + b"abc" + struct.pack(fmt, 1) + b"d"
+            cursor = Cursor(data)
+            self.assertEqual(list(cursor.iter_frames(prefix, copy=True)), [b"abc", b"d"])
+        self.assertRaises(ValueError, Cursor(b"").iter_frames, "u64le")
+
+    def test_varint(self):
+        data = b"\x03abc" + b"\xac\x02" + b"x" * 300
+        frames = list(Cursor(data).iter_frames("varint", copy=True))
+        self.assertEqual(frames, [b"abc", b"x" * 300])
+        self.assertRaises(ValueError, list, Cursor(b"\xff" * 11).iter_frames("varint"))
+
+    def test_max_size(self):
+        cursor = Cursor(b"\x03\x00abc")
+        self.assertRaises(ValueError, list, cursor.iter_frames("u16le", max_size=2))
+        self.assertEqual(list(cursor.iter_frames("u16le", max_size=3, copy=True)), [b"abc"])
+
+    def test_truncated(self):
+        cursor = Cursor(b"\x01\x00a\x05\x00ab")
+        self.assertRaises(ValueError, list, cursor.iter_frames("u16le"))
+        cursor.seek(0)
+        self.assertEqual(list(cursor.iter_frames("u16le", strict=False, copy=True)), [b"a"])
+        self.assertEqual(cursor.tell(), 3)
+        cursor = Cursor(b"\x01\x00a\x05")
+        self.assertEqual(list(cursor.iter_frames("u16le", strict=False, copy=True)), [b"a"])
+
+    @unittest.skipIf(sys.implementation.name == "pypy", "views are released lazily on PyPy")
+    def test_views_block_close(self):
+        cursor = Cursor(b"\x01\x00a")
+        frames = list(cursor.iter_frames("u16le"))
+        self.assertRaises(BufferError, cursor.close)
+        del frames
+        cursor.close()
+
+
+class TestCursorFields(unittest.TestCase):
+
+    def test_read_fields(self):
+        cursor = Cursor(b"a\tbc\t\nd\n\nef")
+        fields = cursor.read_fields()
+        self.assertTrue(all(isinstance(field, memoryview) for field in fields))
+        self.assertEqual([bytes(field) for field in fields], [b"a", b"bc", b""])
+        self.assertEqual(cursor.read_fields(copy=True), [b"d"])
+        self.assertEqual(cursor.read_fields(copy=True), [b""])
+        self.assertEqual(cursor.read_fields(copy=True), [b"ef"])
+        self.assertEqual(cursor.read_fields(copy=True), [])
+
+    def test_read_fields_maxsplit(self):
+        for maxsplit in range(-1, 4):
+            cursor = Cursor(b"a,b,c,d\n")
+            self.assertEqual(
+                cursor.read_fields(b",", maxsplit, copy=True),
+                b"a,b,c,d".split(b",", maxsplit),
+            )
+
+    def test_read_fields_sep(self):
+        self.assertRaises(TypeError, Cursor(b"").read_fields, b",,")
+
+    def test_iter_records(self):
+        cursor = Cursor(b"a\tb\nc\td\n")
+        records = [tuple(map(bytes, r)) for r in cursor.iter_records()]
+        self.assertEqual(records, [(b"a", b"b"), (b"c", b"d")])
+        self.assertEqual(cursor.tell(), 8)
+
+    def test_iter_records_separators(self):
+        cursor = Cursor(b"a,b;;c")
+        records = list(cursor.iter_records(b",", b";", copy=True))
+        self.assertEqual(records, [(b"a", b"b"), (b"",), (b"c",)])
+
+
+class TestCursorReadArray(unittest.TestCase):
+
+    def test_read_array(self):
+        values = array.array("f", [1.0, -2.5, 3.25])
+        cursor = Cursor(values.tobytes() + b"\x00")
+        result = cursor.read_array("f", byteorder="=")
+        self.assertEqual(result, values)
+        self.assertEqual(cursor.tell(), 12)
+
+    def test_read_array_byteorder(self):
+        for typecode, fmt in [("h", "h"), ("i", "i"), ("q", "q"), ("d", "d")]:
+            values = [1, 2, -3, 4]
+            for order in "<>":
+                data = struct.pack(order + fmt * len(values), *values)
+                cursor = Cursor(data)
+                result = cursor.read_array(typecode, 3, byteorder=order)
+                self.assertEqual(result.tolist(), values[:3])
+                self.assertEqual(cursor.tell(), 3 * struct.calcsize(fmt))
+
+    def test_read_array_invalid(self):
+        cursor = Cursor(b"abcd")
+        self.assertRaises(ValueError, cursor.read_array, "z")
+        self.assertRaises(ValueError, cursor.read_array, "h", byteorder="middle")
+
+    def test_readinto_array(self):
+        data = struct.pack(">5I", 1, 2, 3, 4, 5)
+        cursor = Cursor(data)
+        target = array.array("I", [0, 0, 0])
+        self.assertEqual(cursor.readinto_array(target, byteorder="big"), 3)
+        self.assertEqual(target.tolist(), [1, 2, 3])
+        self.assertEqual(cursor.readinto_array(target, byteorder="big"), 2)
+        self.assertEqual(target.tolist(), [4, 5, 3])
+        self.assertEqual(cursor.readinto_array(target, byteorder="big"), 0)
+
+
+class TestCursorPickle(unittest.TestCase):
+
+    def test_peek(self):
+        cursor = Cursor(b"abcdef")
+        self.assertEqual(cursor.peek(2), b"ab")
+        self.assertEqual(cursor.peek(), b"abcdef")
+        self.assertEqual(cursor.tell(), 0)
+        cursor.seek(4)
+        self.assertEqual(cursor.peek(10), b"ef")
+        cursor.seek(10)
+        self.assertEqual(cursor.peek(1), b"")
+
+    def test_positional_arguments(self):
+        cursor = Cursor(b"abc\ndef\n")
+        self.assertEqual(cursor.read(1), b"a")
+        self.assertEqual(cursor.readline(2), b"bc")
+        self.assertEqual(cursor.readline(), b"\n")
+        self.assertRaises(OverflowError, cursor.read, 1 << 70)
+        self.assertRaises(TypeError, cursor.read, 1, 2)
+        buffer = bytearray(2)
+        self.assertEqual(cursor.readinto(buffer), 2)
+        self.assertEqual(buffer, b"de")
+        self.assertRaises(TypeError, cursor.readinto, b"ab")
+
+    def test_positional_errors(self):
+        # `assertRaises` passes an empty `kwargs` dict, which bypasses the
+        # positional fast paths, so the methods are called directly here
+        cursor = Cursor(b"abc\ndef\n")
+        for method, arg in [
+            (cursor.readinto, b"ab"),
+            (cursor.readinto, memoryview(bytearray(8))[::2]),
+            (cursor.readinto, 1),
+            (cursor.read, 1.5),
+            (cursor.read, "1"),
+            (cursor.readline, 1.5),
+            (cursor.peek, "1"),
+        ]:
+            with self.assertRaises(TypeError):
+                method(arg)
+        for method in (cursor.read, cursor.readline, cursor.peek):
+            with self.assertRaises(OverflowError):
+                method(1 << 70)
+        self.assertEqual(cursor.tell(), 0)
+
+    def test_read_view(self):
+        cursor = Cursor(b"abcdef")
+        view = cursor.read_view(4)
+        self.assertIsInstance(view, memoryview)
+        self.assertEqual(view, b"abcd")
+        self.assertEqual(cursor.read_view(), b"ef")
+        self.assertEqual(cursor.read_view(), b"")
+
+    def test_pickle_load(self):
+        obj = {"a": [1, 2, 3], "b": b"x" * 100000}
+        data = pickle.dumps(obj, protocol=pickle.HIGHEST_PROTOCOL)
+        cursor = Cursor(data + b"tail")
+        self.assertEqual(pickle.load(cursor), obj)
+        self.assertEqual(cursor.read(), b"tail")
+
+    @unittest.skipUnless(hasattr(pickle, "PickleBuffer"), "requires pickle protocol 5")
+    def test_pickle_out_of_band(self):
+        source = bytearray(b"abc" * 1000)
+        buffers = []
+        data = pickle.dumps(pickle.PickleBuffer(source), protocol=5, buffer_callback=buffers.append)
+        cursor = Cursor(bytes(buffers[0].raw()))
+        obj = pickle.loads(data, buffers=[pickle.PickleBuffer(cursor.read_view(len(source)))])
+        self.assertEqual(memoryview(obj), source)
+        self.assertRaises(BufferError, cursor.close)
+
+
+class TestCursorCopyOnWrite(unittest.TestCase):
+
+    def test_read(self):
+        data = b"hello world"
+        cursor = Cursor(data, copy_on_write=True)
+        self.assertTrue(cursor.writable())
+        self.assertEqual(cursor.read(5), b"hello")
+        self.assertIs(cursor.getvalue(), data)
+        self.assertEqual(repr(cursor), "Cursor(b'hello world', copy_on_write=True)")
+
+    def test_write(self):
+        data = b"hello world"
+        cursor = Cursor(data, copy_on_write=True)
+        cursor.seek(6)
+        self.assertEqual(cursor.write(b"W"), 1)
+        self.assertEqual(cursor.tell(), 7)
+        self.assertEqual(cursor.getvalue(), bytearray(b"hello World"))
+        self.assertEqual(data, b"hello world")
+        cursor.write_at(0, b"H")
+        self.assertEqual(cursor.getvalue(), bytearray(b"Hello World"))
+        self.assertEqual(cursor.read(), b"orld")
+
+    def test_write_mutable(self):
+        data = bytearray(b"abc")
+        cursor = Cursor(data, copy_on_write=True)
+        cursor.fill(0x78, 2)
+        self.assertEqual(cursor.getvalue(), bytearray(b"xxc"))
+        self.assertEqual(data, bytearray(b"abc"))
+
+    def test_write_invalid(self):
+        data = b"abcd"
+        cursor = Cursor(data, copy_on_write=True)
+        self.assertRaises(BufferError, cursor.write_at, 10, b"x")
+        self.assertRaises(ValueError, cursor.write_at, -1, b"x")
+        self.assertRaises(BufferError, cursor.copy_within, 0, 3, 2)
+        self.assertRaises(ValueError, cursor.fill, 0, -1)
+        self.assertRaises(ValueError, cursor.write_b64decode, b"!")
+        cursor.seek(3)
+        self.assertRaises(BufferError, cursor.write, b"xy")
+        self.assertEqual(cursor.write(b""), 0)
+        self.assertIs(cursor.getvalue(), data)
+
+    def test_copy_within(self):
+        data = b"abcd"
+        cursor = Cursor(data, copy_on_write=True)
+        self.assertEqual(cursor.copy_within(0, 2, 2), 2)
+        self.assertEqual(cursor.getvalue(), bytearray(b"abab"))
+        self.assertEqual(data, b"abcd")
+
+    def test_write_exports(self):
+        cursor = Cursor(b"abc", copy_on_write=True)
+        view = cursor.getbuffer()
+        self.assertTrue(view.readonly)
+        self.assertRaises(BufferError, cursor.write, b"x")
+        view.release()
+        cursor.write(b"x")
+        self.assertEqual(cursor.getvalue(), bytearray(b"xbc"))
+
+    def test_writable_buffer(self):
+        data = b"abcdef"
+        cursor = Cursor(data, copy_on_write=True)
+        io.BytesIO(b"ZZ").readinto(cursor)
+        self.assertEqual(cursor.getvalue(), bytearray(b"ZZcdef"))
+        self.assertEqual(data, b"abcdef")
+
+    def test_readonly(self):
+        cursor = Cursor(b"abc", readonly=True, copy_on_write=True)
+        self.assertFalse(cursor.writable())
+        self.assertRaises(io.UnsupportedOperation, cursor.write, b"x")
+
+    def test_rebind(self):
+        cursor = Cursor(b"abc", copy_on_write=True)
+        cursor.write(b"x")
+        data = b"def"
+        cursor.rebind(data, copy_on_write=True)
+        cursor.write(b"y")
+        self.assertEqual(cursor.getvalue(), bytearray(b"yef"))
+        cursor.rebind(data)
+        self.assertFalse(cursor.writable())
+
+
+class TestCursorRebind(unittest.TestCase):
+
+    def test_rebind(self):
+        cursor = Cursor(b"abc")
+        self.assertEqual(cursor.read(2), b"ab")
+        self.assertIs(cursor.rebind(b"def"), None)
+        self.assertEqual(cursor.tell(), 0)
+        self.assertEqual(cursor.read(), b"def")
+        self.assertFalse(cursor.writable())
+
+    def test_rebind_writable(self):
+        cursor = Cursor(b"abc")
+        buffer = bytearray(3)
+        cursor.rebind(buffer)
+        self.assertTrue(cursor.writable())
+        cursor.write(b"xyz")
+        self.assertEqual(buffer, b"xyz")
+        cursor.rebind(buffer, readonly=True)
+        self.assertFalse(cursor.writable())
+
+    def test_rebind_closed(self):
+        cursor = Cursor(b"abc")
+        cursor.close()
+        cursor.rebind(b"def")
+        self.assertFalse(cursor.closed)
+        self.assertEqual(cursor.read(), b"def")
+
+    def test_rebind_exports(self):
+        cursor = Cursor(b"abc")
+        view = cursor.getbuffer()
+        self.assertRaises(BufferError, cursor.rebind, b"def")
+        view.release()
+        cursor.rebind(b"def")
+        self.assertEqual(cursor.read(), b"def")
+
+    def test_rebind_invalid(self):
+        cursor = Cursor(b"abc")
+        self.assertRaises(TypeError, cursor.rebind, 1)
+        self.assertTrue(cursor.closed)
+        self.assertRaises(TypeError, cursor.rebind)
+
+    def test_rebind_keeps_stats(self):
+        cursor = Cursor(b"abc", stats=True)
+        cursor.read()
+        cursor.rebind(b"defg")
+        cursor.read()
+        self.assertEqual(cursor.stats()["bytes_read"], 7)
+
+    def test_readonly_memoryview(self):
+        cursor = Cursor(memoryview(b"abc"))
+        self.assertFalse(cursor.writable())
+        cursor = Cursor(memoryview(bytearray(b"abc")))
+        self.assertTrue(cursor.writable())
+
+    def test_reuse(self):
+        # exercise the freelist with cursors of various buffers
+        cursors = [Cursor(bytearray(i)) for i in range(100)]
+        del cursors
+        for i in range(100):
+            cursor = Cursor(b"x" * i)
+            self.assertEqual(cursor.tell(), 0)
+            self.assertEqual(cursor.read(), b"x" * i)
+
+
+class TestCursorFind(unittest.TestCase):
+
+    def test_find(self):
+        cursor = Cursor(b"key: value\r\nkey\r\n")
+        self.assertEqual(cursor.find(b"\r\n"), 10)
+        self.assertEqual(cursor.find(b"key"), 0)
+        self.assertEqual(cursor.find(b"k"), 0)
+        self.assertEqual(cursor.find(b"xyz"), -1)
+        self.assertEqual(cursor.tell(), 0)
+
+    def test_find_position(self):
+        cursor = Cursor(b"abcabc")
+        cursor.seek(1)
+        self.assertEqual(cursor.find(b"abc"), 3)
+        self.assertEqual(cursor.find(b"abc", 0), 0)
+        self.assertEqual(cursor.find(b""), 1)
+        cursor.seek(6)
+        self.assertEqual(cursor.find(b"c"), -1)
+
+    def test_find_range(self):
+        cursor = Cursor(b"abcabc")
+        self.assertEqual(cursor.find(b"c", 0, 2), -1)
+        self.assertEqual(cursor.find(b"c", 0, 3), 2)
+        self.assertEqual(cursor.find(b"bc", -3), 4)
+        self.assertEqual(cursor.find(b"bc", 0, -1), 1)
+        self.assertEqual(cursor.find(b"a", 10), -1)
+        self.assertEqual(cursor.find(b"a", None, None), 0)
+
+    def test_find_errors(self):
+        cursor = Cursor(b"abc")
+        self.assertRaises(TypeError, cursor.find, "a")
+        cursor.close()
+        self.assertRaises(ValueError, cursor.find, b"a")
+
+    def _random_cases(self):
+        rng = random.Random(3)
+        for length in (0, 1, 15, 16, 17, 31, 40, 100, 257):
+            data = bytes(rng.choice(b"ab\r\n") for _ in range(length))
+            needles = [b"", b"a", b"\r\n", b"ab\r", b"\r\nab\r\n", data[3:20], data[-18:], b"x"]
+            for needle in needles:
+                yield data, needle
+
+    # slices compared with `bytes`, some starting past the end of the data
+    # where not even b"" is found
+    _slices = [(5, -3), (38, 58), (3, 1), (-100, 2), (0, 100)]
+
+    def test_find_random(self):
+        for data, needle in self._random_cases():
+            cursor = Cursor(data)
+            self.assertEqual(cursor.find(needle), data.find(needle))
+            for start, end in self._slices:
+                self.assertEqual(cursor.find(needle, start, end), data.find(needle, start, end))
+
+    def test_rfind(self):
+        cursor = Cursor(b"abcabc")
+        self.assertEqual(cursor.rfind(b"abc"), 3)
+        self.assertEqual(cursor.rfind(b"abc", 0, 5), 0)
+        self.assertEqual(cursor.rfind(b""), 6)
+        self.assertEqual(cursor.rfind(b"x"), -1)
+        self.assertEqual(cursor.rfind(b"a", 4, 2), -1)
+        cursor.seek(2)
+        self.assertEqual(cursor.rfind(b"ab"), 3)
+        self.assertEqual(cursor.rfind(b"ab", None, 5), 3)
+        self.assertEqual(cursor.rfind(b"ab", None, 4), -1)
+        self.assertEqual(cursor.tell(), 2)
+
+    def test_rfind_random(self):
+        for data, needle in self._random_cases():
+            cursor = Cursor(data)
+            self.assertEqual(cursor.rfind(needle), data.rfind(needle))
+            for start, end in self._slices:
+                self.assertEqual(cursor.rfind(needle, start, end), data.rfind(needle, start, end))
+
+    def test_count(self):
+        cursor = Cursor(b"aaaa")
+        self.assertEqual(cursor.count(b"aa"), 2)
+        self.assertEqual(cursor.count(b""), 5)
+        self.assertEqual(cursor.count(b"a", 1, 3), 2)
+        self.assertEqual(cursor.count(b"a", 3, 1), 0)
+        self.assertEqual(cursor.count(b"", 38, 58), 0)
+        self.assertEqual(cursor.rfind(b"", 38, 58), -1)
+        self.assertEqual(cursor.find(b"", 38, 58), -1)
+        self.assertEqual(cursor.find(b"", 4, 58), 4)
+        self.assertEqual(cursor.find_any([b""], 38, 58), (-1, -1))
+        cursor.seek(1)
+        self.assertEqual(cursor.count(b"aa"), 1)
+
+    def test_count_random(self):
+        for data, needle in self._random_cases():
+            cursor = Cursor(data)
+            self.assertEqual(cursor.count(needle), data.count(needle))
+            for start, end in self._slices:
+                self.assertEqual(cursor.count(needle, start, end), data.count(needle, start, end))
+
+    def test_find_any(self):
+        cursor = Cursor(b"data\r\n--sep\r\nmore\r\n--sep--\r\n")
+        subs = [b"\r\n--sep--", b"\r\n--sep"]
+        self.assertEqual(cursor.find_any(subs), (4, 1))
+        self.assertEqual(cursor.find_any(subs, 5), (17, 0))
+        self.assertEqual(cursor.find_any(reversed(subs), 5), (17, 0))
+        self.assertEqual(cursor.find_any([b"x", b"y"]), (-1, -1))
+        self.assertEqual(cursor.find_any([]), (-1, -1))
+        self.assertEqual(cursor.find_any([b"more", b"data"], 0, 10), (0, 1))
+        self.assertEqual(cursor.tell(), 0)
+        self.assertRaises(TypeError, cursor.find_any, 1)
+        self.assertRaises(TypeError, cursor.find_any, [b"a", "b"])
+
+    def test_seek_to(self):
+        cursor = Cursor(b"garbage\xff\xd8\xff\xe0\xff\xd8")
+        self.assertEqual(cursor.seek_to(b"\xff\xd8"), 7)
+        self.assertEqual(cursor.tell(), 7)
+        self.assertEqual(cursor.seek_to(b"\xff\xd8"), 7)
+        cursor.seek(8)
+        self.assertEqual(cursor.seek_to(b"\xff\xd8", 12), -1)
+        self.assertEqual(cursor.tell(), 8)
+        self.assertEqual(cursor.seek_to(b"\xff\xd8"), 11)
+        cursor.close()
+        self.assertRaises(ValueError, cursor.seek_to, b"a")
+
+
+class TestCursorFill(unittest.TestCase):
+
+    def test_fill(self):
+        buffer = bytearray(b"abcdef")
+        cursor = Cursor(buffer)
+        cursor.seek(1)
+        self.assertEqual(cursor.fill(0x2A, 3), 3)
+        self.assertEqual(cursor.tell(), 4)
+        self.assertEqual(buffer, b"a***ef")
+        self.assertEqual(cursor.fill(0x2A, 0), 0)
+        self.assertRaises(ValueError, cursor.fill, 256, 1)
+        self.assertRaises(ValueError, cursor.fill, -1, 1)
+        self.assertRaises(ValueError, cursor.fill, 0, -1)
+        self.assertRaises(BufferError, cursor.fill, 0, 3)
+        self.assertEqual(buffer, b"a***ef")
+
+    def test_fill_large(self):
+        buffer = bytearray(1 << 20)
+        cursor = Cursor(buffer)
+        self.assertEqual(cursor.fill(1, len(buffer)), len(buffer))
+        self.assertEqual(buffer.count(1), len(buffer))
+
+    def test_fill_pins_buffer(self):
+        # the GIL is released during large fills, which must keep the
+        # buffer exported so that another thread cannot close the cursor
+        buffer = bytearray(64 << 20)
+        cursor = Cursor(buffer)
+        started = threading.Event()
+        done = threading.Event()
+        result = []
+
+        def fill():
+            started.set()
+            try:
+                result.append(cursor.fill(0x2A, len(buffer)))
+            except ValueError:
+                pass  # the cursor was closed before the fill started
+            done.set()
+
+        thread = threading.Thread(target=fill)
+        thread.start()
+        started.wait()
+        closed_during_fill = False
+        while not cursor.closed:
+            try:
+                cursor.close()
+            except BufferError:
+                continue
+            closed_during_fill = not done.is_set()
+        thread.join()
+        if result:
+            self.assertFalse(closed_during_fill)
+
+    def test_zero(self):
+        buffer = bytearray(b"abcdef")
+        cursor = Cursor(buffer)
+        self.assertEqual(cursor.zero(2), 2)
+        self.assertEqual(buffer, b"\0\0cdef")
+        self.assertRaises(BufferError, cursor.zero, 5)
+        self.assertRaises(io.UnsupportedOperation, Cursor(b"abc").zero, 1)
+
+    def test_write_at(self):
+        buffer = bytearray(b"abcdef")
+        cursor = Cursor(buffer)
+        cursor.seek(2)
+        self.assertEqual(cursor.write_at(4, b"XY"), 2)
+        self.assertEqual(cursor.tell(), 2)
+        self.assertEqual(buffer, b"abcdXY")
+        self.assertEqual(cursor.write_at(6, b""), 0)
+        self.assertRaises(BufferError, cursor.write_at, 5, b"XY")
+        self.assertRaises(BufferError, cursor.write_at, 6, b"X")
+        self.assertRaises(ValueError, cursor.write_at, -1, b"X")
+        self.assertRaises(io.UnsupportedOperation, Cursor(b"abc").write_at, 0, b"X")
+
+    def test_copy_within(self):
+        buffer = bytearray(b"abcdef")
+        cursor = Cursor(buffer)
+        self.assertEqual(cursor.copy_within(0, 2, 4), 4)
+        self.assertEqual(buffer, b"ababcd")
+        self.assertEqual(cursor.copy_within(2, 0, 4), 4)
+        self.assertEqual(buffer, b"abcdcd")
+        self.assertEqual(cursor.tell(), 0)
+        self.assertRaises(BufferError, cursor.copy_within, 4, 0, 3)
+        self.assertRaises(BufferError, cursor.copy_within, 0, 4, 3)
+        self.assertRaises(ValueError, cursor.copy_within, -1, 0, 1)
+        self.assertEqual(buffer, b"abcdcd")
+
+    def test_closed(self):
+        cursor = Cursor(bytearray(4))
+        cursor.close()
+        self.assertRaises(ValueError, cursor.fill, 0, 1)
+        self.assertRaises(ValueError, cursor.zero, 1)
+        self.assertRaises(ValueError, cursor.write_at, 0, b"a")
+        self.assertRaises(ValueError, cursor.copy_within, 0, 1, 1)
+
+    def test_stats(self):
+        cursor = Cursor(bytearray(8), stats=True)
+        cursor.zero(4)
+        cursor.write_at(0, b"ab")
+        stats = cursor.stats()
+        self.assertEqual(stats["calls"]["write"], 2)
+        self.assertEqual(stats["bytes_written"], 6)
+
+
+class TestCursorTransfer(unittest.TestCase):
+
+    def test_send_to_fd(self):
+        r, w = os.pipe()
+        try:
+            cursor = Cursor(b"abcdef")
+            cursor.seek(1)
+            self.assertEqual(cursor.send_to(w, 3), 3)
+            self.assertEqual(cursor.tell(), 4)
+            self.assertEqual(cursor.send_to(w), 2)
+            self.assertEqual(cursor.send_to(w), 0)
+            self.assertEqual(os.read(r, 10), b"bcdef")
+        finally:
+            os.close(r)
+            os.close(w)
+
+    def test_recv_from_fd(self):
+        r, w = os.pipe()
+        try:
+            os.write(w, b"abcd")
+            os.close(w)
+            buffer = bytearray(6)
+            cursor = Cursor(buffer)
+            self.assertEqual(cursor.recv_from(r, 2), 2)
+            self.assertEqual(cursor.recv_from(r), 2)
+            self.assertEqual(cursor.tell(), 4)
+            self.assertEqual(buffer, b"abcd\0\0")
+            self.assertEqual(cursor.recv_from(r), 0)
+        finally:
+            os.close(r)
+
+    def test_recv_from_errors(self):
+        r, w = os.pipe()
+        try:
+            self.assertRaises(BufferError, Cursor(bytearray(2)).recv_from, r, 3)
+            self.assertRaises(io.UnsupportedOperation, Cursor(b"ab").recv_from, r, 1)
+            self.assertRaises(TypeError, Cursor(bytearray(2)).recv_from, "r", 1)
+            self.assertRaises(OSError, Cursor(bytearray(2)).recv_from, w, 1)
+        finally:
+            os.close(r)
+            os.close(w)
+
+    def test_file(self):
+        with io.BytesIO() as f:
+            self.assertRaises(io.UnsupportedOperation, Cursor(b"ab").send_to, f)
+        r, w = os.pipe()
+        with open(r, "rb") as fr, open(w, "wb") as fw:
+            self.assertEqual(Cursor(b"abc").send_to(fw), 3)
+            fw.close()
+            buffer = bytearray(4)
+            self.assertEqual(Cursor(buffer).recv_from(fr), 3)
+            self.assertEqual(buffer, b"abc\0")
+
+    @unittest.skipUnless(hasattr(socket, "socketpair"), "requires socket.socketpair")
+    def test_socket(self):
+        a, b = socket.socketpair()
+        with a, b:
+            data = os.urandom(1 << 16)
+            cursor = Cursor(data)
+            self.assertEqual(cursor.send_to(a, 1000), 1000)
+            buffer = bytearray(1000)
+            self.assertEqual(Cursor(buffer).recv_from(b), 1000)
+            self.assertEqual(buffer, data[:1000])
+            self.assertEqual(cursor.tell(), 1000)
+
+    @unittest.skipUnless(hasattr(socket, "socketpair"), "requires socket.socketpair")
+    def test_socket_nonblocking(self):
+        a, b = socket.socketpair()
+        with a, b:
+            b.setblocking(False)
+            a.sendall(b"abc")
+            buffer = bytearray(8)
+            cursor = Cursor(buffer)
+            self.assertEqual(cursor.recv_from(b.fileno()), 3)
+            self.assertEqual(buffer[:3], b"abc")
+            self.assertRaises(BlockingIOError, cursor.recv_from, b.fileno())
+            self.assertRaises(BlockingIOError, cursor.recv_from, b)
+            self.assertEqual(cursor.tell(), 3)
+
+    @unittest.skipUnless(hasattr(socket, "socketpair"), "requires socket.socketpair")
+    def test_socket_nonblocking_partial(self):
+        a, b = socket.socketpair()
+        with a, b:
+            a.setblocking(False)
+            data = os.urandom(1 << 24)
+            cursor = Cursor(data)
+            sent = cursor.send_to(a)
+            self.assertGreater(sent, 0)
+            self.assertLess(sent, len(data))
+            self.assertEqual(cursor.tell(), sent)
+            self.assertRaises(BlockingIOError, cursor.send_to, a)
+            b.setblocking(False)
+            buffer = bytearray(len(data))
+            received = Cursor(buffer)
+            self.assertEqual(received.recv_from(b), sent)
+            self.assertEqual(received.tell(), sent)
+            self.assertEqual(buffer[:sent], data[:sent])
+
+    def test_stats(self):
+        r, w = os.pipe()
+        try:
+            cursor = Cursor(bytearray(b"abcd"), stats=True)
+            cursor.send_to(w)
+            cursor.seek(0)
+            cursor.recv_from(r)
+            stats = cursor.stats()
+            self.assertEqual(stats["bytes_read"], 4)
+            self.assertEqual(stats["bytes_written"], 4)
+        finally:
+            os.close(r)
+            os.close(w)
+
+
+class TestCursorAllocate(unittest.TestCase):
+
+    @staticmethod
+    def address(cursor):
+        view = cursor.getbuffer()
+        try:
+            return ctypes.addressof(ctypes.c_char.from_buffer(view))
+        finally:
+            view.release()
+
+    def test_allocate(self):
+        cursor = Cursor.allocate(100)
+        self.assertTrue(cursor.writable())
+        self.assertEqual(cursor.getvalue(), bytes(100))
+        self.assertEqual(cursor.write(b"abc"), 3)
+        cursor.seek(0)
+        self.assertEqual(cursor.read(4), b"abc\0")
+        self.assertEqual(repr(cursor), "Cursor.allocate(100)")
+        self.assertEqual(self.address(cursor) % 4096, 0)
+
+    def test_alignment(self):
+        for alignment in (1, 8, 512, 1 << 16):
+            cursor = Cursor.allocate(10, alignment=alignment)
+            self.assertEqual(self.address(cursor) % alignment, 0)
+        self.assertRaises(ValueError, Cursor.allocate, 10, alignment=3)
+        self.assertRaises(ValueError, Cursor.allocate, 10, alignment=0)
+        self.assertRaises(ValueError, Cursor.allocate, -1)
+
+    def test_empty(self):
+        cursor = Cursor.allocate(0)
+        self.assertEqual(cursor.read(), b"")
+        self.assertRaises(BufferError, cursor.write, b"a")
+
+    def test_hugepages(self):
+        cursor = Cursor.allocate(3 << 20, hugepages=True)
+        self.assertEqual(self.address(cursor) % (2 << 20), 0)
+        cursor.seek(-3, os.SEEK_END)
+        cursor.write(b"abc")
+        self.assertEqual(cursor.getvalue()[-3:], b"abc")
+
+    def test_close(self):
+        cursor = Cursor.allocate(10)
+        view = cursor.getvalue()
+        self.assertRaises(BufferError, cursor.close)
+        view.release()
+        cursor.close()
+        self.assertTrue(cursor.closed)
+        self.assertRaises(ValueError, cursor.read)
+
+    def test_rebind(self):
+        cursor = Cursor.allocate(10)
+        cursor.rebind(b"abc")
+        self.assertEqual(cursor.getvalue(), b"abc")
+        self.assertEqual(repr(cursor), "Cursor(b'abc')")
+
+    @unittest.skipUnless(hasattr(os, "O_DIRECT") and hasattr(os, "preadv"), "requires O_DIRECT")
+    def test_direct_io(self):
+        data = os.urandom(8192)
+        with tempfile.NamedTemporaryFile(dir=os.getcwd()) as f:
+            f.write(data)
+            f.flush()
+            try:
+                fd = os.open(f.name, os.O_RDONLY | os.O_DIRECT)
+            except OSError:
+                self.skipTest("O_DIRECT not supported by the filesystem")
+            try:
+                cursor = Cursor.allocate(len(data))
+                view = cursor.getbuffer()
+                self.assertEqual(os.preadv(fd, [view], 0), len(data))
+                view.release()
+            finally:
+                os.close(fd)
+        self.assertEqual(cursor.read(), data)
+
+
+class TestCursorParsing(unittest.TestCase):
+
+    def test_read_many(self):
+        cursor = Cursor(b"GIF89a\x01\x00\x02\x00rest")
+        self.assertEqual(cursor.read_many([6, 2, 2]), [b"GIF89a", b"\x01\x00", b"\x02\x00"])
+        self.assertEqual(cursor.tell(), 10)
+        self.assertEqual(cursor.read_many([]), [])
+        self.assertEqual(cursor.read_many((0, 4)), [b"", b"rest"])
+
+    def test_read_many_views(self):
+        cursor = Cursor(b"abcdef")
+        chunks = cursor.read_many([1, 2], copy=False)
+        self.assertTrue(all(isinstance(chunk, memoryview) for chunk in chunks))
+        self.assertEqual(chunks, [b"a", b"bc"])
+        self.assertRaises(BufferError, cursor.close)
+        for chunk in chunks:
+            chunk.release()
+        cursor.close()
+
+    def test_read_many_errors(self):
+        cursor = Cursor(b"abcdef")
+        self.assertRaises(EOFError, cursor.read_many, [4, 3])
+        self.assertRaises(ValueError, cursor.read_many, [1, -1])
+        self.assertRaises(TypeError, cursor.read_many, [1, "a"])
+        self.assertRaises(TypeError, cursor.read_many, 1)
+        self.assertEqual(cursor.tell(), 0)
+
+    def test_skip(self):
+        cursor = Cursor(b"abcdef")
+        self.assertIs(cursor.skip(2), None)
+        self.assertEqual(cursor.read(1), b"c")
+        cursor.skip(3)
+        self.assertEqual(cursor.tell(), 6)
+        cursor.skip(0)
+        self.assertRaises(EOFError, cursor.skip, 1)
+        self.assertRaises(ValueError, cursor.skip, -1)
+        self.assertRaises(TypeError, cursor.skip, "1")
+        self.assertRaises(TypeError, cursor.skip)
+        self.assertEqual(cursor.tell(), 6)
+
+    def test_expect(self):
+        cursor = Cursor(b"\x89PNG\r\n\x1a\ndata")
+        self.assertIs(cursor.expect(b"\x89PNG\r\n\x1a\n"), None)
+        self.assertEqual(cursor.tell(), 8)
+        self.assertRaises(ValueError, cursor.expect, b"date")
+        self.assertRaises(EOFError, cursor.expect, b"data!")
+        self.assertEqual(cursor.tell(), 8)
+        cursor.expect(bytearray(b"da"))
+        cursor.expect(prefix=memoryview(b"ta"))
+        self.assertEqual(cursor.tell(), 12)
+
+    def test_closed(self):
+        cursor = Cursor(b"abc")
+        cursor.close()
+        self.assertRaises(ValueError, cursor.read_many, [1])
+        self.assertRaises(ValueError, cursor.skip, 1)
+        self.assertRaises(ValueError, cursor.expect, b"a")
+
+
+class TestCursorReserve(unittest.TestCase):
+
+    def test_reserve(self):
+        cursor = Cursor(bytearray(8))
+        cursor.seek(2)
+        with cursor.reserve(4) as view:
+            self.assertEqual(len(view), 4)
+            self.assertFalse(view.readonly)
+            view[:3] = b"abc"
+        self.assertEqual(cursor.tell(), 2)
+        cursor.commit_reserved(3)
+        self.assertEqual(cursor.tell(), 5)
+        self.assertEqual(cursor.getvalue(), bytearray(b"\x00\x00abc\x00\x00\x00"))
+
+    def test_recv_into(self):
+        cursor = Cursor(bytearray(8))
+        left, right = socket.socketpair()
+        with left, right:
+            left.sendall(b"hello")
+            with cursor.reserve(8) as view:
+                n = right.recv_into(view)
+            cursor.commit_reserved(n)
+        self.assertEqual(cursor.tell(), 5)
+        self.assertEqual(cursor.getvalue()[:5], b"hello")
+
+    def test_zero(self):
+        cursor = Cursor(bytearray(4))
+        cursor.seek(4)
+        with cursor.reserve(0) as view:
+            self.assertEqual(len(view), 0)
+        cursor.commit_reserved(0)
+        self.assertEqual(cursor.tell(), 4)
+
+    def test_commit_errors(self):
+        cursor = Cursor(bytearray(8))
+        self.assertRaises(ValueError, cursor.commit_reserved, 0)
+        cursor.reserve(4).release()
+        self.assertRaises(ValueError, cursor.commit_reserved, 5)
+        self.assertRaises(ValueError, cursor.commit_reserved, -1)
+        cursor.commit_reserved(4)
+        self.assertRaises(ValueError, cursor.commit_reserved, 0)
+
+    def test_reserve_errors(self):
+        cursor = Cursor(bytearray(8))
+        self.assertRaises(ValueError, cursor.reserve, -1)
+        self.assertRaises(BufferError, cursor.reserve, 9)
+        cursor.reserve(4).release()
+        self.assertRaises(BufferError, cursor.reserve, 2)
+        self.assertRaises(OSError, Cursor(b"abcd").reserve, 2)
+        cursor = Cursor(bytearray(4))
+        cursor.close()
+        self.assertRaises(ValueError, cursor.reserve, 2)
+
+    def test_close(self):
+        cursor = Cursor(bytearray(8))
+        view = cursor.reserve(4)
+        self.assertRaises(BufferError, cursor.close)
+        view.release()
+        self.assertRaises(BufferError, cursor.close)
+        self.assertRaises(BufferError, cursor.rebind, bytearray(8))
+        cursor.commit_reserved(0)
+        cursor.close()
+        self.assertTrue(cursor.closed)
+
+    def test_copy_on_write(self):
+        data = b"abcd"
+        cursor = Cursor(data, copy_on_write=True)
+        with cursor.reserve(2) as view:
+            view[:] = b"xy"
+        cursor.commit_reserved(2)
+        self.assertEqual(cursor.getvalue(), bytearray(b"xycd"))
+        self.assertEqual(data, b"abcd")
+
+    def test_rollback(self):
+        cursor = Cursor(bytearray(b"abcd"))
+        with cursor.checkpoint() as checkpoint:
+            with cursor.reserve(4) as view:
+                view[:] = b"wxyz"
+            cursor.commit_reserved(4)
+            checkpoint.rollback()
+        self.assertEqual(cursor.getvalue(), bytearray(b"abcd"))
+        self.assertEqual(cursor.tell(), 0)
+
+
+class TestCursorSplitAligned(unittest.TestCase):
+
+    def test_ranges(self):
+        cursor = Cursor(b"a\nbb\nccc\ndddd\n")
+        self.assertEqual(cursor.split_aligned(1, ranges=True), [(0, 14)])
+        self.assertEqual(cursor.split_aligned(2, ranges=True), [(0, 9), (9, 14)])
+        self.assertEqual(cursor.split_aligned(3, ranges=True), [(0, 5), (5, 9), (9, 14)])
+        self.assertEqual(cursor.tell(), 0)
+
+    def test_parts_end_on_separator(self):
+        data = b"".join(b"x" * (i % 7) + b"\n" for i in range(1000)) + b"tail"
+        cursor = Cursor(data)
+        for n in (1, 2, 3, 8, 64):
+            parts = cursor.split_aligned(n)
+            self.assertEqual(len(parts), n)
+            contents = [part.read() for part in parts]
+            self.assertEqual(b"".join(contents), data)
+            for content in contents[:-1]:
+                self.assertTrue(not content or content.endswith(b"\n"))
+            for part in parts:
+                part.close()
+
+    def test_position(self):
+        cursor = Cursor(b"skip\na\nb\n")
+        cursor.seek(5)
+        self.assertEqual(cursor.split_aligned(2, ranges=True), [(5, 7), (7, 9)])
+        cursor.seek(20)
+        self.assertEqual(cursor.split_aligned(2, ranges=True), [(9, 9), (9, 9)])
+
+    def test_sep(self):
+        cursor = Cursor(b"a;b;c;d")
+        self.assertEqual(cursor.split_aligned(2, sep=b";", ranges=True), [(0, 4), (4, 7)])
+        self.assertRaises(TypeError, cursor.split_aligned, 2, sep=b";;")
+
+    def test_long_records(self):
+        cursor = Cursor(b"x" * 100 + b"\n")
+        self.assertEqual(cursor.split_aligned(3, ranges=True), [(0, 101), (101, 101), (101, 101)])
+
+    def test_cursors(self):
+        buffer = bytearray(b"ab\ncd\n")
+        cursor = Cursor(buffer)
+        first, second = cursor.split_aligned(2)
+        self.assertIsInstance(first, Cursor)
+        self.assertEqual(second.read(), b"cd\n")
+        first.write(b"AB")
+        self.assertEqual(buffer, b"AB\ncd\n")
+        self.assertRaises(BufferError, cursor.close)
+        self.assertFalse(Cursor(buffer, readonly=True).split_aligned(1)[0].writable())
+
+    def test_errors(self):
+        cursor = Cursor(b"abc")
+        self.assertRaises(ValueError, cursor.split_aligned, 0)
+        cursor.close()
+        self.assertRaises(ValueError, cursor.split_aligned, 1)
+
+
+class TestTextCursor(unittest.TestCase):
+
+    text = "héllo\nwörld\n€\U0001F600 end"
+
+    def test_read(self):
+        reader = TextCursor(self.text.encode())
+        self.assertEqual(reader.read(0), "")
+        self.assertEqual(reader.read(3), "hél")
+        self.assertEqual(reader.tell(), 4)
+        self.assertEqual(reader.read(), self.text[3:])
+        self.assertEqual(reader.read(), "")
+        self.assertEqual(reader.read(5), "")
+
+    def test_readline(self):
+        reader = TextCursor(self.text.encode())
+        self.assertEqual(reader.readline(), "héllo\n")
+        self.assertEqual(reader.readline(2), "wö")
+        self.assertEqual(reader.readline(), "rld\n")
+        self.assertEqual(reader.readline(), "€\U0001F600 end")
+        self.assertEqual(reader.readline(), "")
+
+    def test_readlines(self):
+        reader = TextCursor(self.text.encode())
+        self.assertEqual(reader.readlines(), self.text.splitlines(True))
+        reader.seek(0)
+        self.assertEqual(reader.readlines(3), ["héllo\n"])
+
+    def test_iter(self):
+        reader = TextCursor(self.text.encode())
+        self.assertEqual(list(reader), self.text.splitlines(True))
+        self.assertEqual(list(TextCursor(b"")), [])
+
+    def test_ascii(self):
+        data = "".join("line {}\n".format(i) for i in range(100))
+        reader = TextCursor(data.encode("ascii"))
+        self.assertEqual(list(reader), data.splitlines(True))
+        reader.seek(0)
+        self.assertEqual(reader.read(50), data[:50])
+
+    def test_seek_tell(self):
+        reader = TextCursor(self.text.encode())
+        reader.readline()
+        position = reader.tell()
+        self.assertEqual(position, 7)
+        reader.read()
+        self.assertEqual(reader.seek(position), position)
+        self.assertEqual(reader.readline(), "wörld\n")
+        reader.seek(-4, os.SEEK_END)
+        self.assertEqual(reader.read(), " end")
+        reader.seek(2)
+        self.assertRaises(UnicodeDecodeError, reader.read)
+
+    def test_shared_cursor(self):
+        cursor = Cursor(self.text.encode())
+        reader = cursor.text()
+        self.assertIsInstance(reader, TextCursor)
+        self.assertIs(reader.buffer, cursor)
+        self.assertEqual(reader.readline(), "héllo\n")
+        self.assertEqual(cursor.tell(), 7)
+        self.assertEqual(cursor.read(1), b"w")
+        self.assertEqual(reader.read(1), "ö")
+
+    def test_invalid(self):
+        for data in (b"\xff", b"\xc0\x80", b"\xed\xa0\x80", b"ab\xe2\x82", b"\xf4\x90\x80\x80"):
+            self.assertRaises(UnicodeDecodeError, TextCursor, data)
+        with self.assertRaises(UnicodeDecodeError) as ctx:
+            TextCursor(b"x" * 40 + b"\x80")
+        self.assertEqual(ctx.exception.start, 40)
+
+    def test_modified_buffer(self):
+        buffer = bytearray(b"abc\n")
+        reader = TextCursor(Cursor(buffer))
+        buffer[1] = 0xFF
+        self.assertRaises(UnicodeDecodeError, reader.readline)
+
+    def test_close(self):
+        cursor = Cursor(b"abc")
+        reader = cursor.text()
+        self.assertFalse(reader.closed)
+        reader.close()
+        self.assertTrue(reader.closed)
+        self.assertTrue(cursor.closed)
+        self.assertRaises(ValueError, reader.read)
+        self.assertRaises(ValueError, cursor.text)
+
+
+class TestBitCursor(unittest.TestCase):
+
+    @staticmethod
+    def to_bits(data, order):
+        bits = []
+        for byte in data:
+            byte_bits = [(byte >> i) & 1 for i in range(8)]
+            bits.extend(byte_bits if order == "lsb" else reversed(byte_bits))
+        return bits
+
+    @staticmethod
+    def to_int(bits, order):
+        if order == "msb":
+            bits = reversed(bits)
+        return sum(bit << i for i, bit in enumerate(bits))
+
+    def test_read_msb(self):
+        bits = BitCursor(b"\xa5\xf0")
+        self.assertEqual(bits.order, "msb")
+        self.assertEqual(bits.read_bits(3), 0b101)
+        self.assertEqual(bits.read_bits(5), 0b00101)
+        self.assertEqual(bits.read_bits(4), 0b1111)
+        self.assertEqual(bits.tell(), 12)
+        self.assertEqual(bits.read_bits(0), 0)
+
+    def test_read_lsb(self):
+        bits = BitCursor(b"\xa5\xf0", order="lsb")
+        self.assertEqual(bits.order, "lsb")
+        self.assertEqual(bits.read_bits(3), 0b101)
+        self.assertEqual(bits.read_bits(5), 0b10100)
+        self.assertEqual(bits.read_bits(4), 0b0000)
+        self.assertEqual(bits.read_bits(4), 0b1111)
+
+    def test_read_random(self):
+        rng = random.Random(42)
+        data = bytes(rng.randrange(256) for _ in range(200))
+        for order in ("msb", "lsb"):
+            expected = self.to_bits(data, order)
+            bits = BitCursor(data, order=order)
+            position = 0
+            while position < len(expected):
+                n = min(rng.randint(0, 64), len(expected) - position)
+                value = self.to_int(expected[position:position + n], order)
+                self.assertEqual(bits.peek_bits(n), value)
+                self.assertEqual(bits.read_bits(n), value)
+                position += n
+                self.assertEqual(bits.tell(), position)
+            self.assertRaises(EOFError, bits.read_bits, 1)
+
+    def test_read_64(self):
+        data = bytes(range(1, 18))
+        for order in ("msb", "lsb"):
+            expected = self.to_bits(data, order)
+            bits = BitCursor(data, order=order)
+            bits.skip_bits(7)
+            self.assertEqual(bits.peek_bits(64), self.to_int(expected[7:71], order))
+            self.assertEqual(bits.read_bits(64), self.to_int(expected[7:71], order))
+            self.assertEqual(bits.read_bits(64), self.to_int(expected[71:135], order))
+
+    def test_read_eof(self):
+        bits = BitCursor(b"\xff\xff")
+        bits.read_bits(10)
+        self.assertRaises(EOFError, bits.read_bits, 7)
+        self.assertRaises(EOFError, bits.peek_bits, 7)
+        self.assertRaises(EOFError, bits.skip_bits, 7)
+        self.assertEqual(bits.tell(), 10)
+        self.assertEqual(bits.read_bits(6), 0b111111)
+
+    def test_invalid_count(self):
+        bits = BitCursor(bytes(16))
+        self.assertRaises(ValueError, bits.read_bits, 65)
+        self.assertRaises(ValueError, bits.read_bits, -1)
+        self.assertRaises(ValueError, bits.peek_bits, 65)
+        self.assertRaises(ValueError, bits.skip_bits, -1)
+        self.assertRaises(ValueError, bits.write_bits, 0, 65)
+        self.assertRaises(ValueError, BitCursor, b"", order="big")
+
+    def test_skip_align(self):
+        cursor = Cursor(bytes(range(16)))
+        bits = cursor.bits()
+        bits.skip_bits(3)
+        bits.align()
+        self.assertEqual(bits.tell(), 8)
+        self.assertEqual(cursor.tell(), 1)
+        bits.align()
+        self.assertEqual(bits.tell(), 8)
+        bits.skip_bits(100)
+        self.assertEqual(bits.tell(), 108)
+        self.assertEqual(bits.read_bits(4), 13)
+        bits.align()
+        self.assertEqual(cursor.tell(), 14)
+        self.assertEqual(cursor.read(1), b"\x0e")
+
+    def test_cursor_position(self):
+        cursor = Cursor(b"\x01\x02\x03\x04")
+        cursor.seek(1)
+        with cursor.bits() as bits:
+            self.assertEqual(bits.tell(), 8)
+            self.assertEqual(bits.read_bits(12), 0x020)
+        self.assertEqual(cursor.tell(), 3)
+        bits = cursor.bits()
+        bits.read_bits(4)
+        bits.flush()
+        self.assertEqual(cursor.tell(), 3)
+        self.assertEqual(bits.read_bits(4), 0x4)
+
+    def test_write_msb(self):
+        cursor = Cursor(bytearray(2))
+        with cursor.bits() as bits:
+            bits.write_bits(0b101, 3)
+            bits.write_bits(0b00101, 5)
+            bits.write_bits(0b1111, 4)
+            self.assertEqual(bits.tell(), 12)
+        self.assertEqual(cursor.getvalue(), bytearray(b"\xa5\xf0"))
+        self.assertEqual(cursor.tell(), 2)
+
+    def test_write_lsb(self):
+        cursor = Cursor(bytearray(2))
+        with cursor.bits(order="lsb") as bits:
+            bits.write_bits(0b101, 3)
+            bits.write_bits(0b10100, 5)
+            bits.write_bits(0b1111, 4)
+        self.assertEqual(cursor.getvalue(), bytearray(b"\xa5\x0f"))
+
+    def test_write_random(self):
+        rng = random.Random(42)
+        for order in ("msb", "lsb"):
+            expected = []
+            buffer = bytearray(200)
+            bits = BitCursor(buffer, order=order)
+            while len(expected) < 1500:
+                n = rng.randint(0, 64)
+                value = rng.getrandbits(n) if n else 0
+                bits.write_bits(value, n)
+                chunk = [(value >> i) & 1 for i in range(n)]
+                expected.extend(chunk if order == "lsb" else reversed(chunk))
+                self.assertEqual(bits.tell(), len(expected))
+            bits.flush()
+            self.assertEqual(self.to_bits(buffer, order)[:len(expected)], expected)
+            bits = BitCursor(buffer, order=order)
+            self.assertEqual(bits.read_bits(64), self.to_int(expected[:64], order))
+
+    def test_write_partial(self):
+        for order in ("msb", "lsb"):
+            buffer = bytearray(b"\xff\xff")
+            bits = BitCursor(buffer, order=order)
+            bits.skip_bits(3)
+            bits.write_bits(0, 6)
+            bits.flush()
+            self.assertEqual(bits.tell(), 9)
+            expected = [1] * 3 + [0] * 6 + [1] * 7
+            self.assertEqual(self.to_bits(buffer, order), expected)
+            self.assertEqual(bits.read_bits(7), 0b1111111)
+
+    def test_write_align(self):
+        buffer = bytearray(b"\xff\xff")
+        cursor = Cursor(buffer)
+        with cursor.bits() as bits:
+            bits.write_bits(0b1, 1)
+        self.assertEqual(buffer, bytearray(b"\x80\xff"))
+        self.assertEqual(cursor.tell(), 1)
+
+    def test_read_dealloc(self):
+        cursor = Cursor(b"abcdefghijkl")
+        bits = cursor.bits()
+        self.assertEqual(bits.read_bits(3), 0b011)
+        del bits
+        self.assertEqual(cursor.tell(), 0)
+
+    def test_write_dealloc(self):
+        buffer = bytearray(1)
+        bits = BitCursor(buffer)
+        bits.write_bits(0b11, 2)
+        del bits
+        self.assertEqual(buffer, bytearray(b"\xc0"))
+
+    def test_write_errors(self):
+        bits = BitCursor(bytearray(1))
+        self.assertRaises(ValueError, bits.write_bits, 4, 2)
+        self.assertRaises(OverflowError, bits.write_bits, -1, 2)
+        bits.write_bits(0, 5)
+        self.assertRaises(BufferError, bits.write_bits, 0, 4)
+        bits.write_bits(0b111, 3)
+        bits.flush()
+        self.assertEqual(bits.buffer.getvalue(), bytearray(b"\x07"))
+        with self.assertRaises(io.UnsupportedOperation):
+            BitCursor(b"\x00").write_bits(1, 1)
+
+    def test_closed(self):
+        cursor = Cursor(bytes(4))
+        bits = cursor.bits()
+        cursor.close()
+        self.assertRaises(ValueError, bits.read_bits, 1)
+        self.assertRaises(ValueError, bits.tell)
+        self.assertRaises(ValueError, cursor.bits)
+
+
+class TestCursorBisect(unittest.TestCase):
+
+    FORMATS = {
+        "u8": "<B", "i8": "<b",
+        "u16le": "<H", "u16be": ">H", "i16le": "<h", "i16be": ">h",
+        "u32le": "<I", "u32be": ">I", "i32le": "<i", "i32be": ">i",
+        "u64le": "<Q", "u64be": ">Q", "i64le": "<q", "i64be": ">q",
+    }
+
+    def _records(self, key_type, count, rng):
+        fmt = self.FORMATS[key_type]
+        bits = struct.calcsize(fmt) * 8
+        if fmt[-1].islower():
+            low, high = -(1 << (bits - 1)), (1 << (bits - 1)) - 1
+        else:
+            low, high = 0, (1 << bits) - 1
+        keys = sorted(rng.randint(low, high) for _ in range(count))
+        data = b"".join(b"#" + struct.pack(fmt, key) + b"@@" for key in keys)
+        return keys, data, (low, high)
+
+    def test_integer_keys(self):
+        rng = random.Random(0)
+        for key_type, fmt in self.FORMATS.items():
+            keys, data, (low, high) = self._records(key_type, 50, rng)
+            cursor = Cursor(data)
+            size = struct.calcsize(fmt) + 3
+            queries = keys[::3] + [low, high] + [rng.randint(low, high) for _ in range(20)]
+            for query in queries:
+                self.assertEqual(
+                    cursor.bisect(query, size, key_offset=1, key_type=key_type),
+                    bisect.bisect_left(keys, query),
+                    (key_type, query),
+                )
+            self.assertEqual(
+                cursor.bisect_many(queries, size, key_offset=1, key_type=key_type),
+                [bisect.bisect_left(keys, query) for query in queries],
+            )
+
+    def test_bytes_keys(self):
+        rng = random.Random(1)
+        keys = sorted(bytes(rng.getrandbits(8) for _ in range(4)) for _ in range(100))
+        cursor = Cursor(b"".join(key + b"value" for key in keys))
+        queries = keys[::7] + [b"", b"\x00" * 4, b"\xff" * 4, keys[10][:2], keys[20] + b"\x00"]
+        queries += [bytes(rng.getrandbits(8) for _ in range(4)) for _ in range(50)]
+        for query in queries:
+            self.assertEqual(cursor.bisect(query, 9, key_size=4), bisect.bisect_left(keys, query))
+        self.assertEqual(
+            cursor.bisect_many(queries, 9, key_size=4),
+            [bisect.bisect_left(keys, query) for query in queries],
+        )
+
+    def test_default_key_size(self):
+        cursor = Cursor(b"aa" b"ab" b"ba" b"bb")
+        self.assertEqual(cursor.bisect(b"b", 2), 2)
+        self.assertEqual(cursor.bisect(b"ab", 2), 1)
+        self.assertEqual(cursor.bisect(b"a", 2, key_size=1), 0)
+
+    def test_seek(self):
+        cursor = Cursor(bytes(range(0, 20, 2)))
+        self.assertEqual(cursor.bisect(7, 1, key_type="u8"), 4)
+        self.assertEqual(cursor.tell(), 0)
+        self.assertEqual(cursor.bisect(7, 1, key_type="u8", seek=True), 4)
+        self.assertEqual(cursor.tell(), 4)
+        self.assertEqual(cursor.read(1), b"\x08")
+
+    def test_trailing(self):
+        cursor = Cursor(b"\x01\x00\x02\x00\x03")
+        self.assertEqual(cursor.bisect(3, 2, key_type="u16le"), 2)
+        self.assertEqual(Cursor(b"").bisect(1, 4, key_type="u32le"), 0)
+
+    def test_many_empty(self):
+        cursor = Cursor(b"\x01\x02")
+        self.assertEqual(cursor.bisect_many([], 1, key_type="u8"), [])
+        self.assertEqual(cursor.bisect_many(iter([2, 2, 0]), 1, key_type="u8"), [1, 1, 0])
+
+    def test_errors(self):
+        cursor = Cursor(bytes(16))
+        self.assertRaises(ValueError, cursor.bisect, 1, 0, key_type="u8")
+        self.assertRaises(ValueError, cursor.bisect, 1, 4, key_offset=-1, key_type="u8")
+        self.assertRaises(ValueError, cursor.bisect, 1, 4, key_offset=2, key_type="u32le")
+        self.assertRaises(ValueError, cursor.bisect, 1, 4, key_size=2, key_type="u32le")
+        self.assertRaises(ValueError, cursor.bisect, b"a", 4, key_size=5)
+        self.assertRaises(ValueError, cursor.bisect, 1, 4, key_type="u24le")
+        self.assertRaises(ValueError, cursor.bisect, 1, 4, key_type="u32")
+        self.assertRaises(ValueError, cursor.bisect, 1, 4, key_type="f32le")
+        self.assertRaises(OverflowError, cursor.bisect, 256, 4, key_type="u8")
+        self.assertRaises(OverflowError, cursor.bisect, -1, 4, key_type="u32le")
+        self.assertRaises(OverflowError, cursor.bisect, 128, 4, key_type="i8")
+        self.assertRaises(TypeError, cursor.bisect, b"a", 4, key_type="u8")
+        self.assertRaises(TypeError, cursor.bisect, 1, 4)
+        self.assertRaises(TypeError, cursor.bisect_many, 1, 4, key_type="u8")
+        self.assertRaises(OverflowError, cursor.bisect_many, [1, 256], 4, key_type="u8")
+        self.assertRaises(TypeError, cursor.bisect_many, [b"a", 1], 4)
+        cursor.close()
+        self.assertRaises(ValueError, cursor.bisect, 1, 4, key_type="u8")
+
+
+class TestCursorCheckpoint(unittest.TestCase):
+
+    def test_commit(self):
+        cursor = Cursor(bytearray(b"abcdef"))
+        with cursor.checkpoint() as checkpoint:
+            self.assertTrue(checkpoint.active)
+            cursor.write(b"xy")
+        self.assertFalse(checkpoint.active)
+        self.assertEqual(cursor.getvalue(), bytearray(b"xycdef"))
+        self.assertEqual(cursor.tell(), 2)
+
+    def test_rollback_exception(self):
+        cursor = Cursor(bytearray(b"abcdef"))
+        with self.assertRaises(KeyError):
+            with cursor.checkpoint():
+                cursor.seek(2)
+                cursor.write(b"xyz")
+                raise KeyError("alternative failed")
+        self.assertEqual(cursor.getvalue(), bytearray(b"abcdef"))
+        self.assertEqual(cursor.tell(), 0)
+
+    def test_rollback_explicit(self):
+        cursor = Cursor(bytearray(b"abcdef"))
+        cursor.seek(1)
+        with cursor.checkpoint() as checkpoint:
+            cursor.write(b"x")
+            checkpoint.rollback()
+            self.assertRaises(ValueError, checkpoint.commit)
+            cursor.write(b"y")
+        self.assertEqual(cursor.getvalue(), bytearray(b"aycdef"))
+
+    def test_rollback_read(self):
+        cursor = Cursor(b"abcdef")
+        cursor.mark()
+        self.assertEqual(cursor.read(4), b"abcd")
+        cursor.rollback()
+        self.assertEqual(cursor.tell(), 0)
+
+    def test_nested(self):
+        cursor = Cursor(bytearray(b"abcdef"))
+        cursor.mark()
+        cursor.write(b"12")
+        cursor.mark()
+        cursor.write(b"34")
+        cursor.rollback()
+        self.assertEqual(cursor.getvalue(), bytearray(b"12cdef"))
+        self.assertEqual(cursor.tell(), 2)
+        cursor.mark()
+        cursor.write(b"5")
+        cursor.commit()
+        cursor.rollback()
+        self.assertEqual(cursor.getvalue(), bytearray(b"abcdef"))
+        self.assertEqual(cursor.tell(), 0)
+        self.assertRaises(ValueError, cursor.rollback)
+        self.assertRaises(ValueError, cursor.commit)
+
+    def test_nested_order(self):
+        cursor = Cursor(bytearray(4))
+        outer = cursor.checkpoint()
+        inner = cursor.checkpoint()
+        self.assertFalse(outer.active)
+        self.assertRaises(ValueError, outer.rollback)
+        inner.commit()
+        outer.rollback()
+
+    def test_overlapping_writes(self):
+        cursor = Cursor(bytearray(b"abcdefgh"))
+        cursor.mark()
+        cursor.write(b"1234")
+        cursor.seek(2)
+        cursor.write(b"56")
+        cursor.write_at(6, b"7")
+        cursor.copy_within(0, 4, 2)
+        cursor.seek(1)
+        cursor.writelines([b"8", b"9"])
+        cursor.zero(1)
+        cursor.write_hexdecode("ff")
+        cursor.write_b64decode("AA==")
+        self.assertEqual(cursor.getvalue(), bytearray(b"189\x00\xff\x007h"))
+        cursor.rollback()
+        self.assertEqual(cursor.getvalue(), bytearray(b"abcdefgh"))
+
+    def test_recv_from(self):
+        cursor = Cursor(bytearray(b"abcdef"))
+        left, right = socket.socketpair()
+        with left, right:
+            left.sendall(b"xyz")
+            with cursor.checkpoint() as checkpoint:
+                cursor.recv_from(right, 3)
+                checkpoint.rollback()
+        self.assertEqual(cursor.getvalue(), bytearray(b"abcdef"))
+
+    def test_bits(self):
+        cursor = Cursor(bytearray(b"\xff\xff"))
+        with cursor.checkpoint() as checkpoint:
+            with cursor.bits() as bits:
+                bits.write_bits(0, 12)
+            checkpoint.rollback()
+        self.assertEqual(cursor.getvalue(), bytearray(b"\xff\xff"))
+
+    def test_rebind(self):
+        cursor = Cursor(bytearray(4))
+        checkpoint = cursor.checkpoint()
+        cursor.rebind(bytearray(4))
+        self.assertFalse(checkpoint.active)
+        self.assertRaises(ValueError, cursor.rollback)
+
+    def test_closed(self):
+        cursor = Cursor(bytearray(4))
+        checkpoint = cursor.checkpoint()
+        cursor.close()
+        self.assertRaises(ValueError, checkpoint.rollback)
+        self.assertRaises(ValueError, cursor.checkpoint)
+
+
+class TestExportRegistry(unittest.TestCase):
+
+    def setUp(self):
+        track_exports()
+
+    def tearDown(self):
+        track_exports(False)
+
+    def _tracked(self):
+        return [info["cursor"] for info in live_cursors()]
+
+    def test_disabled(self):
+        track_exports(False)
+        cursor = Cursor(bytearray(4))
+        self.assertEqual(live_cursors(), [])
+        track_exports()
+        self.assertEqual(live_cursors(), [])
+        cursor.rebind(bytearray(8))
+        self.assertEqual(self._tracked(), [cursor])
+
+    def test_info(self):
+        def create():
+            return Cursor(b"abcdef")
+        cursor = create()
+        cursor.seek(2)
+        info, = live_cursors()
+        self.assertIs(info["cursor"], cursor)
+        self.assertEqual(info["source_type"], "bytes")
+        self.assertEqual(info["size"], 6)
+        self.assertEqual(info["offset"], 2)
+        self.assertEqual(info["traceback"][-1].name, "create")
+
+    def test_order(self):
+        c1 = Cursor(bytearray(1))
+        c2 = Cursor(bytearray(2))
+        c3 = Cursor(bytearray(3))
+        self.assertEqual(self._tracked(), [c1, c2, c3])
+        c2.close()
+        self.assertEqual(self._tracked(), [c1, c3])
+
+    def test_frames(self):
+        track_exports(frames=0)
+        cursor = Cursor(bytearray(4))
+        info, = live_cursors()
+        self.assertIsNone(info["traceback"])
+        self.assertRaises(ValueError, track_exports, frames=-1)
+
+    def test_close(self):
+        cursor = Cursor(bytearray(4))
+        cursor.close()
+        self.assertEqual(live_cursors(), [])
+
+    def test_dealloc(self):
+        cursor = Cursor(bytearray(4))
+        del cursor
+        self.assertEqual(live_cursors(), [])
+
+    def test_rebind(self):
+        cursor = Cursor(bytearray(4))
+        cursor.rebind(b"abcdefgh")
+        info, = live_cursors()
+        self.assertEqual(info["source_type"], "bytes")
+        self.assertEqual(info["size"], 8)
+
+    def test_copy_on_write(self):
+        cursor = Cursor(b"abcd", copy_on_write=True)
+        cursor.write(b"x")
+        info, = live_cursors()
+        self.assertEqual(info["source_type"], "bytearray")
+
+    def test_disable_clears(self):
+        cursor = Cursor(bytearray(4))
+        track_exports(False)
+        self.assertEqual(live_cursors(), [])
+        cursor.close()
+
+    @unittest.skipUnless(sys.implementation.name == "cpython", "requires CPython")
+    @unittest.skipIf(sys.version_info < (3, 7), "requires Python 3.7")
+    def test_tracemalloc(self):
+        tracemalloc.start()
+        try:
+            cursor = Cursor(bytes(4096))
+            snapshot = tracemalloc.take_snapshot().filter_traces(
+                [tracemalloc.DomainFilter(True, TRACEMALLOC_DOMAIN)]
+            )
+            self.assertEqual(sum(t.size for t in snapshot.traces), 4096)
+            cursor.close()
+            snapshot = tracemalloc.take_snapshot().filter_traces(
+                [tracemalloc.DomainFilter(True, TRACEMALLOC_DOMAIN)]
+            )
+            self.assertEqual(len(snapshot.traces), 0)
+        finally:
+            tracemalloc.stop()
+
+
+class TestCopyEngine(unittest.TestCase):
+
+    def setUp(self):
+        self.defaults = copy_engine()
+
+    def tearDown(self):
+        copy_engine(
+            stream_size=self.defaults["stream_size"],
+            parallel_size=self.defaults["parallel_size"],
+            threads=self.defaults["threads"],
+        )
+
+    def _check_copies(self):
+        rng = random.Random(42)
+        for size in (0, 1, 15, 16, 63, 64, 65, 1000, 4099):
+            for shift in (0, 1, 7):
+                data = bytes(rng.getrandbits(8) for _ in range(size + shift))
+                cursor = Cursor(data)
+                cursor.seek(shift)
+                out = bytearray(size + 3)
+                view = memoryview(out)[3:]
+                self.assertEqual(cursor.readinto(view), size)
+                self.assertEqual(out[3:], data[shift:])
+                cursor = Cursor(bytearray(size + shift))
+                cursor.seek(shift)
+                self.assertEqual(cursor.write(memoryview(data)[shift:]), size)
+                self.assertEqual(cursor.getvalue()[shift:], data[shift:])
+                cursor.write_at(0, data[:shift])
+                self.assertEqual(cursor.getvalue(), data)
+
+    def test_defaults(self):
+        self.assertIsInstance(self.defaults["streaming"], bool)
+        self.assertGreater(self.defaults["stream_size"], 0)
+        self.assertGreaterEqual(self.defaults["threads"], 1)
+
+    def test_configure(self):
+        config = copy_engine(stream_size=100)
+        self.assertEqual(config["stream_size"], 100)
+        self.assertEqual(config["parallel_size"], self.defaults["parallel_size"])
+        self.assertEqual(copy_engine()["stream_size"], 100)
+        self.assertRaises(ValueError, copy_engine, stream_size=-1)
+        self.assertRaises(ValueError, copy_engine, threads=0)
+        self.assertRaises(ValueError, copy_engine, threads=1000)
+        self.assertRaises(TypeError, copy_engine, parallel_size="1")
+
+    def test_stream(self):
+        copy_engine(stream_size=0, parallel_size=sys.maxsize)
+        self._check_copies()
+
+    def test_parallel(self):
+        copy_engine(stream_size=0, parallel_size=0, threads=4)
+        self._check_copies()
+
+    def test_concurrent(self):
+        copy_engine(stream_size=1 << 16, parallel_size=sys.maxsize)
+        chunk = 1 << 20
+        cursor = Cursor(bytearray(4 * chunk))
+        threads = [
+            threading.Thread(target=cursor.write, args=(bytes([i + 1]) * chunk,))
+            for i in range(4)
+        ]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(cursor.tell(), 4 * chunk)
+        value = cursor.getvalue()
+        quarters = sorted(value[i*chunk] for i in range(4))
+        self.assertEqual(quarters, [1, 2, 3, 4])
+        for i in range(4):
+            self.assertEqual(value.count(value[i*chunk], i*chunk, (i+1)*chunk), chunk)
+        cursor.seek(0)
+        out = [bytearray(chunk) for _ in range(4)]
+        threads = [threading.Thread(target=cursor.readinto, args=(b,)) for b in out]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(sorted(b[0] for b in out), [1, 2, 3, 4])
+        self.assertEqual(b"".join(sorted(out)), bytes(sorted(value)))
+
+    def test_pinned(self):
+        copy_engine(stream_size=0, parallel_size=0, threads=2)
+        buffer = bytearray(100)
+        cursor = Cursor(buffer)
+        cursor.write(bytes(range(100)))
+        cursor.close()
+        buffer.extend(b"x")
+        self.assertEqual(buffer[:100], bytes(range(100)))
@@ -0,0 +1,180 @@
+# coding: utf-8
+
+import os
+import tempfile
+import threading
+import time
+import unittest
+
+import iocursor.loader
+from iocursor import Cursor, load_many
+from iocursor.cursor import uring_load
+
+
+def uring_available():
+    try:
+        uring_load([(0, Cursor(bytearray()))])
+    except OSError:
+        return False
+    return True
+
+
+class TestLoadMany(unittest.TestCase):
+
+    def setUp(self):
+        self.folder = tempfile.TemporaryDirectory()
+        self.paths = []
+        for i in range(50):
+            path = os.path.join(self.folder.name, "{}.bin".format(i))
+            with open(path, "wb") as f:
+                f.write(bytes([i]) * (i * 10))
+            self.paths.append(path)
+
+    def tearDown(self):
+        self.folder.cleanup()
+
+    def test_paths(self):
+        cursors = [Cursor(bytearray(i * 10)) for i in range(50)]
+        results = load_many(zip(self.paths, cursors), queue_depth=4)
+        self.assertEqual(results, [i * 10 for i in range(50)])
+        for i, cursor in enumerate(cursors):
+            self.assertEqual(cursor.getvalue(), bytes([i]) * (i * 10))
+            self.assertEqual(cursor.tell(), i * 10)
+
+    def test_fd(self):
+        fd = os.open(self.paths[3], os.O_RDONLY)
+        try:
+            cursor = Cursor(bytearray(40))
+            cursor.seek(5)
+            self.assertEqual(load_many([(fd, cursor)]), [30])
+            self.assertEqual(cursor.getvalue(), bytearray(5) + b"\x03" * 30 + bytearray(5))
+        finally:
+            os.close(fd)
+
+    def test_buffer_too_small(self):
+        cursor = Cursor(bytearray(5))
+        self.assertEqual(load_many([(self.paths[2], cursor)]), [5])
+        self.assertEqual(cursor.getvalue(), b"\x02" * 5)
+
+    def test_errors(self):
+        missing = os.path.join(self.folder.name, "missing.bin")
+        cursors = [Cursor(bytearray(20)), Cursor(b"readonly"), Cursor(bytearray(20))]
+        results = load_many([(missing, cursors[0]), (self.paths[1], cursors[1]), (self.paths[2], cursors[2])])
+        self.assertIsInstance(results[0], FileNotFoundError)
+        self.assertIsInstance(results[1], OSError)
+        self.assertEqual(results[2], 20)
+
+    def test_invalid(self):
+        cursor = Cursor(bytearray(10))
+        self.assertRaises(ValueError, load_many, [(self.paths[1], cursor)], queue_depth=0)
+        self.assertRaises(ValueError, load_many, [(self.paths[1], cursor), (self.paths[1], cursor)])
+        self.assertEqual(load_many([]), [])
+
+
+class TestLoadManyThreads(TestLoadMany):
+
+    def setUp(self):
+        super().setUp()
+        self._uring_available = iocursor.loader._uring_available
+        iocursor.loader._uring_available = False
+
+    def tearDown(self):
+        iocursor.loader._uring_available = self._uring_available
+        super().tearDown()
+
+
+@unittest.skipUnless(uring_available(), "requires io_uring")
+class TestUringLoad(unittest.TestCase):
+
+    def test_files(self):
+        with tempfile.TemporaryFile() as f:
+            f.write(b"abcdefgh")
+            f.seek(2)
+            cursors = [Cursor(bytearray(4)), Cursor(bytearray(4))]
+            self.assertEqual(uring_load([(f.fileno(), cursors[0]), (f, cursors[1])]), [4, 2])
+            self.assertEqual(cursors[0].getvalue(), b"cdef")
+            self.assertEqual(cursors[1].getvalue(), b"gh\x00\x00")
+            self.assertEqual(cursors[1].tell(), 2)
+            self.assertEqual(f.tell(), 8)
+
+    def test_short_reads(self):
+        rfd, wfd = os.pipe()
+        def writer():
+            for i in range(16):
+                os.write(wfd, bytes([i]) * 1000)
+            os.close(wfd)
+        thread = threading.Thread(target=writer)
+        thread.start()
+        try:
+            cursor = Cursor(bytearray(20000))
+            self.assertEqual(uring_load([(rfd, cursor)], queue_depth=1), [16000])
+            self.assertEqual(cursor.getvalue()[:16000], b"".join(bytes([i]) * 1000 for i in range(16)))
+        finally:
+            thread.join()
+            os.close(rfd)
+
+    def test_queue_depth(self):
+        with tempfile.TemporaryFile() as f:
+            f.write(bytes(range(100)))
+            cursors = [Cursor(bytearray(10)) for _ in range(10)]
+            f.seek(0)
+            results = uring_load([(f.fileno(), cursor) for cursor in cursors], queue_depth=1)
+            self.assertEqual(results, [10] * 10)
+            self.assertEqual(b"".join(c.getvalue() for c in cursors), bytes(range(100)))
+
+    def test_errors(self):
+        with tempfile.TemporaryFile() as f:
+            f.write(b"abcd")
+            f.seek(0)
+            closed = Cursor(bytearray(4))
+            closed.close()
+            results = uring_load([
+                (-1, Cursor(bytearray(4))),
+                (f.fileno(), Cursor(b"data")),
+                (f.fileno(), closed),
+                (f.fileno(), Cursor(bytearray())),
+                (os.open(os.devnull, os.O_WRONLY), Cursor(bytearray(4))),
+            ])
+            os.close(os.open(os.devnull, os.O_RDONLY))
+            self.assertIsInstance(results[0], ValueError)
+            self.assertIsInstance(results[1], OSError)
+            self.assertIsInstance(results[2], ValueError)
+            self.assertEqual(results[3], 0)
+            self.assertIsInstance(results[4], OSError)
+
+    def test_invalid(self):
+        self.assertEqual(uring_load([]), [])
+        self.assertRaises(TypeError, uring_load, [(0, bytearray(4))])
+        self.assertRaises(TypeError, uring_load, [0])
+        self.assertRaises(TypeError, uring_load, 0)
+        self.assertRaises(ValueError, uring_load, [], queue_depth=0)
+
+    def test_pinned(self):
+        rfd, wfd = os.pipe()
+        cursor = Cursor(bytearray(4))
+        results = []
+        thread = threading.Thread(target=lambda: results.extend(uring_load([(rfd, cursor)])))
+        thread.start()
+        try:
+            # the cursor is advanced after the first byte is read, while
+            # the read of the remaining bytes is still in flight
+            os.write(wfd, b"a")
+            while cursor.tell() == 0:
+                time.sleep(0.001)
+            self.assertRaises(BufferError, cursor.close)
+            os.write(wfd, b"bcd")
+        finally:
+            os.close(wfd)
+            thread.join()
+            os.close(rfd)
+        self.assertEqual(results, [4])
+        self.assertEqual(cursor.getvalue(), b"abcd")
+        cursor.close()
+
+    def test_stats(self):
+        with tempfile.TemporaryFile() as f:
+            f.write(b"abcd")
+            f.seek(0)
+            cursor = Cursor(bytearray(8), stats=True)
+            self.assertEqual(uring_load([(f.fileno(), cursor)]), [4])
+            self.assertEqual(cursor.stats()["bytes_written"], 4)